@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <unistd.h>
+
+namespace graph_db {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+// One row of output: a single benchmark at a given graph size and thread count
+struct BenchmarkResult {
+    std::string name;
+    size_t graph_nodes = 0;
+    size_t graph_edges = 0;
+    size_t threads = 1;
+    size_t operations = 0;
+    double seconds = 0.0;
+    double throughput = 0.0; // operations per second
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+    double rss_mb = 0.0; // resident-set growth while the benchmark ran (ingest benchmarks only)
+    double hit_rate = -1.0; // buffer-pool hit rate of the point lookups (replacer benchmarks only)
+};
+
+// Resident set size of this process from /proc/self/statm; 0 where unavailable
+inline size_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages_total = 0, pages_resident = 0;
+    if (!(statm >> pages_total >> pages_resident)) return 0;
+    return pages_resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Hands freed heap memory back to the OS so the next resident_bytes() is a clean baseline
+inline void release_free_memory() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+// Per-thread latency samples, merged once the threads have joined
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(size_t threads) : samples_(threads) {}
+
+    template <typename Fn>
+    void time(size_t thread, Fn&& fn) {
+        auto begin = Clock::now();
+        fn();
+        auto end = Clock::now();
+        samples_[thread].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+
+    void reserve(size_t per_thread) {
+        for (auto& s : samples_) s.reserve(per_thread);
+    }
+
+    std::vector<double> merged() const {
+        std::vector<double> all;
+        for (const auto& s : samples_) all.insert(all.end(), s.begin(), s.end());
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+private:
+    std::vector<std::vector<double>> samples_;
+};
+
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// Runs fn(thread_index) on `threads` threads and fills in timing and latency columns
+inline BenchmarkResult run_threads(const std::string& name, size_t threads,
+                                   const std::function<void(size_t, LatencyRecorder&)>& fn) {
+    LatencyRecorder recorder(threads);
+    auto begin = Clock::now();
+    if (threads == 1) {
+        fn(0, recorder);
+    } else {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&fn, &recorder, t]() { fn(t, recorder); });
+        }
+        for (auto& w : workers) w.join();
+    }
+    auto end = Clock::now();
+
+    auto samples = recorder.merged();
+    BenchmarkResult result;
+    result.name = name;
+    result.threads = threads;
+    result.operations = samples.size();
+    result.seconds = std::chrono::duration<double>(end - begin).count();
+    result.throughput = result.seconds > 0 ? result.operations / result.seconds : 0.0;
+    result.p50_us = percentile(samples, 0.50);
+    result.p99_us = percentile(samples, 0.99);
+    result.max_us = samples.empty() ? 0.0 : samples.back();
+    return result;
+}
+
+inline std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+inline bool write_json(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << std::fixed << std::setprecision(3) << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "  {\"name\": \"" << json_escape(r.name) << "\""
+            << ", \"graph_nodes\": " << r.graph_nodes
+            << ", \"graph_edges\": " << r.graph_edges
+            << ", \"threads\": " << r.threads
+            << ", \"operations\": " << r.operations
+            << ", \"seconds\": " << r.seconds
+            << ", \"throughput\": " << r.throughput
+            << ", \"p50_us\": " << r.p50_us
+            << ", \"p99_us\": " << r.p99_us
+            << ", \"max_us\": " << r.max_us
+            << ", \"rss_mb\": " << r.rss_mb
+            << ", \"hit_rate\": " << r.hit_rate << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+    return true;
+}
+
+inline bool write_csv(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << std::fixed << std::setprecision(3)
+        << "name,graph_nodes,graph_edges,threads,operations,seconds,throughput,p50_us,p99_us,max_us,rss_mb,hit_rate\n";
+    for (const auto& r : results) {
+        out << r.name << ',' << r.graph_nodes << ',' << r.graph_edges << ',' << r.threads << ','
+            << r.operations << ',' << r.seconds << ',' << r.throughput << ','
+            << r.p50_us << ',' << r.p99_us << ',' << r.max_us << ',' << r.rss_mb << ','
+            << r.hit_rate << '\n';
+    }
+    return true;
+}
+
+inline std::vector<size_t> parse_list(const std::string& arg) {
+    std::vector<size_t> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(std::stoull(item));
+    }
+    return values;
+}
+
+} // namespace bench
+} // namespace graph_db
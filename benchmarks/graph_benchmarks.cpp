@@ -0,0 +1,612 @@
+#include "bench_util.h"
+#include "graph_db/graph.h"
+#include "graph_db/graph_algo.h"
+#include "graph_db/generator/graph_generator.h"
+#include "graph_db/buffer/buffer_pool_manager.h"
+#include "graph_db/buffer/partitioned_buffer_pool.h"
+#include "graph_db/storage/disk_manager.h"
+#include "graph_db/storage/csv_importer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace graph_db;
+using namespace graph_db::bench;
+
+namespace {
+
+struct Options {
+    std::vector<size_t> sizes{10000, 100000};
+    std::vector<size_t> threads{1, 2, 4};
+    size_t avg_degree = 8;
+    std::string generator = "rmat"; // rmat | ba | er | grid
+    size_t point_ops = 100000;   // per benchmark, split across threads
+    size_t traversals = 16;      // full traversals per benchmark, split across threads
+    uint64_t seed = 42;
+    std::string filter;          // only run benchmarks whose name contains this
+    std::string json_path = "bench_results.json";
+    std::string csv_path;
+};
+
+constexpr size_t kIndexBuckets = 1024;
+
+bool selected(const Options& opt, const std::string& name) {
+    return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+}
+
+void print_result(const BenchmarkResult& r) {
+    std::printf("%-22s nodes=%-9zu threads=%-3zu ops=%-9zu %12.0f ops/s  p50=%9.2fus  p99=%9.2fus",
+                r.name.c_str(), r.graph_nodes, r.threads, r.operations, r.throughput, r.p50_us, r.p99_us);
+    if (r.rss_mb > 0) std::printf("  rss=+%.1fMB", r.rss_mb);
+    if (r.hit_rate >= 0) std::printf("  hits=%.1f%%", 100 * r.hit_rate);
+    std::printf("\n");
+}
+
+generator::EdgeList generate(const Options& opt, size_t nodes, const generator::GeneratorConfig& config) {
+    if (opt.generator == "ba") {
+        return generator::barabasi_albert(nodes, std::max<size_t>(1, opt.avg_degree), config);
+    }
+    if (opt.generator == "er") {
+        return generator::erdos_renyi(nodes, nodes * opt.avg_degree, config);
+    }
+    if (opt.generator == "grid") {
+        size_t side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(nodes))));
+        return generator::grid(side, side, true, config);
+    }
+    uint32_t scale = 1;
+    while ((size_t{2} << scale) <= nodes) ++scale;
+    return generator::rmat(scale, opt.avg_degree, config);
+}
+
+generator::GeneratorConfig generator_config(const Options& opt) {
+    generator::GeneratorConfig config;
+    config.seed = opt.seed;
+    config.max_weight = 100;
+    config.node_properties = 1;
+    config.property_cardinality = kIndexBuckets;
+    return config;
+}
+
+// Weighted graph with an indexed "p0" property (kIndexBuckets distinct values) on every node
+std::unique_ptr<Graph> build_graph(const Options& opt, const generator::EdgeList& list) {
+    auto g = std::make_unique<Graph>();
+    g->create_index("p0");
+    generator::populate(*g, list, generator_config(opt));
+    return g;
+}
+
+void bench_ingest(const Options& opt, const generator::EdgeList& list, size_t threads,
+                  std::vector<BenchmarkResult>& out) {
+    size_t nodes = list.num_nodes;
+    // Growth measured against a trimmed heap, while the benchmark's graph is still alive
+    size_t rss_before = 0;
+    auto start_rss = [&rss_before]() {
+        release_free_memory();
+        rss_before = resident_bytes();
+    };
+    auto rss_growth_mb = [&rss_before]() {
+        size_t now = resident_bytes();
+        return now > rss_before ? (now - rss_before) / (1024.0 * 1024.0) : 0.0;
+    };
+    if (selected(opt, "ingest_nodes")) {
+        start_rss();
+        Graph g;
+        auto r = run_threads("ingest_nodes", threads, [&](size_t t, LatencyRecorder& rec) {
+            for (size_t i = 0; i < nodes / threads; ++i) {
+                rec.time(t, [&]() { g.create_node(); });
+            }
+        });
+        r.graph_nodes = g.node_count();
+        r.rss_mb = rss_growth_mb();
+        out.push_back(r);
+    }
+    if (selected(opt, "ingest_edges")) {
+        // Replays the generated (skewed) edge list, striped across the writer threads
+        start_rss();
+        Graph g;
+        for (size_t i = 0; i < nodes; ++i) g.create_node();
+        auto r = run_threads("ingest_edges", threads, [&](size_t t, LatencyRecorder& rec) {
+            for (size_t i = t; i < list.edges.size(); i += threads) {
+                const auto& e = list.edges[i];
+                rec.time(t, [&]() { g.create_edge(e.from + 1, e.to + 1, "rel"); });
+            }
+        });
+        r.graph_nodes = g.node_count();
+        r.graph_edges = g.edge_count();
+        r.rss_mb = rss_growth_mb();
+        out.push_back(r);
+    }
+    if (selected(opt, "bulk_insert") && threads == 1) {
+        // Same edge list in batches; one op per inserted element
+        constexpr size_t kBatch = 1 << 16;
+        start_rss();
+        Graph g;
+        auto r = run_threads("bulk_insert", 1, [&](size_t t, LatencyRecorder& rec) {
+            rec.time(t, [&]() { g.bulk_insert(std::vector<NodeRecord>(nodes), {}); });
+            for (size_t first = 0; first < list.edges.size(); first += kBatch) {
+                size_t last = std::min(list.edges.size(), first + kBatch);
+                std::vector<EdgeRecord> batch(last - first);
+                for (size_t i = first; i < last; ++i) {
+                    const auto& e = list.edges[i];
+                    batch[i - first].from = e.from + 1;
+                    batch[i - first].to = e.to + 1;
+                    batch[i - first].label = "rel";
+                }
+                rec.time(t, [&]() { g.bulk_insert({}, std::move(batch)); });
+            }
+        });
+        r.operations = nodes + list.edges.size();
+        r.throughput = r.seconds > 0 ? r.operations / r.seconds : 0;
+        r.graph_nodes = g.node_count();
+        r.graph_edges = g.edge_count();
+        r.rss_mb = rss_growth_mb();
+        out.push_back(r);
+    }
+}
+
+void bench_reads(const Options& opt, Graph& g, size_t nodes, size_t threads, std::vector<BenchmarkResult>& out) {
+    auto finish = [&](BenchmarkResult r) {
+        r.graph_nodes = nodes;
+        r.graph_edges = g.edge_count();
+        out.push_back(r);
+    };
+    // Every case below picks random nodes, and snapshot_incremental random edges
+    if (nodes == 0) return;
+
+    if (selected(opt, "get_neighbors")) {
+        finish(run_threads("get_neighbors", threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            size_t sink = 0;
+            for (size_t i = 0; i < opt.point_ops / threads; ++i) {
+                NodeID id = pick(rng);
+                rec.time(t, [&]() { sink += g.get_neighbors(id).size(); });
+            }
+            (void)sink;
+        }));
+    }
+
+    if (selected(opt, "for_each_out_edge")) {
+        finish(run_threads("for_each_out_edge", threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            int64_t sink = 0;
+            for (size_t i = 0; i < opt.point_ops / threads; ++i) {
+                NodeID id = pick(rng);
+                rec.time(t, [&]() {
+                    g.for_each_out_edge(id, [&sink](EdgeID, NodeID, int64_t weight) { sink += weight; });
+                });
+            }
+            (void)sink;
+        }));
+    }
+
+    if (selected(opt, "snapshot_incremental") && g.edge_count() > 0) {
+        // Touch one edge, then rebuild: measures the incremental CSR refresh
+        finish(run_threads("snapshot_incremental", 1, [&](size_t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed);
+            std::uniform_int_distribution<EdgeID> pick(1, g.edge_count());
+            for (size_t i = 0; i < opt.traversals; ++i) {
+                g.set_edge_weight(pick(rng), 1 + static_cast<int64_t>(i % 100));
+                rec.time(0, [&]() { g.snapshot(); });
+            }
+        }));
+    }
+
+    // Traversals run on the cached CSR snapshot; build it outside the timed region
+    g.snapshot();
+    struct Traversal {
+        const char* name;
+        std::function<size_t(NodeID)> run;
+    };
+    std::vector<Traversal> traversals = {
+        {"bfs", [&](NodeID s) { return bfs(g, s).size(); }},
+        {"dfs", [&](NodeID s) { return dfs(g, s).size(); }},
+        {"dijkstra", [&](NodeID s) { return dijkstra(g, s).size(); }},
+    };
+    for (const auto& trav : traversals) {
+        if (!selected(opt, trav.name)) continue;
+        finish(run_threads(trav.name, threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            size_t runs = std::max<size_t>(1, opt.traversals / threads);
+            for (size_t i = 0; i < runs; ++i) {
+                NodeID start = pick(rng);
+                rec.time(t, [&]() { trav.run(start); });
+            }
+        }));
+    }
+
+    if (selected(opt, "shortest_path")) {
+        finish(run_threads("shortest_path", threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            for (size_t i = 0; i < opt.point_ops / threads / 100 + 1; ++i) {
+                NodeID from = pick(rng), to = pick(rng);
+                rec.time(t, [&]() { shortest_path(g, from, to); });
+            }
+        }));
+    }
+
+    if (selected(opt, "parallel_bfs")) {
+        // One query at a time; `threads` is the pool size here
+        parallel::ThreadPool pool(threads);
+        auto csr = g.snapshot();
+        finish(run_threads("parallel_bfs", 1, [&](size_t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            for (size_t i = 0; i < opt.traversals; ++i) {
+                NodeID start = pick(rng);
+                rec.time(0, [&]() { parallel_bfs(*csr, start, pool); });
+            }
+        }));
+        out.back().threads = threads;
+    }
+
+    if (selected(opt, "delta_stepping")) {
+        parallel::ThreadPool pool(threads);
+        auto csr = g.snapshot();
+        finish(run_threads("delta_stepping", 1, [&](size_t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            for (size_t i = 0; i < opt.traversals; ++i) {
+                NodeID start = pick(rng);
+                rec.time(0, [&]() { delta_stepping(*csr, start, 0, pool); });
+            }
+        }));
+        out.back().threads = threads;
+    }
+
+    if (selected(opt, "index_lookup")) {
+        finish(run_threads("index_lookup", threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<int64_t> pick(0, kIndexBuckets - 1);
+            size_t sink = 0;
+            for (size_t i = 0; i < opt.point_ops / threads; ++i) {
+                PropertyValue key = pick(rng);
+                rec.time(t, [&]() { sink += g.find_nodes("p0", key).size(); });
+            }
+            (void)sink;
+        }));
+    }
+
+    if (selected(opt, "index_range")) {
+        // p0 BETWEEN k AND k+9: ~1% of the nodes per query
+        finish(run_threads("index_range", threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<int64_t> pick(0, kIndexBuckets - 10);
+            size_t sink = 0;
+            for (size_t i = 0; i < opt.point_ops / threads / 100 + 1; ++i) {
+                int64_t low = pick(rng);
+                RangeScan scan{RangeBound{low}, RangeBound{low + 9}};
+                rec.time(t, [&]() { sink += g.find_nodes_in_range("p0", scan).size(); });
+            }
+            (void)sink;
+        }));
+    }
+
+    if (selected(opt, "index_update")) {
+        // Moves random nodes to another p0 bucket: one index remove and insert per op
+        finish(run_threads("index_update", threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            std::uniform_int_distribution<NodeID> pick(1, nodes);
+            std::uniform_int_distribution<int64_t> bucket(0, kIndexBuckets - 1);
+            for (size_t i = 0; i < opt.point_ops / threads; ++i) {
+                Node* node = g.get_node(pick(rng));
+                int64_t value = bucket(rng);
+                rec.time(t, [&]() { node->set_property("p0", value); });
+            }
+        }));
+    }
+}
+
+void bench_serializer(const Options& opt, Graph& g, size_t nodes, std::vector<BenchmarkResult>& out) {
+    const std::string path = "bench_graph.db";
+    size_t elements = g.node_count() + g.edge_count();
+    auto per_element = [&](BenchmarkResult r) {
+        // Report elements/s rather than files/s so sizes are comparable
+        r.graph_nodes = nodes;
+        r.graph_edges = g.edge_count();
+        r.throughput = r.seconds > 0 ? elements / r.seconds : 0.0;
+        out.push_back(r);
+    };
+    if (selected(opt, "serializer_save") || selected(opt, "serializer_load")) {
+        per_element(run_threads("serializer_save", 1, [&](size_t, LatencyRecorder& rec) {
+            rec.time(0, [&]() { g.save_to_file(path); });
+        }));
+    }
+    if (selected(opt, "serializer_load")) {
+        per_element(run_threads("serializer_load", 1, [&](size_t, LatencyRecorder& rec) {
+            Graph loaded;
+            rec.time(0, [&]() { loaded.load_from_file(path); });
+        }));
+    }
+    std::remove(path.c_str());
+
+    if (selected(opt, "csv_import")) {
+        const std::string nodes_csv = "bench_nodes.csv";
+        const std::string edges_csv = "bench_edges.csv";
+        {
+            std::ofstream node_out(nodes_csv);
+            node_out << "id\n";
+            g.for_each_node([&node_out](Node& node) { node_out << node.get_id() << '\n'; });
+            std::ofstream edge_out(edges_csv);
+            edge_out << "from,to,label,weight\n";
+            g.for_each_edge([&edge_out](Edge& edge) {
+                edge_out << edge.from_node() << ',' << edge.to_node() << ',' << edge.label() << ','
+                         << edge.get_weight() << '\n';
+            });
+        }
+        per_element(run_threads("csv_import", 1, [&](size_t, LatencyRecorder& rec) {
+            Graph loaded;
+            storage::CsvImporter importer(loaded);
+            rec.time(0, [&]() {
+                importer.import_nodes(nodes_csv);
+                importer.import_edges(edges_csv);
+            });
+        }));
+        std::remove(nodes_csv.c_str());
+        std::remove(edges_csv.c_str());
+    }
+}
+
+void bench_remove(const Options& opt, const generator::EdgeList& list, std::vector<BenchmarkResult>& out) {
+    if (!selected(opt, "remove_node")) return;
+    // Deletes a random 1% of the nodes (indexed, skewed degrees) from a fresh copy
+    auto g = build_graph(opt, list);
+    size_t nodes = g->node_count();
+    if (nodes == 0) return;
+    auto r = run_threads("remove_node", 1, [&](size_t, LatencyRecorder& rec) {
+        std::mt19937_64 rng(opt.seed);
+        std::uniform_int_distribution<NodeID> pick(1, nodes);
+        for (size_t i = 0; i < std::max<size_t>(1, nodes / 100); ++i) {
+            NodeID id = pick(rng);
+            rec.time(0, [&]() { g->remove_node(id); });
+        }
+    });
+    r.graph_nodes = nodes;
+    r.graph_edges = list.edges.size();
+    out.push_back(r);
+}
+
+void bench_create_index(const Options& opt, const generator::EdgeList& list, std::vector<BenchmarkResult>& out) {
+    if (!selected(opt, "create_index")) return;
+    // Backfill of the p0 property over an already loaded graph; one op per node
+    Graph g;
+    generator::populate(g, list, generator_config(opt));
+    auto r = run_threads("create_index", 1, [&](size_t, LatencyRecorder& rec) {
+        rec.time(0, [&]() { g.create_index("p0"); });
+    });
+    r.operations = g.node_count();
+    r.throughput = r.seconds > 0 ? r.operations / r.seconds : 0;
+    r.threads = parallel::ThreadPool::global().size();
+    r.graph_nodes = g.node_count();
+    r.graph_edges = g.edge_count();
+    out.push_back(r);
+}
+
+void bench_index(const Options& opt, size_t keys, std::vector<BenchmarkResult>& out) {
+    // Point lookups on `keys` distinct random int64 keys: variant-keyed tree vs typed tree
+    // vs hash index vs paged tree
+    std::mt19937_64 rng(opt.seed);
+    std::vector<int64_t> values(keys);
+    for (auto& v : values) v = static_cast<int64_t>(rng());
+    auto run = [&](const char* name, auto& tree, auto make_key) {
+        if (!selected(opt, name) || keys == 0) return;
+        for (size_t i = 0; i < keys; ++i) tree.insert(make_key(values[i]), i);
+        auto r = run_threads(name, 1, [&](size_t, LatencyRecorder& rec) {
+            std::mt19937_64 pick_rng(opt.seed + 1);
+            size_t sink = 0;
+            for (size_t i = 0; i < opt.point_ops; ++i) {
+                auto key = make_key(values[pick_rng() % keys]);
+                rec.time(0, [&]() { sink += tree.find(key).size(); });
+            }
+            (void)sink;
+        });
+        r.graph_nodes = keys;
+        out.push_back(r);
+    };
+    if (selected(opt, "index_find_generic")) {
+        BPlusTree generic;
+        run("index_find_generic", generic, [](int64_t v) { return PropertyValue(v); });
+    }
+    if (selected(opt, "index_find_typed")) {
+        TypedBPlusTree<Int64KeyTraits> typed;
+        run("index_find_typed", typed, [](int64_t v) { return v; });
+    }
+    if (selected(opt, "index_find_hash")) {
+        HashIndex hash;
+        run("index_find_hash", hash, [](int64_t v) { return PropertyValue(v); });
+    }
+    if (selected(opt, "index_find_paged")) {
+        // Pool large enough for the whole tree: the cost of pinning pages, not of I/O
+        const std::string path = "bench_paged_index.db";
+        std::remove(path.c_str());
+        {
+            storage::DiskManager disk(path);
+            buffer::BufferPoolManager pool(keys / 64 + 64, &disk);
+            PagedBPlusTree paged(pool);
+            run("index_find_paged", paged, [](int64_t v) { return PropertyValue(v); });
+        }
+        std::remove(path.c_str());
+    }
+}
+
+void bench_buffer_pool(const Options& opt, size_t threads, std::vector<BenchmarkResult>& out) {
+    const std::string path = "bench_pages.db";
+    constexpr size_t kPoolSize = 256;
+    constexpr PageID kPages = 1024; // 4x the pool so the miss path is exercised
+    auto run = [&](const char* name, buffer::BufferPool& pool) {
+        auto r = run_threads(name, threads, [&](size_t t, LatencyRecorder& rec) {
+            std::mt19937_64 rng(opt.seed + t);
+            // 90% of accesses go to a hot set that fits in the pool
+            std::uniform_int_distribution<PageID> hot(0, kPoolSize / 2 - 1);
+            std::uniform_int_distribution<PageID> cold(0, kPages - 1);
+            std::uniform_int_distribution<int> coin(0, 9);
+            for (size_t i = 0; i < opt.point_ops / threads; ++i) {
+                PageID pid = coin(rng) == 0 ? cold(rng) : hot(rng);
+                rec.time(t, [&]() {
+                    if (pool.fetch_page(pid)) pool.unpin_page(pid, false);
+                });
+            }
+        });
+        r.graph_nodes = kPages;
+        out.push_back(r);
+    };
+    bool single = selected(opt, "bpm_fetch_unpin");
+    bool partitioned = selected(opt, "bpm_partitioned_fetch_unpin");
+    if (!single && !partitioned) return;
+    std::remove(path.c_str());
+    {
+        storage::DiskManager disk(path);
+        char data[4096] = {};
+        for (PageID p = 0; p < kPages; ++p) disk.write_page(p, data);
+        if (single) {
+            buffer::BufferPoolManager bpm(kPoolSize, &disk);
+            run("bpm_fetch_unpin", bpm);
+        }
+        if (partitioned) {
+            // One instance per thread, so the hot set spreads over as many latches
+            buffer::PartitionedBufferPool pool(kPoolSize, &disk, std::clamp<size_t>(threads, 1, kPoolSize / 16));
+            run("bpm_partitioned_fetch_unpin", pool);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+// Point lookups over a hot set that fits in the pool, interleaved with a scan over a
+// range 16 times the pool, as when analytics run next to OLTP traffic. Reports the hit
+// rate of the point lookups under each replacement policy.
+void bench_replacers(const Options& opt, std::vector<BenchmarkResult>& out) {
+    const std::string path = "bench_replacer_pages.db";
+    constexpr size_t kPoolSize = 256;
+    constexpr PageID kHotPages = kPoolSize / 2;
+    constexpr PageID kScanPages = kPoolSize * 16;
+    const std::pair<const char*, buffer::ReplacerKind> kinds[] = {
+        {"bpm_hit_rate_lru", buffer::ReplacerKind::LRU},
+        {"bpm_hit_rate_clock", buffer::ReplacerKind::Clock},
+        {"bpm_hit_rate_lru_k", buffer::ReplacerKind::LRUK},
+        {"bpm_hit_rate_2q", buffer::ReplacerKind::TwoQ},
+    };
+    bool any = false;
+    for (const auto& kind : kinds) any = any || selected(opt, kind.first);
+    if (!any) return;
+    std::remove(path.c_str());
+    {
+        storage::DiskManager disk(path);
+        char data[4096] = {};
+        for (PageID p = 0; p < kHotPages + kScanPages; ++p) disk.write_page(p, data);
+        for (const auto& [name, kind] : kinds) {
+            if (!selected(opt, name)) continue;
+            buffer::BufferPoolManager bpm(kPoolSize, &disk, kind);
+            auto touch = [&bpm](PageID pid) {
+                if (bpm.fetch_page(pid)) bpm.unpin_page(pid, false);
+            };
+            // Warm up: the hot set has been looked up before the scan starts
+            for (int round = 0; round < 2; ++round) {
+                for (PageID pid = 0; pid < kHotPages; ++pid) touch(pid);
+            }
+            uint64_t lookups = 0, lookup_hits = 0;
+            auto r = run_threads(name, 1, [&](size_t t, LatencyRecorder& rec) {
+                std::mt19937_64 rng(opt.seed);
+                std::uniform_int_distribution<PageID> hot(0, kHotPages - 1);
+                PageID scan = 0;
+                for (size_t i = 0; i < opt.point_ops; ++i) {
+                    // Every other access is the scan's next page
+                    PageID pid = i % 2 ? kHotPages + scan++ % kScanPages : hot(rng);
+                    uint64_t hits = bpm.hits();
+                    rec.time(t, [&]() { touch(pid); });
+                    if (pid < kHotPages) {
+                        ++lookups;
+                        lookup_hits += bpm.hits() - hits;
+                    }
+                }
+            });
+            r.graph_nodes = kHotPages + kScanPages;
+            r.hit_rate = lookups ? static_cast<double>(lookup_hits) / lookups : 0.0;
+            out.push_back(r);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+void usage(const char* prog) {
+    std::printf("Usage: %s [--sizes N,N,...] [--threads T,T,...] [--generator rmat|ba|er|grid]\n"
+                "          [--degree D] [--ops N] [--traversals N] [--seed S]\n"
+                "          [--filter NAME] [--json FILE] [--csv FILE]\n",
+                prog);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--sizes") opt.sizes = parse_list(next());
+        else if (arg == "--threads") opt.threads = parse_list(next());
+        else if (arg == "--degree") opt.avg_degree = std::stoull(next());
+        else if (arg == "--generator") opt.generator = next();
+        else if (arg == "--ops") opt.point_ops = std::stoull(next());
+        else if (arg == "--traversals") opt.traversals = std::stoull(next());
+        else if (arg == "--seed") opt.seed = std::stoull(next());
+        else if (arg == "--filter") opt.filter = next();
+        else if (arg == "--json") opt.json_path = next();
+        else if (arg == "--csv") opt.csv_path = next();
+        else {
+            usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (size_t requested : opt.sizes) {
+        // The generator may round the size (e.g. R-MAT uses powers of two)
+        auto list = generate(opt, requested, generator_config(opt));
+        auto g = build_graph(opt, list);
+        size_t nodes = g->node_count();
+        for (size_t threads : opt.threads) {
+            size_t first = results.size();
+            bench_ingest(opt, list, threads, results);
+            bench_reads(opt, *g, nodes, threads, results);
+            for (size_t i = first; i < results.size(); ++i) print_result(results[i]);
+        }
+        size_t first = results.size();
+        bench_serializer(opt, *g, nodes, results);
+        bench_remove(opt, list, results);
+        bench_index(opt, nodes, results);
+        bench_create_index(opt, list, results);
+        for (size_t i = first; i < results.size(); ++i) print_result(results[i]);
+    }
+    for (size_t threads : opt.threads) {
+        size_t first = results.size();
+        bench_buffer_pool(opt, threads, results);
+        for (size_t i = first; i < results.size(); ++i) print_result(results[i]);
+    }
+    size_t first = results.size();
+    bench_replacers(opt, results);
+    for (size_t i = first; i < results.size(); ++i) print_result(results[i]);
+
+    if (!opt.json_path.empty() && !write_json(opt.json_path, results)) {
+        std::fprintf(stderr, "Failed to write %s\n", opt.json_path.c_str());
+        return 1;
+    }
+    if (!opt.csv_path.empty() && !write_csv(opt.csv_path, results)) {
+        std::fprintf(stderr, "Failed to write %s\n", opt.csv_path.c_str());
+        return 1;
+    }
+    return 0;
+}
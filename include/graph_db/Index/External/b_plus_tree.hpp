@@ -10,8 +10,82 @@ namespace bplustree {
 
 template<typename Key, typename Value>
 class BPlusTree {
+    struct Node;
+
 public:
-    BPlusTree(size_t degree = 3) : degree_(degree), root_(new Node(true)) {}
+    BPlusTree(size_t degree = 3) : degree_(degree), root_(new Node(true)), last_leaf_(root_) {}
+    ~BPlusTree() { destroy(root_); }
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Bidirectional cursor over the (key, values) entries of the linked leaves, in key
+    // order. Empty leaves left behind by remove() are skipped. Invalidated by any write.
+    class const_iterator {
+    public:
+        const Key& key() const { return leaf_->keys[pos_]; }
+        const std::vector<Value>& values() const { return leaf_->values[pos_]; }
+
+        const_iterator& operator++() {
+            if (++pos_ < leaf_->keys.size()) return *this;
+            leaf_ = leaf_->next;
+            pos_ = 0;
+            skip_empty_forward();
+            return *this;
+        }
+        const_iterator& operator--() {
+            // From end() step back onto the last leaf
+            if (!leaf_) {
+                leaf_ = tree_->last_leaf_;
+                pos_ = leaf_->keys.size();
+            }
+            while (pos_ == 0 && leaf_->prev) {
+                leaf_ = leaf_->prev;
+                pos_ = leaf_->keys.size();
+            }
+            --pos_;
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return leaf_ == other.leaf_ && pos_ == other.pos_; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class BPlusTree;
+        const_iterator(const BPlusTree* tree, const Node* leaf, size_t pos) : tree_(tree), leaf_(leaf), pos_(pos) {
+            if (leaf_ && pos_ >= leaf_->keys.size()) {
+                leaf_ = leaf_->next;
+                pos_ = 0;
+                skip_empty_forward();
+            }
+        }
+        void skip_empty_forward() {
+            while (leaf_ && leaf_->keys.empty()) leaf_ = leaf_->next;
+        }
+
+        const BPlusTree* tree_;
+        const Node* leaf_; // null for end()
+        size_t pos_;
+    };
+
+    const_iterator begin() const {
+        const Node* node = root_;
+        while (!node->is_leaf) node = node->children.front();
+        return const_iterator(this, node, 0);
+    }
+    const_iterator end() const { return const_iterator(this, nullptr, 0); }
+    // First entry with key >= `key`
+    const_iterator lower_bound(const Key& key) const {
+        const Node* leaf = find_leaf(root_, key);
+        size_t i = 0;
+        while (i < leaf->keys.size() && leaf->keys[i] < key) i++;
+        return const_iterator(this, leaf, i);
+    }
+    // First entry with key > `key`
+    const_iterator upper_bound(const Key& key) const {
+        const Node* leaf = find_leaf(root_, key);
+        size_t i = 0;
+        while (i < leaf->keys.size() && !(key < leaf->keys[i])) i++;
+        return const_iterator(this, leaf, i);
+    }
 
     void insert(const Key& key, const Value& value) {
         // This comparison is now safe
@@ -55,13 +129,22 @@ private:
         std::vector<Key> keys;
         std::vector<std::vector<Value>> values; // For leaf nodes
         std::vector<Node*> children;
+        Node* prev = nullptr; // Leaf siblings, in key order
+        Node* next = nullptr;
 
         Node(bool leaf) : is_leaf(leaf) {}
     };
 
     size_t degree_; 
     Node* root_;
+    Node* last_leaf_;
+
+    static void destroy(Node* node) {
+        for (Node* child : node->children) destroy(child);
+        delete node;
+    }
 
+    // Keys equal to a separator live in its left subtree
     Node* find_leaf(Node* node, const Key& key) const {
         if (node->is_leaf) {
             return node;
@@ -108,12 +191,20 @@ private:
         parent->children.insert(parent->children.begin() + index + 1, new_child);
 
         new_child->keys.assign(child->keys.begin() + degree_, child->keys.end());
-        child->keys.resize(degree_ - 1);
 
         if (child->is_leaf) {
+            // Leaves keep the separator (it was copied up, not moved), so lookups that
+            // route keys equal to it to the left still find its values
+            child->keys.resize(degree_);
             new_child->values.assign(child->values.begin() + degree_, child->values.end());
-            child->values.resize(degree_ - 1);
+            child->values.resize(degree_);
+            new_child->prev = child;
+            new_child->next = child->next;
+            if (child->next) child->next->prev = new_child;
+            child->next = new_child;
+            if (last_leaf_ == child) last_leaf_ = new_child;
         } else {
+            child->keys.resize(degree_ - 1);
             new_child->children.assign(child->children.begin() + degree_, child->children.end());
             child->children.resize(degree_);
         }
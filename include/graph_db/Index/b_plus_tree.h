@@ -2,18 +2,43 @@
 
 #include "graph_db/types.h"
 #include "External/b_plus_tree.hpp"
+#include <functional>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace graph_db {
 
+struct RangeBound {
+    PropertyValue value;
+    bool inclusive = true;
+};
+
+// Ordered scan over an index. Bounds compare within their own value type (an int64
+// range never returns strings); with no bounds every key is visited in variant order.
+// `limit` caps the number of returned IDs, 0 means no cap.
+struct RangeScan {
+    std::optional<RangeBound> lower;
+    std::optional<RangeBound> upper;
+    bool descending = false;
+    size_t limit = 0;
+};
+
 class BPlusTree {
 public:
+    // Return false to stop the scan
+    using ScanFn = std::function<bool(const PropertyValue& key, const std::vector<NodeID>& values)>;
+
     void insert(const PropertyValue& key, NodeID value);
     std::vector<NodeID> find(const PropertyValue& key) const;
     void remove(const PropertyValue& key, NodeID value);
+    // Visits the keys inside the range in ascending (or descending) order; ignores `limit`
+    void scan(const RangeScan& range, const ScanFn& fn) const;
+    // Visits string keys starting with `prefix` in ascending order
+    void scan_prefix(const std::string& prefix, const ScanFn& fn) const;
 
 private:
     mutable bplustree::BPlusTree<PropertyValue, NodeID> tree_;
 };
 
-}
\ No newline at end of file
+}
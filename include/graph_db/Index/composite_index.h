@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../types.h"
+#include "index.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace graph_db {
+
+// Index over a tuple of properties, e.g. (tenant, created_at), ordered lexicographically.
+// Each tuple is encoded as a byte string whose byte order is the tuple order (see
+// append), and the strings live in an ordinary string-keyed Index. An equality prefix is
+// then a string prefix, and equality on the leading columns plus a range on the next one
+// is a single range scan. A node is indexed only while it has every key.
+class CompositeIndex {
+public:
+    CompositeIndex(std::vector<std::string> keys, bool building, IndexKind kind,
+                   std::unique_ptr<PagedBPlusTree> paged = nullptr)
+        : keys_(std::move(keys)), index_(building, kind, std::move(paged)) {}
+
+    const std::vector<std::string>& keys() const { return keys_; }
+    bool covers(const std::string& key) const;
+    // The underlying index of encoded tuples
+    Index& index() { return index_; }
+
+    // Encoded tuple of `properties`, or nullopt if one of the keys is missing. The
+    // second form first sets `key` to *value, or drops it if value is null.
+    std::optional<std::string> key_of(const PropertyMap& properties) const;
+    std::optional<std::string> key_of(const PropertyMap& properties, const std::string& key,
+                                      const PropertyValue* value) const;
+    // Moves `id` from tuple `before` to `after`; either may be absent
+    void replace(const std::optional<std::string>& before, const std::optional<std::string>& after, NodeID id);
+
+    // IDs whose leading columns equal `prefix` and whose next column is within
+    // next.lower / next.upper, in tuple order. As in RangeScan, the bounds share a type
+    // and select only values of that type; descending and limit apply as usual.
+    std::vector<NodeID> find(const std::vector<PropertyValue>& prefix, const RangeScan& next = {}) const;
+
+    static std::string encode(const std::vector<PropertyValue>& values);
+    // Appends one column: its type tag, then a body whose byte order is the value order
+    // and which is never a prefix of another body, so columns concatenate safely
+    static void append(std::string& out, const PropertyValue& value);
+
+private:
+    std::vector<std::string> keys_;
+    Index index_;
+};
+
+}
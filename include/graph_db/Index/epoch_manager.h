@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace graph_db {
+
+// Epoch-based reclamation for structures that are read without locks. A thread pins the
+// current epoch for the duration of an operation; memory a writer has unlinked is
+// retired and freed only once every thread that was pinned when it was retired has
+// unpinned. Pins nest, and each thread owns a slot that is recycled when it exits.
+class EpochManager {
+public:
+    // Pins the calling thread while alive
+    class Guard {
+    public:
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        friend class EpochManager;
+        Guard() = default;
+    };
+
+    static EpochManager& global();
+
+    Guard pin();
+
+    // Frees `ptr` once no pinned thread can still hold it. The caller has already
+    // unlinked it, so threads that pin from now on cannot reach it.
+    template <typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+    void retire(void* ptr, void (*deleter)(void*));
+
+    ~EpochManager();
+
+private:
+    struct Retired {
+        uint64_t epoch;
+        void* ptr;
+        void (*deleter)(void*);
+    };
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0}; // 0 while the owner is not pinned
+        std::atomic<bool> owned{false};
+        Slot* next = nullptr;           // immutable once the slot is published
+        uint32_t depth = 0;             // owner thread only
+        std::vector<Retired> retired;   // owner thread only
+    };
+    friend struct EpochSlotHandle;
+
+    // Retire lists are scanned once they reach this size
+    static constexpr size_t kReclaimBatch = 64;
+
+    Slot* local_slot();
+    Slot* acquire_slot();
+    void release_slot(Slot* slot);
+    // Advances the epoch and frees `list` entries older than every pinned thread
+    void reclaim(std::vector<Retired>& list);
+    uint64_t min_pinned_epoch() const;
+
+    std::atomic<uint64_t> epoch_{1};
+    std::atomic<Slot*> slots_{nullptr};
+    // Leftovers of exited threads, freed by later reclaims
+    std::mutex orphans_mutex_;
+    std::vector<Retired> orphans_;
+};
+
+}
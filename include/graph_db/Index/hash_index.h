@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../types.h"
+#include <cstdint>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace graph_db {
+
+// Equality-only index from property values to posting lists. Open addressing with
+// linear probing: probes walk a dense array of hash tags and only touch an entry whose
+// tag matches, so a unique-key lookup is usually a cache line or two.
+//
+// Growing never rehashes everything at once. The full table becomes the old table, and
+// every later write moves its next kMigrateStep slots into a table twice the size.
+// Until it drains, lookups probe both tables; new keys only go into the new one. The
+// doubled table is not initialized up front either: its tags come zeroed from calloc,
+// which maps fresh zero pages for large sizes, and entries are only constructed in the
+// slots that get used, so a resize costs no more than the writes that follow it.
+//
+// Safe for concurrent use: lookups share mutex_, writes take it exclusively.
+class HashIndex {
+public:
+    HashIndex() : table_(kInitialCapacity) {}
+
+    // Appends `value` to the key's posting list
+    void insert(const PropertyValue& key, NodeID value);
+    void remove(const PropertyValue& key, NodeID value);
+    // IDs in insertion order
+    std::vector<NodeID> find(const PropertyValue& key) const;
+    // Distinct keys
+    size_t size() const;
+
+private:
+    struct Entry {
+        PropertyValue key;
+        std::vector<NodeID> ids;
+    };
+    // Entries live only in slots whose tag is a hash; other slots are raw storage
+    struct Table {
+        Table() = default;
+        explicit Table(size_t capacity);
+        Table(Table&& other) noexcept { *this = std::move(other); }
+        Table& operator=(Table&& other) noexcept;
+        ~Table() { release(); }
+        size_t capacity() const { return capacity_; }
+        void release();
+
+        uint64_t* tags = nullptr; // kEmpty, kDeleted, or the key's hash with the top bit set
+        Entry* entries = nullptr;
+        size_t size = 0;          // live entries
+        size_t capacity_ = 0;
+    };
+    struct Location {
+        bool found;
+        bool old; // in old_ rather than table_
+        size_t slot;
+    };
+
+    static constexpr uint64_t kEmpty = 0;
+    // Left behind in the old table only; the current table deletes by backward shift
+    static constexpr uint64_t kDeleted = 1;
+    static constexpr size_t kInitialCapacity = 16;
+    static constexpr size_t kMigrateStep = 16;
+
+    static uint64_t tag_of(const PropertyValue& key);
+    // Slot of `key` in `table`, or table.capacity() if absent
+    static size_t find_slot(const Table& table, const PropertyValue& key, uint64_t tag);
+    Location locate(const PropertyValue& key, uint64_t tag) const;
+    // Stores `entry` in the first free slot of its probe sequence
+    static size_t place(Table& table, uint64_t tag, Entry entry);
+    Entry& entry(const Location& at) { return (at.old ? old_ : table_).entries[at.slot]; }
+    void erase(const Location& at);
+    // Moves up to `slots` old-table slots into the current table
+    void migrate(size_t slots);
+    void grow();
+
+    Table table_;
+    Table old_;           // draining while a resize is in progress, else empty
+    size_t migrated_ = 0; // old_ slots before this have been moved
+    mutable std::shared_mutex mutex_;
+};
+
+}
@@ -2,25 +2,185 @@
 
 #include "../types.h"
 #include "b_plus_tree.h"
+#include "hash_index.h"
+#include "paged_b_plus_tree.h"
+#include "typed_b_plus_tree.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace graph_db {
 
+// CREATE INDEX ON <key> [USING BTREE|HASH|PAGED]
+enum class IndexKind {
+    BTree, // ordered: equality, range, prefix and ORDER BY
+    Hash,  // equality only, O(1) lookups
+    Paged  // ordered, kept in the graph's index file through the buffer pool
+};
+
+// Property index. The first key picks a fixed-width TypedBPlusTree for its type; most
+// columns are homogeneous and stay there. The first key of another type moves every
+// entry into the generic variant-keyed BPlusTree, which the index then keeps.
+//
+// An index created over existing data starts out building: writes are logged instead of
+// applied, and lookups wait until finish_build() has loaded the backfill and replayed
+// the log. If the build fails, abandon_build() wakes them and they throw instead.
+//
+// Safe for concurrent use. The typed trees synchronize internally, so their readers and
+// writers only share tree_mutex_; the generic tree, and switching trees, take it
+// exclusively.
+//
+// A hash index keeps every key in a HashIndex instead and answers equality lookups
+// only; range and prefix scans throw. A paged index keeps every key in the
+// PagedBPlusTree it is given, which lives on disk and outlives the Index.
 class Index {
 public:
-    void insert(const PropertyValue& key, NodeID value) {
-        tree_.insert(key, value);
+    explicit Index(bool building = false, IndexKind kind = IndexKind::BTree,
+                   std::unique_ptr<PagedBPlusTree> paged = nullptr)
+        : hash_(kind == IndexKind::Hash ? std::make_unique<HashIndex>() : nullptr),
+          paged_(std::move(paged)),
+          building_(building) {
+        if ((kind == IndexKind::Paged) != (paged_ != nullptr)) {
+            throw std::runtime_error("paged index: needs a tree, and only paged indexes take one");
+        }
+    }
+
+    IndexKind kind() const { return hash_ ? IndexKind::Hash : paged_ ? IndexKind::Paged : IndexKind::BTree; }
+
+    void insert(const PropertyValue& key, NodeID value);
+
+    // Inserts in key order so consecutive inserts land in the same leaves
+    void insert_batch(std::vector<std::pair<PropertyValue, NodeID>> entries) {
+        std::sort(entries.begin(), entries.end());
+        for (const auto& [key, value] : entries) {
+            insert(key, value);
+        }
     }
 
-    std::vector<NodeID> find(const PropertyValue& key) const {
-        return tree_.find(key);
+    std::vector<NodeID> find(const PropertyValue& key) const;
+
+    // IDs of the keys in the range, in key order (IDs sharing a key keep insertion order)
+    std::vector<NodeID> range(const RangeScan& scan) const {
+        require_ordered("range scan");
+        wait_until_built();
+        if (paged_) return paged_->range(scan);
+        std::shared_lock lock(tree_mutex_);
+        std::vector<NodeID> result;
+        visit_scan([&](const auto& tree) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(tree)>, BPlusTree>) {
+                tree.scan(scan, [&](const PropertyValue&, const std::vector<NodeID>& values) {
+                    return collect(values, scan.limit, result);
+                });
+            } else {
+                tree.collect(scan, result);
+            }
+        });
+        return result;
     }
 
-    void remove(const PropertyValue& key, NodeID value) {
-        tree_.remove(key, value);
+    std::vector<NodeID> prefix(const std::string& prefix, size_t limit = 0) const {
+        require_ordered("prefix scan");
+        wait_until_built();
+        if (paged_) return paged_->prefix(prefix, limit);
+        std::shared_lock lock(tree_mutex_);
+        std::vector<NodeID> result;
+        visit_scan([&](const auto& tree) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(tree)>, BPlusTree>) {
+                tree.scan_prefix(prefix, [&](const PropertyValue&, const std::vector<NodeID>& values) {
+                    return collect(values, limit, result);
+                });
+            } else {
+                tree.collect_prefix(prefix, limit, result);
+            }
+        });
+        return result;
+    }
+
+    void remove(const PropertyValue& key, NodeID value);
+
+    // Ends the build: bulk-loads `sorted` (the backfill, sorted by key) bottom-up, then
+    // replays the writes logged meanwhile. Replayed inserts skip entries the backfill
+    // already saw, so a write racing with the scan lands exactly once.
+    void finish_build(std::vector<std::pair<PropertyValue, NodeID>> sorted);
+    // Ends a build that threw: lookups, waiting or not, throw from now on and writes are
+    // dropped. The owner unregisters the index but keeps it alive for pointer holders.
+    void abandon_build();
+
+    // True while the index uses a type-specialized tree (or is still empty)
+    bool is_typed() const {
+        std::shared_lock lock(tree_mutex_);
+        return !hash_ && !paged_ && !generic();
     }
 
 private:
-    BPlusTree tree_;
+    // Typed alternatives follow PropertyValue's order, so a key of alternative i belongs
+    // in tree alternative i + 1
+    using Tree = std::variant<std::monostate,
+                              std::unique_ptr<TypedBPlusTree<Int64KeyTraits>>,
+                              std::unique_ptr<TypedBPlusTree<DoubleKeyTraits>>,
+                              std::unique_ptr<TypedBPlusTree<StringKeyTraits>>,
+                              std::unique_ptr<TypedBPlusTree<BoolKeyTraits>>,
+                              std::unique_ptr<BPlusTree>>;
+
+    struct PendingWrite {
+        PropertyValue key;
+        NodeID value;
+        bool insert;
+    };
+
+    bool typed_for(const PropertyValue& key) const { return tree_.index() == key.index() + 1; }
+    bool generic() const { return std::holds_alternative<std::unique_ptr<BPlusTree>>(tree_); }
+    // Empty typed tree for PropertyValue alternative `type`
+    void make_typed(size_t type);
+    void make_generic();
+    std::vector<NodeID> find_in_tree(const PropertyValue& key) const;
+    void apply_insert(const PropertyValue& key, NodeID value);
+    void apply_remove(const PropertyValue& key, NodeID value);
+    // Write to whichever tree is in use; the caller holds tree_mutex_
+    void insert_into_tree(const PropertyValue& key, NodeID value);
+    void remove_from_tree(const PropertyValue& key, NodeID value);
+    // Logs the write if a build is running, drops it if the build failed; false if it
+    // should be applied directly
+    bool log_if_building(const PropertyValue& key, NodeID value, bool insert);
+    void wait_until_built() const;
+    void require_ordered(const char* operation) const {
+        if (hash_) throw std::runtime_error(std::string(operation) + ": hash indexes support equality lookups only");
+    }
+
+    // Calls fn(tree) with whichever tree is in use; no-op while empty
+    template <typename Fn>
+    void visit_scan(Fn&& fn) const {
+        std::visit([&fn](const auto& tree) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(tree)>, std::monostate>) fn(*tree);
+        }, tree_);
+    }
+
+    // Appends up to `limit` IDs in total; false once the limit is reached
+    static bool collect(const std::vector<NodeID>& values, size_t limit, std::vector<NodeID>& out) {
+        size_t take = limit ? std::min(values.size(), limit - out.size()) : values.size();
+        out.insert(out.end(), values.begin(), values.begin() + take);
+        return !limit || out.size() < limit;
+    }
+
+    Tree tree_;
+    mutable std::shared_mutex tree_mutex_;
+    // Set for hash and paged indexes, which never use tree_; both synchronize internally
+    const std::unique_ptr<HashIndex> hash_;
+    const std::unique_ptr<PagedBPlusTree> paged_;
+
+    std::atomic<bool> building_;
+    std::atomic<bool> failed_{false};
+    mutable std::mutex build_mutex_;
+    mutable std::condition_variable built_;
+    std::vector<PendingWrite> pending_;
 };
 
-}
\ No newline at end of file
+}
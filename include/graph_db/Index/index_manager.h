@@ -1,21 +1,60 @@
 #pragma once
 
 #include "../types.h"
+#include "composite_index.h"
 #include "index.h"
+#include "index_store.h"
 #include <memory>
 #include <shared_mutex>
+#include <mutex>
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace graph_db {
 
 class IndexManager {
 public:
-    void create_index(const std::string& property_key);
+    // Registers a new index in the building state and returns it, so writes start being
+    // logged before the caller scans existing data; nullptr if the key is already indexed.
+    // A paged index is created in the attached store.
+    Index* create_index(const std::string& property_key, IndexKind kind = IndexKind::BTree);
     Index* get_index(const std::string& property_key);
 
+    // Same for an index over the tuple of `property_keys`, in that column order
+    CompositeIndex* create_composite_index(const std::vector<std::string>& property_keys,
+                                           IndexKind kind = IndexKind::BTree);
+    CompositeIndex* get_composite_index(const std::vector<std::string>& property_keys);
+    // Composite indexes with `property_key` among their columns; all of them if the key
+    // is empty. Composites whose build failed are unregistered but never freed, so the
+    // pointers stay valid.
+    std::vector<CompositeIndex*> composites_with(const std::string& property_key = std::string());
+
+    // Keeps paged indexes in `store`, under names starting with `scope`. The paged indexes
+    // the store already holds for this scope are registered as they are, without a build,
+    // so they must describe the data this manager indexes. True if there were any.
+    bool attach_store(IndexStore* store, const std::string& scope);
+
+    // Abandons the build of the index over `property_keys` (one key for a plain index) and
+    // unregisters it, so it can be created again; a paged one leaves the store too
+    void discard_build(const std::vector<std::string>& property_keys);
+
 private:
+    // Store name of the index over `property_keys`
+    std::string store_name(const std::vector<std::string>& property_keys) const;
+    // Tree for a new index of `kind`; nullptr unless kind is Paged
+    std::unique_ptr<PagedBPlusTree> open_paged(const std::vector<std::string>& property_keys, IndexKind kind);
+
     std::unordered_map<std::string, std::unique_ptr<Index>> indexes_;
+    std::map<std::vector<std::string>, std::unique_ptr<CompositeIndex>> composites_;
+    // Discarded indexes, kept alive for callers still holding pointers to them
+    std::vector<std::unique_ptr<Index>> retired_;
+    std::vector<std::unique_ptr<CompositeIndex>> retired_composites_;
+    // Lets writers skip the composite lookup while there are none
+    std::atomic<bool> has_composites_{false};
+    IndexStore* store_ = nullptr;
+    std::string scope_;
     mutable std::shared_mutex mutex_;
 };
 
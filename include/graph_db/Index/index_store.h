@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../buffer/partitioned_buffer_pool.h"
+#include "../storage/disk_manager.h"
+#include "../types.h"
+#include "paged_b_plus_tree.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace graph_db {
+
+// File of paged indexes. Every tree in it shares one DiskManager and PartitionedBufferPool,
+// and page 0 is a catalog from index names to tree header pages, so the trees can be
+// found again after a restart. Dirty pages reach the file on flush() and on destruction.
+class IndexStore {
+public:
+    // Opens `path`, creating an empty store if the file is new; `pool_pages` frames of
+    // 4 KB are cached, replaced as `replacer` picks
+    IndexStore(const std::string& path, size_t pool_pages,
+               buffer::ReplacerKind replacer = buffer::ReplacerKind::TwoQ);
+
+    // The tree registered as `name`, created and registered first if there is none
+    std::unique_ptr<PagedBPlusTree> open(const std::string& name);
+    std::vector<std::string> names() const;
+    // Unregisters `name`; its pages stay in the file unused
+    void drop(const std::string& name);
+    void flush();
+
+private:
+    void write_catalog();
+
+    storage::DiskManager disk_;
+    buffer::PartitionedBufferPool pool_;
+    std::map<std::string, PageID> catalog_; // copy of page 0
+    mutable std::mutex mutex_;
+};
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../buffer/buffer_pool.h"
+#include "../buffer/page_guard.h"
+#include "../types.h"
+#include "b_plus_tree.h"
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graph_db {
+
+// B+ tree whose nodes are 4 KB pages fetched and pinned through a BufferPool, so
+// it survives restarts and can outgrow memory: only the pages in use are pinned, and
+// the pool keeps whichever are hot (in practice the inner levels) cached.
+//
+// Keys are stored in the order-preserving byte encoding of CompositeIndex::append, so
+// every comparison is a memcmp and keys of different types sort in variant order.
+// Pages are slotted: an array of 2-byte cell offsets, in key order, grows from the page
+// header while the cells fill the page from its end. A key longer than kInlineKey keeps
+// its first kInlineKey bytes in the cell and the rest in a chain of overflow pages; a
+// posting list longer than kInlineIds moves to an overflow chain of its own. Inner pages
+// hold the shortest separator that splits their children.
+//
+// Deletes never merge pages: an emptied leaf stays linked and later inserts into its key
+// range refill it. Overflow pages that are no longer used go on the tree's free list.
+//
+// Safe for concurrent use: lookups share mutex_, writes take it exclusively.
+class PagedBPlusTree {
+public:
+    // Opens the tree whose header is page `header` of the pool's file, or creates an
+    // empty tree if it is kInvalidPageID
+    explicit PagedBPlusTree(buffer::BufferPool& pool, PageID header = kInvalidPageID);
+
+    // Where the tree keeps its root; pass it back to the constructor to reopen the tree
+    PageID header_page() const { return header_; }
+
+    // Appends `value` to the key's posting list
+    void insert(const PropertyValue& key, NodeID value);
+    void remove(const PropertyValue& key, NodeID value);
+    // IDs in insertion order
+    std::vector<NodeID> find(const PropertyValue& key) const;
+    // Same contract as BPlusTree::scan, with `limit` applied to the returned IDs
+    std::vector<NodeID> range(const RangeScan& scan) const;
+    // IDs of the string keys starting with `prefix`, in key order
+    std::vector<NodeID> prefix(const std::string& prefix, size_t limit = 0) const;
+    // Distinct keys
+    size_t size() const;
+
+private:
+    using PageGuard = buffer::PageGuard;
+    // Separator and new right sibling produced by a split
+    struct Split {
+        std::string separator;
+        std::string key_cell; // separator as a cell key, without the child
+        PageID right;
+    };
+
+    static constexpr size_t kInlineKey = 256;
+    static constexpr size_t kInlineIds = 32;
+    // A chained posting list moves back into its cell once it shrinks to this size
+    static constexpr size_t kUnchainAt = 16;
+
+    // Cell key for the encoded `key`, spilling the tail to overflow pages if needed
+    std::string make_key(const std::string& key);
+    std::string read_key(const char* cell) const;
+    // memcmp-style comparison of a cell's key with an encoded key
+    int compare(const char* cell, const std::string& key) const;
+    bool has_prefix(const char* cell, const std::string& prefix) const;
+    // First slot whose key is >= key (lower) or > key (upper)
+    size_t lower_bound(const char* page, const std::string& key) const;
+    size_t upper_bound(const char* page, const std::string& key) const;
+    // Leaf whose range holds `key`; `path` receives the inner pages above it, root first
+    PageGuard find_leaf(const std::string& key, std::vector<PageID>* path) const;
+
+    // Inserts `cell` at slot `pos`, splitting up the tree as far as needed
+    void insert_cell(PageGuard page, size_t pos, std::string cell, std::vector<PageID>& path);
+    // Writes cell `pos` as `cell`, in place when it does not grow
+    void replace_cell(PageGuard page, size_t pos, std::string cell, std::vector<PageID>& path);
+    Split split(PageGuard& page, size_t pos, const std::string& cell);
+
+    void append_id(std::string& cell, NodeID value);
+    // False if `value` is not in the cell's posting list
+    bool remove_id(std::string& cell, NodeID value);
+    // Appends up to `limit` IDs in total; false once the limit is reached
+    bool read_ids(const char* cell, size_t limit, std::vector<NodeID>& out) const;
+    // Walks the leaves from the first key >= from (> from if !inclusive), or backwards from
+    // the last key <= from (< from), while fn(cell) returns true
+    void walk(const std::string& from, bool inclusive, bool descending,
+              const std::function<bool(const char*)>& fn) const;
+
+    // Overflow chain holding `bytes`; returns the first and last page
+    std::pair<PageID, PageID> write_chain(const char* bytes, size_t size);
+    void read_chain(PageID page, std::string& out) const;
+    void free_chain(PageID page);
+
+    // Zeroed page of `type`, from the free list if possible
+    PageGuard allocate(uint8_t type);
+    void free_page(PageID page);
+    // Stores root_, free_list_ and keys_ in the header page if they changed
+    void sync_header();
+
+    buffer::BufferPool& pool_;
+    PageID header_;
+    PageID root_;
+    PageID free_list_;
+    uint64_t keys_ = 0;
+    bool header_dirty_ = false;
+    mutable std::shared_mutex mutex_;
+};
+
+}
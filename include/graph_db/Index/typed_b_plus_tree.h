@@ -0,0 +1,866 @@
+#pragma once
+
+#include "graph_db/types.h"
+#include "b_plus_tree.h"
+#include "epoch_manager.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace graph_db {
+
+// Order-preserving 64-bit codes for index keys, compared as signed integers. Exact codes
+// order exactly like their keys and decode back to them. String codes hold only the
+// first 8 bytes (big-endian), so equal codes fall back to comparing the full strings.
+struct Int64KeyTraits {
+    using Key = int64_t;
+    static constexpr bool kExact = true;
+    static int64_t encode(int64_t key) { return key; }
+    static int64_t decode(int64_t code) { return code; }
+};
+
+struct DoubleKeyTraits {
+    using Key = double;
+    static constexpr bool kExact = true;
+    static int64_t encode(double key) {
+        if (key == 0) key = 0; // -0.0 and 0.0 are one key
+        uint64_t bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        // Negative doubles order in reverse of their bit patterns
+        bits = (bits >> 63) ? ~bits : bits | kSign;
+        return static_cast<int64_t>(bits ^ kSign);
+    }
+    static double decode(int64_t code) {
+        uint64_t bits = static_cast<uint64_t>(code) ^ kSign;
+        bits = (bits >> 63) ? bits & ~kSign : ~bits;
+        double key;
+        std::memcpy(&key, &bits, sizeof(key));
+        return key;
+    }
+    static constexpr uint64_t kSign = uint64_t{1} << 63;
+};
+
+struct BoolKeyTraits {
+    using Key = bool;
+    static constexpr bool kExact = true;
+    static int64_t encode(bool key) { return key; }
+    static bool decode(int64_t code) { return code != 0; }
+};
+
+struct StringKeyTraits {
+    using Key = std::string;
+    static constexpr bool kExact = false;
+    static int64_t encode(const std::string& key) {
+        uint64_t code = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            code = (code << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+        }
+        return static_cast<int64_t>(code ^ (uint64_t{1} << 63));
+    }
+};
+
+namespace detail {
+
+// Codes arrays carry this many readable slots past their capacity for the SIMD window
+constexpr size_t kSearchPad = 8;
+
+static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t) && std::atomic<int64_t>::is_always_lock_free,
+              "codes are searched in place");
+
+// Number of codes in the sorted run [codes, codes + n) that are < key. A branchless
+// binary search narrows the run to at most 8 candidates, which are counted in one pass
+// (two AVX2 compares on builds that have it). Codes are read relaxed: optimistic readers
+// validate the node version afterwards.
+inline size_t count_less(const std::atomic<int64_t>* codes, size_t n, int64_t key) {
+    const std::atomic<int64_t>* base = codes;
+    size_t len = n;
+    while (len > 8) {
+        size_t half = len / 2;
+        base += base[half - 1].load(std::memory_order_relaxed) < key ? half : 0;
+        len -= half;
+    }
+    size_t count = static_cast<size_t>(base - codes);
+#if defined(__AVX2__)
+    __m256i needle = _mm256_set1_epi64x(key);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + 4));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, lo)))) |
+                    static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, hi)))) << 4;
+    count += static_cast<size_t>(__builtin_popcount(mask & ((1u << len) - 1)));
+#else
+    for (size_t i = 0; i < len; ++i) count += base[i].load(std::memory_order_relaxed) < key;
+#endif
+    return count;
+}
+
+// Copies n IDs that a writer may be rewriting meanwhile, as a seqlock reader does: the
+// caller validates the node version afterwards and discards a torn copy. A plain
+// memcpy is what such readers use in practice (the standard's per-byte atomic memcpy,
+// P1478, is not available yet) and is several times faster than per-element loads.
+// ThreadSanitizer builds use the per-element loads, so the detector only reports
+// races that are not validated this way.
+#if defined(__SANITIZE_THREAD__)
+#define GRAPHDB_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define GRAPHDB_TSAN 1
+#endif
+#endif
+inline void copy_racy(NodeID* out, const std::atomic<NodeID>* ids, size_t n) {
+    static_assert(sizeof(std::atomic<NodeID>) == sizeof(NodeID), "IDs are copied as plain words");
+#if defined(GRAPHDB_TSAN)
+    for (size_t i = 0; i < n; ++i) out[i] = ids[i].load(std::memory_order_relaxed);
+#else
+    if (n) std::memcpy(out, static_cast<const void*>(ids), n * sizeof(NodeID));
+#endif
+}
+
+} // namespace detail
+
+// B+ tree for an index whose keys all have one type. Keys are stored as fixed-width
+// codes in contiguous per-node arrays, so a node search is a few compares on one or two
+// cache lines instead of a linear walk over std::variant keys. With 255 separators per
+// inner node a 100M-key tree is 4 levels deep. Leaves are linked for ordered scans and,
+// like the generic tree, are not merged when remove() empties them.
+//
+// Thread-safe through optimistic lock coupling: every node carries a version word whose
+// low bit-pair is a write latch. Readers take no latches; they read a node, then check
+// its version is unchanged and restart from the root if not. Writers descend the same
+// way and latch only the leaf they change, plus its parent when a full node has to be
+// split (splits happen on the way down, so they never cascade). Nodes are never freed
+// while the tree is alive; the strings and ID lists a writer replaces are retired to the
+// EpochManager, so a reader that raced with the writer can still copy them.
+template <typename Traits>
+class TypedBPlusTree {
+public:
+    using Key = typename Traits::Key;
+    static constexpr size_t kLeafCapacity = 64;
+    static constexpr size_t kInnerCapacity = 255;
+
+    TypedBPlusTree() {
+        Leaf* leaf = new Leaf;
+        root_.store(leaf);
+        first_leaf_.store(leaf);
+        last_leaf_.store(leaf);
+    }
+    ~TypedBPlusTree() { destroy(root_.load()); }
+    TypedBPlusTree(const TypedBPlusTree&) = delete;
+    TypedBPlusTree& operator=(const TypedBPlusTree&) = delete;
+
+    void insert(const Key& key, NodeID value) {
+        auto epoch = EpochManager::global().pin();
+        int64_t code = Traits::encode(key);
+        while (!try_insert(code, key, value)) backoff();
+    }
+
+    // Replaces the (empty) tree with one built bottom-up from entries sorted by key, with
+    // every node filled to capacity: a single pass instead of one descent per entry.
+    // Must not run concurrently with other operations.
+    void bulk_load(const std::vector<std::pair<PropertyValue, NodeID>>& sorted) {
+        size_t distinct = 0;
+        for (size_t i = 0; i < sorted.size(); ++i) distinct += i == 0 || sorted[i].first != sorted[i - 1].first;
+        if (distinct == 0) return;
+        destroy(root_.load());
+
+        // Leaves, sized evenly so the last one is not left nearly empty
+        std::vector<Split> level;
+        size_t leaves = (distinct + kLeafCapacity - 1) / kLeafCapacity;
+        level.reserve(leaves);
+        Leaf* prev = nullptr;
+        size_t next = 0;
+        for (size_t l = 0; l < leaves; ++l) {
+            Leaf* leaf = new Leaf;
+            size_t take = distinct / leaves + (l < distinct % leaves);
+            for (size_t slot = 0; slot < take; ++slot) {
+                const Key& key = std::get<Key>(sorted[next].first);
+                size_t end = next;
+                while (end < sorted.size() && sorted[end].first == sorted[next].first) ++end;
+                uint64_t ref = inline_ref(sorted[next].second);
+                if (end - next > 1) {
+                    Posting* posting = Posting::make(std::max<size_t>(end - next, kInitialPosting));
+                    for (size_t i = next; i < end; ++i) {
+                        posting->ids()[i - next].store(sorted[i].second, std::memory_order_relaxed);
+                    }
+                    posting->size.store(static_cast<uint32_t>(end - next), std::memory_order_relaxed);
+                    ref = posting_ref(posting);
+                }
+                leaf->codes[slot].store(Traits::encode(key), std::memory_order_relaxed);
+                set_key(*leaf, slot, new_key(key));
+                leaf->postings[slot].store(ref, std::memory_order_relaxed);
+                next = end;
+            }
+            leaf->count.store(static_cast<uint32_t>(take), std::memory_order_relaxed);
+            leaf->prev.store(prev, std::memory_order_relaxed);
+            if (prev) prev->next.store(leaf, std::memory_order_relaxed);
+            else first_leaf_.store(leaf);
+            prev = leaf;
+            level.push_back({code_at(*leaf, take - 1), new_key(std::get<Key>(sorted[next - 1].first)), leaf});
+        }
+        last_leaf_.store(prev);
+
+        // Inner levels until one node is left
+        while (level.size() > 1) {
+            size_t parents = (level.size() + kInnerCapacity) / (kInnerCapacity + 1);
+            std::vector<Split> parent_level;
+            parent_level.reserve(parents);
+            size_t child = 0;
+            for (size_t p = 0; p < parents; ++p) {
+                Inner* inner = new Inner;
+                size_t take = level.size() / parents + (p < level.size() % parents);
+                for (size_t k = 0; k < take; ++k) {
+                    inner->children[k].store(level[child + k].right, std::memory_order_relaxed);
+                    if (k + 1 == take) break;
+                    inner->codes[k].store(level[child + k].code, std::memory_order_relaxed);
+                    set_key(*inner, k, level[child + k].key);
+                }
+                inner->count.store(static_cast<uint32_t>(take - 1), std::memory_order_relaxed);
+                const Split& last = level[child + take - 1];
+                parent_level.push_back({last.code, last.key, inner});
+                child += take;
+            }
+            level = std::move(parent_level);
+        }
+        delete level.front().key;
+        root_.store(level.front().right);
+    }
+
+    std::vector<NodeID> find(const Key& key) const {
+        auto epoch = EpochManager::global().pin();
+        int64_t code = Traits::encode(key);
+        std::vector<NodeID> ids;
+        for (;; backoff()) {
+            uint64_t version;
+            const Leaf* leaf = find_leaf(code, key, version);
+            if (!leaf) continue;
+            size_t slot = lower_slot(*leaf, code, key);
+            ids.clear();
+            if (equal(*leaf, slot, code, key)) copy_ids(*leaf, slot, ids);
+            if (validate(leaf, version)) return ids;
+        }
+    }
+
+    void remove(const Key& key, NodeID value) {
+        auto epoch = EpochManager::global().pin();
+        int64_t code = Traits::encode(key);
+        while (!try_remove(code, key, value)) backoff();
+    }
+
+    // Same contract as BPlusTree::scan; bounds of another type match nothing. Each leaf
+    // is copied as one validated snapshot, so a scan racing with writers sees every
+    // entry that existed throughout it exactly once.
+    void scan(const RangeScan& range, const BPlusTree::ScanFn& fn) const {
+        std::vector<NodeID> ids, values;
+        walk(range, ids, [&](const Snapshot& snap) { return emit(snap, fn, values); });
+    }
+
+    void scan_prefix(const std::string& prefix, const BPlusTree::ScanFn& fn) const {
+        std::vector<NodeID> ids, values;
+        walk_prefix(prefix, ids, [&](const Snapshot& snap) { return emit(snap, fn, values); });
+    }
+
+    // Appends the IDs of the keys in `range`, in scan order, up to range.limit of them:
+    // scan() without a callback, so each ID is copied once
+    void collect(const RangeScan& range, std::vector<NodeID>& out) const {
+        size_t stop = range.limit ? out.size() + range.limit : SIZE_MAX;
+        walk(range, out, [&out, stop](const Snapshot&) { return truncate(out, stop); });
+    }
+
+    void collect_prefix(const std::string& prefix, size_t limit, std::vector<NodeID>& out) const {
+        size_t stop = limit ? out.size() + limit : SIZE_MAX;
+        walk_prefix(prefix, out, [&out, stop](const Snapshot&) { return truncate(out, stop); });
+    }
+
+private:
+    struct NoKeys {};
+    // Full keys are only kept when the codes are lossy. They are immutable once stored
+    // and referenced by pointer, so optimistic readers never see a string mid-update.
+    // Key and posting pointers are dereferenced before a read validates, so they are
+    // always stored with release and loaded with acquire.
+    template <size_t N>
+    using FullKeys = std::conditional_t<Traits::kExact, NoKeys, std::array<std::atomic<const Key*>, N>>;
+
+    // IDs of a key with more than one, stored right after the header. Appends and
+    // removals rewrite the block in place under the leaf latch (readers copy it before
+    // validating); growing swaps in a bigger block and retires the old one, so a reader
+    // holding a stale pointer still reads valid memory.
+    struct alignas(8) Posting {
+        static Posting* make(size_t capacity) {
+            void* memory = ::operator new(sizeof(Posting) + capacity * sizeof(std::atomic<NodeID>));
+            return new (memory) Posting(static_cast<uint32_t>(capacity));
+        }
+        static void release(void* posting) { ::operator delete(posting); }
+        std::atomic<NodeID>* ids() { return reinterpret_cast<std::atomic<NodeID>*>(this + 1); }
+        const std::atomic<NodeID>* ids() const { return reinterpret_cast<const std::atomic<NodeID>*>(this + 1); }
+
+        const uint32_t capacity;
+        std::atomic<uint32_t> size{0};
+
+    private:
+        explicit Posting(uint32_t capacity) : capacity(capacity) {}
+    };
+    static constexpr size_t kInitialPosting = 4;
+
+    // A leaf slot's IDs: a lone ID is kept inline as (id << 1) | 1, which spares the
+    // common unique-key case an allocation and a cache miss; otherwise a Posting*
+    static bool is_inline(uint64_t ref) { return ref & 1; }
+    static uint64_t inline_ref(NodeID id) { return (static_cast<uint64_t>(id) << 1) | 1; }
+    static uint64_t posting_ref(const Posting* posting) { return reinterpret_cast<uint64_t>(posting); }
+    static Posting* posting_of(uint64_t ref) { return reinterpret_cast<Posting*>(ref); }
+    static void retire_ids(uint64_t ref) {
+        if (!is_inline(ref)) EpochManager::global().retire(posting_of(ref), &Posting::release);
+    }
+
+    // Version word: bit 1 is the write latch; unlocking adds it again, which clears the
+    // latch and bumps the version in one step
+    static constexpr uint64_t kLocked = 2;
+
+    struct Node {
+        explicit Node(bool leaf) : is_leaf(leaf) {}
+        const bool is_leaf;
+        std::atomic<uint64_t> version{0};
+        std::atomic<uint32_t> count{0};
+    };
+    struct Leaf : Node {
+        Leaf() : Node(true) {}
+        ~Leaf() {
+            for (size_t i = 0; i < this->count.load(std::memory_order_relaxed); ++i) {
+                uint64_t ref = postings[i].load(std::memory_order_relaxed);
+                if (!is_inline(ref)) Posting::release(posting_of(ref));
+                if constexpr (!Traits::kExact) delete keys[i].load(std::memory_order_relaxed);
+            }
+        }
+        alignas(64) std::atomic<int64_t> codes[kLeafCapacity + detail::kSearchPad] = {};
+        FullKeys<kLeafCapacity> keys{};
+        std::atomic<uint64_t> postings[kLeafCapacity] = {};
+        std::atomic<Leaf*> prev{nullptr};
+        std::atomic<Leaf*> next{nullptr};
+    };
+    struct Inner : Node {
+        Inner() : Node(false) {}
+        ~Inner() {
+            if constexpr (!Traits::kExact) {
+                for (size_t i = 0; i < this->count.load(std::memory_order_relaxed); ++i) {
+                    delete keys[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        // codes[i] is the largest key of children[i]; keys equal to it route left
+        alignas(64) std::atomic<int64_t> codes[kInnerCapacity + detail::kSearchPad] = {};
+        FullKeys<kInnerCapacity> keys{};
+        std::atomic<Node*> children[kInnerCapacity + 1] = {};
+    };
+    // A node, the largest key below it and that key's owned copy (null for exact codes):
+    // the new right half of a split, or a bulk-loaded subtree
+    struct Split {
+        int64_t code = 0;
+        const Key* key = nullptr;
+        Node* right = nullptr;
+    };
+    // One scanned entry, and the scan bounds
+    struct Entry {
+        int64_t code = 0;
+        Key key{};
+        size_t begin = 0; // the entry's IDs in the snapshot buffer
+        size_t end = 0;
+    };
+    struct Position {
+        int64_t code = 0;
+        Key key{};
+        bool inclusive = true;
+    };
+    struct Snapshot {
+        explicit Snapshot(std::vector<NodeID>& ids) : ids(ids) { entries.reserve(kLeafCapacity); }
+        std::vector<Entry> entries;
+        size_t used = 0; // entries past this are spare buffers
+        bool done = false;
+        std::optional<Entry> max;
+        const Leaf* prev = nullptr;
+        const Leaf* next = nullptr;
+        std::vector<NodeID>& ids; // matching IDs are appended here
+        size_t mark = 0;          // size of `ids` before this leaf
+    };
+
+    static void backoff() { std::this_thread::yield(); }
+
+    static bool read_lock(const Node* node, uint64_t& version) {
+        version = node->version.load(std::memory_order_acquire);
+        return !(version & kLocked);
+    }
+    // True when nothing changed `node` since read_lock returned `version`
+    static bool validate(const Node* node, uint64_t version) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return node->version.load(std::memory_order_relaxed) == version;
+    }
+    static bool upgrade(Node* node, uint64_t version) {
+        if (!node->version.compare_exchange_strong(version, version + kLocked, std::memory_order_acquire)) return false;
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+    static void write_unlock(Node* node) { node->version.fetch_add(kLocked, std::memory_order_release); }
+
+    static const Key* new_key(const Key& key) {
+        if constexpr (Traits::kExact) return nullptr;
+        else return new Key(key);
+    }
+    template <typename N>
+    static void set_key(N& node, size_t slot, const Key* key) {
+        if constexpr (!Traits::kExact) node.keys[slot].store(key, std::memory_order_release);
+    }
+    template <typename N>
+    static int64_t code_at(const N& node, size_t slot) {
+        return node.codes[slot].load(std::memory_order_relaxed);
+    }
+    template <typename N>
+    static const Key& key_at(const N& node, size_t slot) {
+        return *node.keys[slot].load(std::memory_order_acquire);
+    }
+    static void entry_at(const Leaf& leaf, size_t slot, Entry& out) {
+        out.code = code_at(leaf, slot);
+        if constexpr (Traits::kExact) out.key = Traits::decode(out.code);
+        else out.key = key_at(leaf, slot);
+    }
+
+    // Entry order: by code, then by full key when codes are lossy
+    template <typename A, typename B>
+    static bool less(const A& a, const B& b) {
+        if (a.code != b.code) return a.code < b.code;
+        if constexpr (!Traits::kExact) return a.key < b.key;
+        return false;
+    }
+
+    // Number of entries of `node` ordered before (code, key)
+    template <typename N>
+    static size_t lower_slot(const N& node, int64_t code, const Key& key) {
+        size_t count = node.count.load(std::memory_order_acquire);
+        size_t slot = detail::count_less(node.codes, count, code);
+        if constexpr (!Traits::kExact) {
+            while (slot < count && code_at(node, slot) == code && key_at(node, slot) < key) ++slot;
+        }
+        return slot;
+    }
+
+    template <typename N>
+    static bool equal(const N& node, size_t slot, int64_t code, const Key& key) {
+        if (slot >= node.count.load(std::memory_order_acquire) || code_at(node, slot) != code) return false;
+        if constexpr (!Traits::kExact) return key_at(node, slot) == key;
+        return true;
+    }
+
+    // Appends the slot's IDs to `out`
+    static void copy_ids(const Leaf& leaf, size_t slot, std::vector<NodeID>& out) {
+        uint64_t ref = leaf.postings[slot].load(std::memory_order_acquire);
+        if (is_inline(ref)) {
+            out.push_back(ref >> 1);
+            return;
+        }
+        const Posting* posting = posting_of(ref);
+        size_t at = out.size();
+        out.resize(at + posting->size.load(std::memory_order_acquire));
+        detail::copy_racy(out.data() + at, posting->ids(), out.size() - at);
+    }
+
+    // Leaf whose range held (code, key) when `version` was read; null on a conflict
+    Leaf* find_leaf(int64_t code, const Key& key, uint64_t& version) const {
+        Node* node = root_.load(std::memory_order_acquire);
+        if (!read_lock(node, version) || node != root_.load(std::memory_order_acquire)) return nullptr;
+        while (!node->is_leaf) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            Node* child = inner->children[lower_slot(*inner, code, key)].load(std::memory_order_acquire);
+            uint64_t child_version;
+            if (!validate(inner, version) || !read_lock(child, child_version) || !validate(inner, version)) {
+                return nullptr;
+            }
+            node = child;
+            version = child_version;
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    const Leaf* find_leaf(const Position& at) const {
+        uint64_t version;
+        for (;; backoff()) {
+            if (const Leaf* leaf = find_leaf(at.code, at.key, version)) return leaf;
+        }
+    }
+
+    // One optimistic descent; false on any conflict
+    bool try_insert(int64_t code, const Key& key, NodeID value) {
+        Node* node = root_.load(std::memory_order_acquire);
+        uint64_t version;
+        if (!read_lock(node, version) || node != root_.load(std::memory_order_acquire)) return false;
+        Inner* parent = nullptr;
+        uint64_t parent_version = 0;
+        size_t parent_slot = 0;
+        while (!node->is_leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            if (inner->count.load(std::memory_order_relaxed) == kInnerCapacity) {
+                split(inner, version, parent, parent_version, parent_slot);
+                return false;
+            }
+            size_t slot = lower_slot(*inner, code, key);
+            Node* child = inner->children[slot].load(std::memory_order_acquire);
+            uint64_t child_version;
+            if (!validate(inner, version) || !read_lock(child, child_version) || !validate(inner, version)) {
+                return false;
+            }
+            parent = inner;
+            parent_version = version;
+            parent_slot = slot;
+            node = child;
+            version = child_version;
+        }
+
+        Leaf* leaf = static_cast<Leaf*>(node);
+        size_t slot = lower_slot(*leaf, code, key);
+        bool exists = equal(*leaf, slot, code, key);
+        if (!exists && leaf->count.load(std::memory_order_relaxed) == kLeafCapacity) {
+            split(leaf, version, parent, parent_version, parent_slot);
+            return false;
+        }
+        // The latch only succeeds if the leaf is unchanged, so `slot` is still right
+        if (!upgrade(leaf, version)) return false;
+        if (exists) append(*leaf, slot, value);
+        else insert_slot(*leaf, slot, code, key, value);
+        write_unlock(leaf);
+        return true;
+    }
+
+    bool try_remove(int64_t code, const Key& key, NodeID value) {
+        uint64_t version;
+        Leaf* leaf = find_leaf(code, key, version);
+        if (!leaf) return false;
+        size_t slot = lower_slot(*leaf, code, key);
+        if (!equal(*leaf, slot, code, key)) return validate(leaf, version);
+        if (!upgrade(leaf, version)) return false;
+
+        // Compacted in place: a reader copying meanwhile fails validation and retries
+        uint64_t ref = leaf->postings[slot].load(std::memory_order_relaxed);
+        uint32_t kept = 0;
+        if (is_inline(ref)) {
+            kept = (ref >> 1) != value;
+        } else {
+            Posting* posting = posting_of(ref);
+            uint32_t size = posting->size.load(std::memory_order_relaxed);
+            std::atomic<NodeID>* ids = posting->ids();
+            for (uint32_t i = 0; i < size; ++i) {
+                NodeID id = ids[i].load(std::memory_order_relaxed);
+                if (id != value) ids[kept++].store(id, std::memory_order_relaxed);
+            }
+            posting->size.store(kept, std::memory_order_release);
+            if (kept == 1) {
+                leaf->postings[slot].store(inline_ref(ids[0].load(std::memory_order_relaxed)), std::memory_order_release);
+                retire_ids(ref);
+            }
+        }
+        if (kept == 0) erase_slot(*leaf, slot);
+        write_unlock(leaf);
+        return true;
+    }
+
+    // Splits the full `node`, read at `version`, under write latches on it and its parent
+    // (null for the root). The parent was seen with room to spare, and its latch only
+    // succeeds if it is unchanged. A failed latch means another writer got there first.
+    void split(Node* node, uint64_t version, Inner* parent, uint64_t parent_version, size_t parent_slot) {
+        if (parent && !upgrade(parent, parent_version)) return;
+        if (!upgrade(node, version)) {
+            if (parent) write_unlock(parent);
+            return;
+        }
+        if (!parent && node != root_.load(std::memory_order_acquire)) {
+            write_unlock(node);
+            return;
+        }
+        Split half = node->is_leaf ? split_leaf(*static_cast<Leaf*>(node)) : split_inner(*static_cast<Inner*>(node));
+        if (parent) {
+            insert_separator(*parent, parent_slot, half);
+        } else {
+            Inner* root = new Inner;
+            root->codes[0].store(half.code, std::memory_order_relaxed);
+            set_key(*root, 0, half.key);
+            root->children[0].store(node, std::memory_order_relaxed);
+            root->children[1].store(half.right, std::memory_order_relaxed);
+            root->count.store(1, std::memory_order_relaxed);
+            root_.store(root, std::memory_order_release);
+        }
+        write_unlock(node);
+        if (parent) write_unlock(parent);
+    }
+
+    // Moves the upper half of `leaf` into a new right sibling; the left half's largest
+    // key separates them
+    Split split_leaf(Leaf& leaf) {
+        size_t half = kLeafCapacity / 2;
+        Leaf* right = new Leaf;
+        for (size_t i = half; i < kLeafCapacity; ++i) move_entry(leaf, i, *right, i - half);
+        right->count.store(static_cast<uint32_t>(kLeafCapacity - half), std::memory_order_relaxed);
+        Leaf* next = leaf.next.load(std::memory_order_relaxed);
+        right->prev.store(&leaf, std::memory_order_relaxed);
+        right->next.store(next, std::memory_order_relaxed);
+        leaf.next.store(right, std::memory_order_release);
+        if (next) next->prev.store(right, std::memory_order_release);
+        else last_leaf_.store(right, std::memory_order_release);
+        leaf.count.store(static_cast<uint32_t>(half), std::memory_order_release);
+        const Key* key = nullptr;
+        if constexpr (!Traits::kExact) key = new_key(key_at(leaf, half - 1));
+        return {code_at(leaf, half - 1), key, right};
+    }
+
+    // Moves the upper half of `inner` into a new right sibling and hands the middle
+    // separator (with its key) up
+    static Split split_inner(Inner& inner) {
+        size_t half = kInnerCapacity / 2;
+        Inner* right = new Inner;
+        for (size_t i = half + 1; i < kInnerCapacity; ++i) {
+            right->codes[i - half - 1].store(code_at(inner, i), std::memory_order_relaxed);
+            if constexpr (!Traits::kExact) set_key(*right, i - half - 1, inner.keys[i].load(std::memory_order_relaxed));
+        }
+        for (size_t i = half + 1; i <= kInnerCapacity; ++i) {
+            right->children[i - half - 1].store(inner.children[i].load(std::memory_order_relaxed),
+                                                std::memory_order_relaxed);
+        }
+        right->count.store(static_cast<uint32_t>(kInnerCapacity - half - 1), std::memory_order_relaxed);
+        const Key* key = nullptr;
+        if constexpr (!Traits::kExact) key = inner.keys[half].load(std::memory_order_relaxed);
+        inner.count.store(static_cast<uint32_t>(half), std::memory_order_release);
+        return {code_at(inner, half), key, right};
+    }
+
+    // Separator for the split of children[slot], whose new right half goes after it
+    static void insert_separator(Inner& inner, size_t slot, const Split& split) {
+        size_t count = inner.count.load(std::memory_order_relaxed);
+        for (size_t i = count; i > slot; --i) {
+            inner.codes[i].store(code_at(inner, i - 1), std::memory_order_relaxed);
+            if constexpr (!Traits::kExact) set_key(inner, i, inner.keys[i - 1].load(std::memory_order_relaxed));
+            inner.children[i + 1].store(inner.children[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        inner.codes[slot].store(split.code, std::memory_order_relaxed);
+        set_key(inner, slot, split.key);
+        inner.children[slot + 1].store(split.right, std::memory_order_relaxed);
+        inner.count.store(static_cast<uint32_t>(count + 1), std::memory_order_release);
+    }
+
+    static void move_entry(Leaf& from, size_t from_slot, Leaf& to, size_t to_slot) {
+        to.codes[to_slot].store(code_at(from, from_slot), std::memory_order_relaxed);
+        if constexpr (!Traits::kExact) set_key(to, to_slot, from.keys[from_slot].load(std::memory_order_relaxed));
+        to.postings[to_slot].store(from.postings[from_slot].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    static void append(Leaf& leaf, size_t slot, NodeID value) {
+        uint64_t ref = leaf.postings[slot].load(std::memory_order_relaxed);
+        Posting* posting;
+        uint32_t size;
+        if (is_inline(ref)) {
+            posting = Posting::make(kInitialPosting);
+            posting->ids()[0].store(ref >> 1, std::memory_order_relaxed);
+            size = 1;
+        } else {
+            posting = posting_of(ref);
+            size = posting->size.load(std::memory_order_relaxed);
+            if (size == posting->capacity) {
+                Posting* grown = Posting::make(size * 2);
+                for (uint32_t i = 0; i < size; ++i) {
+                    grown->ids()[i].store(posting->ids()[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+                posting = grown;
+            }
+        }
+        posting->ids()[size].store(value, std::memory_order_relaxed);
+        posting->size.store(size + 1, std::memory_order_release);
+        if (posting_ref(posting) != ref) {
+            leaf.postings[slot].store(posting_ref(posting), std::memory_order_release);
+            retire_ids(ref);
+        }
+    }
+
+    static void insert_slot(Leaf& leaf, size_t slot, int64_t code, const Key& key, NodeID value) {
+        size_t count = leaf.count.load(std::memory_order_relaxed);
+        for (size_t i = count; i > slot; --i) move_entry(leaf, i - 1, leaf, i);
+        leaf.codes[slot].store(code, std::memory_order_relaxed);
+        set_key(leaf, slot, new_key(key));
+        leaf.postings[slot].store(inline_ref(value), std::memory_order_release);
+        leaf.count.store(static_cast<uint32_t>(count + 1), std::memory_order_release);
+    }
+
+    static void erase_slot(Leaf& leaf, size_t slot) {
+        uint64_t ref = leaf.postings[slot].load(std::memory_order_relaxed);
+        const Key* key = nullptr;
+        if constexpr (!Traits::kExact) key = leaf.keys[slot].load(std::memory_order_relaxed);
+        size_t count = leaf.count.load(std::memory_order_relaxed);
+        for (size_t i = slot + 1; i < count; ++i) move_entry(leaf, i, leaf, i - 1);
+        leaf.count.store(static_cast<uint32_t>(count - 1), std::memory_order_release);
+        retire_ids(ref);
+        if constexpr (!Traits::kExact) EpochManager::global().retire(const_cast<Key*>(key));
+    }
+
+    static void destroy(Node* node) {
+        if (node->is_leaf) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (size_t i = 0; i <= inner->count.load(std::memory_order_relaxed); ++i) {
+            destroy(inner->children[i].load(std::memory_order_relaxed));
+        }
+        delete inner;
+    }
+
+    // Copies the entries of `leaf` from `from` on that are not `skip`ped, in key order
+    // (reversed when `descending`), up to the first one that is `past` the scan, appending
+    // their IDs to out.ids. Retries until the copy validates. Entry buffers are reused
+    // leaf to leaf.
+    template <typename Skip, typename Past>
+    static void snapshot(const Leaf* leaf, bool descending, const std::optional<Position>& from, Skip skip, Past past,
+                         Snapshot& out) {
+        out.mark = out.ids.size();
+        for (;; backoff()) {
+            uint64_t version;
+            if (!read_lock(leaf, version)) continue;
+            out.ids.resize(out.mark);
+            out.used = 0;
+            out.done = false;
+            out.max.reset();
+            size_t count = leaf->count.load(std::memory_order_acquire);
+            // Entries before `from` (after it, descending) are never copied; the slot of
+            // `from` itself still goes through skip
+            size_t start = from ? std::min<size_t>(lower_slot(*leaf, from->code, from->key), count) : 0;
+            size_t first = descending ? 0 : start;
+            size_t last = descending && from ? std::min(start + 1, count) : count;
+            for (size_t n = first; n < last; ++n) {
+                size_t slot = descending ? last - 1 - (n - first) : n;
+                if (out.used == out.entries.size()) out.entries.emplace_back();
+                Entry& entry = out.entries[out.used];
+                entry_at(*leaf, slot, entry);
+                if (skip(entry)) continue;
+                if (past(entry)) {
+                    out.done = true;
+                    break;
+                }
+                entry.begin = out.ids.size();
+                copy_ids(*leaf, slot, out.ids);
+                entry.end = out.ids.size();
+                ++out.used;
+            }
+            if (count) entry_at(*leaf, count - 1, out.max.emplace());
+            out.prev = leaf->prev.load(std::memory_order_acquire);
+            out.next = leaf->next.load(std::memory_order_acquire);
+            if (validate(leaf, version)) return;
+        }
+    }
+
+    // Passes a leaf snapshot to a scan callback, one key at a time
+    static bool emit(const Snapshot& snap, const BPlusTree::ScanFn& fn, std::vector<NodeID>& values) {
+        for (size_t i = 0; i < snap.used; ++i) {
+            const Entry& entry = snap.entries[i];
+            values.assign(snap.ids.begin() + entry.begin, snap.ids.begin() + entry.end);
+            if (!fn(PropertyValue(entry.key), values)) return false;
+        }
+        snap.ids.clear();
+        return true;
+    }
+
+    static bool truncate(std::vector<NodeID>& out, size_t stop) {
+        if (out.size() < stop) return true;
+        out.resize(stop);
+        return false;
+    }
+
+    // Runs a range walk; sink(snapshot) consumes each leaf's entries and returns false to
+    // stop early
+    template <typename Sink>
+    void walk(const RangeScan& range, std::vector<NodeID>& ids, Sink sink) const {
+        if (range.lower && range.upper && range.lower->value.index() != range.upper->value.index()) {
+            throw std::runtime_error("range scan: bounds must have the same type");
+        }
+        const Key* lower = range.lower ? std::get_if<Key>(&range.lower->value) : nullptr;
+        const Key* upper = range.upper ? std::get_if<Key>(&range.upper->value) : nullptr;
+        if ((range.lower && !lower) || (range.upper && !upper)) return;
+
+        auto epoch = EpochManager::global().pin();
+        std::optional<Position> low, high;
+        if (lower) low = Position{Traits::encode(*lower), *lower, range.lower->inclusive};
+        if (upper) high = Position{Traits::encode(*upper), *upper, range.upper->inclusive};
+        if (range.descending) {
+            walk_down(high, [&low](const Entry& e) { return low && (low->inclusive ? less(e, *low) : !less(*low, e)); },
+                      ids, sink);
+        } else {
+            walk_up(low, [&high](const Entry& e) { return high && (high->inclusive ? less(*high, e) : !less(e, *high)); },
+                    ids, sink);
+        }
+    }
+
+    template <typename Sink>
+    void walk_prefix(const std::string& prefix, std::vector<NodeID>& ids, Sink sink) const {
+        if constexpr (std::is_same_v<Key, std::string>) {
+            auto epoch = EpochManager::global().pin();
+            walk_up(Position{Traits::encode(prefix), prefix, true},
+                    [&prefix](const Entry& e) { return e.key.compare(0, prefix.size(), prefix) != 0; }, ids, sink);
+        }
+    }
+
+    // Ascending walk from `from` (or the first entry) along validated next pointers.
+    // Leaves only split rightwards, so entries a racing split moves were either already
+    // copied with their old leaf or lie ahead; `from` moves past each emitted key.
+    template <typename Past, typename Sink>
+    void walk_up(std::optional<Position> from, Past past, std::vector<NodeID>& ids, Sink& sink) const {
+        const Leaf* leaf = from ? find_leaf(*from) : first_leaf_.load(std::memory_order_acquire);
+        Snapshot snap(ids);
+        auto skip = [&from](const Entry& e) { return from && (from->inclusive ? less(e, *from) : !less(*from, e)); };
+        while (leaf) {
+            snapshot(leaf, false, from, skip, past, snap);
+            if (!sink(snap) || snap.done) return;
+            if (snap.used) from = Position{snap.entries[snap.used - 1].code, snap.entries[snap.used - 1].key, false};
+            leaf = snap.next;
+        }
+    }
+
+    // Descending walk from `from` (or the last entry) along prev pointers. A split can
+    // move entries below `from` to the right of the leaf found for it, so the walk first
+    // steps right until the leaf's largest entry reaches `from`; and a prev pointer is
+    // only followed if that leaf still links back, else the walk re-descends.
+    template <typename Past, typename Sink>
+    void walk_down(std::optional<Position> from, Past past, std::vector<NodeID>& ids, Sink& sink) const {
+        auto start = [this, &from]() { return from ? find_leaf(*from) : last_leaf_.load(std::memory_order_acquire); };
+        const Leaf* leaf = start();
+        const Leaf* came_from = nullptr;
+        bool seeking = true;
+        Snapshot snap(ids);
+        auto skip = [&from](const Entry& e) { return from && (from->inclusive ? less(*from, e) : !less(e, *from)); };
+        while (leaf) {
+            snapshot(leaf, true, from, skip, past, snap);
+            bool step_right = seeking && snap.next && (!from || !snap.max || less(*snap.max, *from));
+            bool relinked = came_from && snap.next != came_from;
+            if (step_right || relinked) {
+                // Not the leaf to take entries from after all
+                ids.resize(snap.mark);
+                leaf = step_right ? snap.next : start();
+                came_from = nullptr;
+                seeking = true;
+                continue;
+            }
+            seeking = false;
+            if (!sink(snap) || snap.done) return;
+            if (snap.used) from = Position{snap.entries[snap.used - 1].code, snap.entries[snap.used - 1].key, false};
+            came_from = leaf;
+            leaf = snap.prev;
+        }
+    }
+
+    std::atomic<Node*> root_;
+    std::atomic<Leaf*> first_leaf_;
+    std::atomic<Leaf*> last_leaf_;
+};
+
+}
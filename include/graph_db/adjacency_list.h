@@ -0,0 +1,112 @@
+#pragma once
+
+#include "types.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace graph_db {
+
+// One incident edge as seen from a node: the edge, the node at its other end and
+// its weight, so neighbor walks never have to look the Edge up.
+struct AdjacencyEntry {
+    EdgeID edge;
+    NodeID neighbor;
+    int64_t weight;
+};
+
+// Incident-edge list tuned for skewed degree distributions:
+//  - up to kInlineCapacity entries are stored inside the object (no allocation);
+//  - larger lists use a contiguous heap array kept sorted by EdgeID. IDs grow
+//    monotonically, so appends are the common case and lookups are binary searches;
+//  - past kHubDegree entries the array stops being sorted and a hash index from
+//    EdgeID to position makes lookups and swap-removals O(1).
+// Iteration is always a linear scan over contiguous entries. Not thread-safe.
+class AdjacencyList {
+public:
+    static constexpr uint32_t kInlineCapacity = 2;
+    static constexpr uint32_t kHubDegree = 512;
+
+    AdjacencyList() = default;
+    ~AdjacencyList();
+    AdjacencyList(const AdjacencyList&) = delete;
+    AdjacencyList& operator=(const AdjacencyList&) = delete;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const AdjacencyEntry* begin() const { return data(); }
+    const AdjacencyEntry* end() const { return data() + size_; }
+
+    void add(const AdjacencyEntry& entry);
+    // Appends a run; faster than repeated add() when the run is sorted by EdgeID
+    void add(const AdjacencyEntry* first, const AdjacencyEntry* last);
+    bool remove(EdgeID edge);
+    bool contains(EdgeID edge) const { return find(edge) != nullptr; }
+    bool set_weight(EdgeID edge, int64_t weight);
+
+private:
+    using HubIndex = std::unordered_map<EdgeID, uint32_t>;
+
+    const AdjacencyEntry* data() const { return heap_ ? heap_ : inline_; }
+    AdjacencyEntry* data() { return heap_ ? heap_ : inline_; }
+    const AdjacencyEntry* find(EdgeID edge) const;
+    void grow(uint32_t min_capacity);
+    void build_hub_index();
+    void drop_hub_index();
+
+    AdjacencyEntry* heap_ = nullptr; // null while the entries fit inline_
+    uint32_t size_ = 0;
+    uint32_t capacity_ = kInlineCapacity;
+    std::unique_ptr<HubIndex> hub_;  // hubs only; entries are unsorted while set
+    AdjacencyEntry inline_[kInlineCapacity];
+};
+
+// Incident edges partitioned by label: one AdjacencyList per label, so the edges of one
+// label are walked without touching the others. Most nodes see a single label, whose
+// list is stored inline; each further label gets a list of its own on the heap.
+// Not thread-safe.
+class LabeledAdjacency {
+public:
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+
+    void add(LabelID label, const AdjacencyEntry& entry) { list_for(label).add(entry); }
+    void add(LabelID label, const AdjacencyEntry* first, const AdjacencyEntry* last) {
+        list_for(label).add(first, last);
+    }
+    bool remove(EdgeID edge);
+    bool set_weight(EdgeID edge, int64_t weight);
+    // The edges with `label`, or nullptr if there are none
+    const AdjacencyList* find(LabelID label) const;
+
+    // fn(entry) for every edge, one label after another
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const AdjacencyEntry& e : first_) fn(e);
+        for (const auto& partition : rest_) {
+            for (const AdjacencyEntry& e : partition->list) fn(e);
+        }
+    }
+    // fn(label, list) for every label that has edges
+    template <typename Fn>
+    void for_each_partition(Fn&& fn) const {
+        if (!first_.empty()) fn(first_label_, first_);
+        for (const auto& partition : rest_) fn(partition->label, partition->list);
+    }
+
+private:
+    struct Partition {
+        explicit Partition(LabelID label) : label(label) {}
+        LabelID label;
+        AdjacencyList list;
+    };
+
+    AdjacencyList& list_for(LabelID label);
+
+    LabelID first_label_ = 0;
+    AdjacencyList first_;
+    std::vector<std::unique_ptr<Partition>> rest_; // empty unless the labels are mixed
+};
+
+} // namespace graph_db
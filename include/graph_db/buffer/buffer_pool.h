@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../types.h"
+
+namespace graph_db {
+namespace buffer {
+
+// Cache of a DiskManager's 4 KB pages. fetch_page and new_page return the page pinned,
+// or nullptr if every frame is pinned; each pin is dropped with one unpin_page. A
+// pinned page stays in its frame, and the caller serializes access to its bytes.
+class BufferPool {
+public:
+    virtual ~BufferPool() = default;
+
+    virtual Page* fetch_page(PageID page_id) = 0;
+    virtual bool unpin_page(PageID page_id, bool is_dirty) = 0;
+    virtual bool flush_page(PageID page_id) = 0;
+    virtual void flush_all_pages() = 0;
+    // Pins a page past the end of the file, reading as zeroes, and stores its ID
+    virtual Page* new_page(PageID* page_id) = 0;
+    virtual bool delete_page(PageID page_id) = 0;
+};
+
+} // namespace buffer
+} // namespace graph_db
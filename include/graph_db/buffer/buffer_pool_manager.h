@@ -1,35 +1,68 @@
 #pragma once
 
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "../storage/disk_manager.h"
-#include "lru_replacer.h"
+#include "buffer_pool.h"
+#include "replacer.h"
 
 namespace graph_db {
 namespace buffer {
 
-class BufferPoolManager {
+// One pool of frames under one latch. The latch covers the page table and frame
+// bookkeeping only: a miss claims a frame, marks it as doing I/O and releases the latch
+// for the victim's write-back and the read, so hits on other pages go on meanwhile.
+// Fetches of a page whose I/O is in flight pin the frame and wait on that frame's own
+// latch, which the loading thread holds until the data is in place.
+class BufferPoolManager : public BufferPool {
 public:
-    BufferPoolManager(size_t pool_size, storage::DiskManager* disk_manager);
-    ~BufferPoolManager();
+    BufferPoolManager(size_t pool_size, storage::DiskManager* disk_manager,
+                      ReplacerKind replacer = ReplacerKind::LRU);
+    ~BufferPoolManager() override;
 
-    Page* fetch_page(PageID page_id);
-    bool unpin_page(PageID page_id, bool is_dirty);
-    bool flush_page(PageID page_id);
-    void flush_all_pages();
-    Page* new_page(PageID* page_id);
-    bool delete_page(PageID page_id);
+    Page* fetch_page(PageID page_id) override;
+    bool unpin_page(PageID page_id, bool is_dirty) override;
+    // Flushes pin the dirty frames and write them with the latch released
+    bool flush_page(PageID page_id) override;
+    void flush_all_pages() override;
+    Page* new_page(PageID* page_id) override;
+    bool delete_page(PageID page_id) override;
+
+    // Fetches served from a frame, and fetches that had to read the page
+    uint64_t hits();
+    uint64_t misses();
 
 private:
-    // size_t pool_size_; // This line is removed
+    struct Frame {
+        std::mutex io;            // held by the thread reading or writing the frame
+        bool loading = false;     // I/O in progress; `io` is held
+        bool failed = false;      // the read failed; the frame is out of the page table
+    };
+
+    // Caller holds latch_; the frame has just lost its last pin
+    void release_frame(FrameID frame_id);
+    // Writes the frames' pages out and marks them clean; `lock` holds latch_ and is
+    // released for the writes. Pages left unwritten by a failed write stay dirty.
+    void write_out(std::unique_lock<std::mutex>& lock, const std::vector<FrameID>& frame_ids);
+
     storage::DiskManager* disk_manager_;
-    LRUReplacer replacer_;
+    std::unique_ptr<Replacer> replacer_;
     std::list<Page*> free_list_;
     std::unordered_map<PageID, FrameID> page_table_;
+    // Pages whose eviction write-back is in flight, and the frame doing it; a fetch of
+    // one waits on written_ for the write before reading it back
+    std::unordered_map<PageID, FrameID> writing_;
+    std::condition_variable written_;
     Page* pages_;
+    std::unique_ptr<Frame[]> frames_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
     std::mutex latch_;
 };
 
 } // namespace buffer
-} // namespace graph_db
\ No newline at end of file
+} // namespace graph_db
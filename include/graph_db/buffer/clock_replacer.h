@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "../types.h"
+#include "replacer.h"
+
+namespace graph_db {
+namespace buffer {
+
+// CLOCK: a hand sweeps the frames, clearing each referenced bit it passes and taking the
+// first evictable frame whose bit is already clear. The bits live in two arrays of
+// 64-bit words, so every call is allocation-free. Each frame's state is one bit changed
+// by a single atomic read-modify-write, and size() counts the evictable bits rather
+// than keeping a separate counter, so concurrent calls leave the bitmaps consistent.
+// A sweep can still pick a frame that a concurrent pin() is about to take, so the pool
+// serializes the calls with its latch as it does for the other replacers.
+class ClockReplacer : public Replacer {
+public:
+    explicit ClockReplacer(size_t num_frames);
+
+    void record_access(FrameID frame_id, PageID page_id) override;
+    bool victim(FrameID* frame_id) override;
+    void pin(FrameID frame_id) override;
+    void unpin(FrameID frame_id) override;
+    size_t size() override;
+
+private:
+    static size_t word(FrameID frame_id) { return static_cast<size_t>(frame_id) / 64; }
+    static uint64_t bit(FrameID frame_id) { return uint64_t{1} << (frame_id % 64); }
+    size_t words() const { return (num_frames_ + 63) / 64; }
+
+    size_t num_frames_;
+    std::unique_ptr<std::atomic<uint64_t>[]> referenced_;
+    std::unique_ptr<std::atomic<uint64_t>[]> evictable_;
+    std::atomic<size_t> hand_{0};
+};
+
+} // namespace buffer
+} // namespace graph_db
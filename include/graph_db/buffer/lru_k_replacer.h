@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "../types.h"
+#include "replacer.h"
+
+namespace graph_db {
+namespace buffer {
+
+// LRU-K: evicts the candidate whose K-th most recent access is oldest, and before any of
+// those a page with fewer than K accesses (oldest first access first). A scan touches
+// each page once, so its pages go before anything the point lookups keep returning to.
+//
+// Time is counted in accesses. Accesses to a page within `correlated_period` of its
+// previous one, such as a scan reading every record on a page, count as one. The
+// histories of up to num_frames evicted pages are kept, so a page that comes back soon
+// is not mistaken for a new one. victim() walks all frames; it only runs on a miss.
+class LRUKReplacer : public Replacer {
+public:
+    static constexpr size_t kMaxK = 8;
+
+    LRUKReplacer(size_t num_frames, size_t k = 2, uint64_t correlated_period = 8);
+
+    void record_access(FrameID frame_id, PageID page_id) override;
+    bool victim(FrameID* frame_id) override;
+    void pin(FrameID frame_id) override;
+    void unpin(FrameID frame_id) override;
+    size_t size() override { return size_; }
+
+private:
+    // Newest access first
+    struct History {
+        std::array<uint64_t, kMaxK> times{};
+        size_t count = 0;
+    };
+    struct Frame {
+        PageID page = kInvalidPageID;
+        History history;
+        bool evictable = false;
+    };
+    struct Retained {
+        History history;
+        uint64_t generation;
+    };
+
+    void retain(PageID page_id, const History& history);
+
+    size_t k_;
+    uint64_t correlated_period_;
+    uint64_t now_ = 0;
+    std::vector<Frame> frames_;
+    size_t size_ = 0;
+    // Evicted pages, oldest first; an entry whose generation no longer matches is stale
+    std::unordered_map<PageID, Retained> retained_;
+    std::deque<std::pair<PageID, uint64_t>> retired_order_;
+    uint64_t generation_ = 0;
+};
+
+} // namespace buffer
+} // namespace graph_db
@@ -4,19 +4,22 @@
 #include <mutex>
 #include <unordered_map>
 #include "../types.h"
+#include "replacer.h"
 
 namespace graph_db {
 namespace buffer {
 
-class LRUReplacer {
+// Orders frames by when they were last unpinned. Thread-safe on its own.
+class LRUReplacer : public Replacer {
 public:
     LRUReplacer(size_t num_pages);
-    ~LRUReplacer() = default;
+    ~LRUReplacer() override = default;
 
-    bool victim(FrameID* frame_id);
-    void pin(FrameID frame_id);
-    void unpin(FrameID frame_id);
-    size_t size();
+    void record_access(FrameID, PageID) override {}
+    bool victim(FrameID* frame_id) override;
+    void pin(FrameID frame_id) override;
+    void unpin(FrameID frame_id) override;
+    size_t size() override;
 
 private:
     std::list<FrameID> lru_list_;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "buffer_pool.h"
+#include <stdexcept>
+#include <utility>
+
+namespace graph_db {
+namespace buffer {
+
+// Pin on one page of a BufferPool, released when the guard goes away. The page
+// is unpinned dirty if write() was called.
+class PageGuard {
+public:
+    PageGuard() = default;
+    PageGuard(BufferPool& pool, PageID id) : PageGuard(pool, id, pool.fetch_page(id)) {}
+    // Adopts a pin the caller already took, e.g. from new_page
+    PageGuard(BufferPool& pool, PageID id, Page* page) : pool_(&pool), id_(id), page_(page) {
+        if (!page_) throw std::runtime_error("buffer pool: every frame is pinned");
+    }
+    PageGuard(PageGuard&& other) noexcept { *this = std::move(other); }
+    PageGuard& operator=(PageGuard&& other) noexcept {
+        release();
+        pool_ = other.pool_;
+        id_ = other.id_;
+        page_ = std::exchange(other.page_, nullptr);
+        dirty_ = std::exchange(other.dirty_, false);
+        return *this;
+    }
+    ~PageGuard() { release(); }
+
+    explicit operator bool() const { return page_ != nullptr; }
+    PageID id() const { return id_; }
+    const char* data() const { return page_->data_; }
+    char* write() {
+        dirty_ = true;
+        return page_->data_;
+    }
+    void release() {
+        if (page_) pool_->unpin_page(id_, dirty_);
+        page_ = nullptr;
+        dirty_ = false;
+    }
+
+private:
+    BufferPool* pool_ = nullptr;
+    PageID id_ = kInvalidPageID;
+    Page* page_ = nullptr;
+    bool dirty_ = false;
+};
+
+} // namespace buffer
+} // namespace graph_db
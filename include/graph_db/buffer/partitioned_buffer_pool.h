@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "../storage/disk_manager.h"
+#include "buffer_pool.h"
+#include "buffer_pool_manager.h"
+
+namespace graph_db {
+namespace buffer {
+
+// Several BufferPoolManagers over one file, each owning a share of the frames and the
+// pages whose ID falls to it modulo the instance count. Fetches of different pages
+// mostly take different latches, so threads stop queueing behind a single one; a page
+// can still only be cached by its own instance.
+class PartitionedBufferPool : public BufferPool {
+public:
+    PartitionedBufferPool(size_t pool_size, storage::DiskManager* disk_manager, size_t instances,
+                          ReplacerKind replacer = ReplacerKind::LRU);
+
+    // One instance per hardware thread, keeping at least 64 frames in each
+    static size_t default_instances(size_t pool_size);
+
+    Page* fetch_page(PageID page_id) override;
+    bool unpin_page(PageID page_id, bool is_dirty) override;
+    bool flush_page(PageID page_id) override;
+    void flush_all_pages() override;
+    Page* new_page(PageID* page_id) override;
+    bool delete_page(PageID page_id) override;
+
+    size_t instances() const { return instances_.size(); }
+    // Totals over the instances
+    uint64_t hits();
+    uint64_t misses();
+
+private:
+    BufferPoolManager& instance(PageID page_id) {
+        return *instances_[static_cast<uint32_t>(page_id) % instances_.size()];
+    }
+
+    storage::DiskManager* disk_manager_;
+    std::vector<std::unique_ptr<BufferPoolManager>> instances_;
+};
+
+} // namespace buffer
+} // namespace graph_db
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include "../types.h"
+
+namespace graph_db {
+namespace buffer {
+
+enum class ReplacerKind {
+    LRU,   // least recently unpinned; a scan flushes the whole pool
+    Clock, // second chance over a bit array, no lock or allocation per call
+    LRUK,  // LRU-2: evicts by the time of the second-to-last access
+    TwoQ   // pages seen once stay in a small FIFO and never push out repeat visitors
+};
+
+// Picks the unpinned frame a buffer pool reuses next. The pool reports every fetch with
+// record_access while the frame is pinned, then pin and unpin as the frame stops and
+// starts being a candidate. Unless a replacer says otherwise, the pool's latch
+// serializes the calls.
+class Replacer {
+public:
+    virtual ~Replacer() = default;
+
+    // `frame_id` now holds `page_id`; a different page than before is a new residency
+    virtual void record_access(FrameID frame_id, PageID page_id) = 0;
+    virtual bool victim(FrameID* frame_id) = 0;
+    virtual void pin(FrameID frame_id) = 0;
+    virtual void unpin(FrameID frame_id) = 0;
+    // Frames victim() can choose from
+    virtual size_t size() = 0;
+};
+
+std::unique_ptr<Replacer> make_replacer(ReplacerKind kind, size_t num_frames);
+
+} // namespace buffer
+} // namespace graph_db
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "../types.h"
+#include "replacer.h"
+
+namespace graph_db {
+namespace buffer {
+
+// 2Q (Johnson and Shasha). A page read in for the first time joins A1in, a FIFO of about
+// a quarter of the frames; repeat accesses while it is there count as one. Evicted from
+// A1in, its ID is remembered in A1out for half a pool's worth of evictions, and a page
+// read back while remembered joins Am, an LRU of pages worth keeping. Victims come from
+// A1in while it is over its share, so a scan cycles through A1in and leaves Am alone.
+//
+// The queues are linked through per-frame indices, so only A1out allocates.
+class TwoQReplacer : public Replacer {
+public:
+    explicit TwoQReplacer(size_t num_frames);
+
+    void record_access(FrameID frame_id, PageID page_id) override;
+    bool victim(FrameID* frame_id) override;
+    void pin(FrameID frame_id) override;
+    void unpin(FrameID frame_id) override;
+    size_t size() override { return size_; }
+
+private:
+    enum class Queue : uint8_t { None, In, Main };
+    // Newest at head
+    struct List {
+        FrameID head = -1;
+        FrameID tail = -1;
+        size_t size = 0;
+    };
+    struct Frame {
+        PageID page = kInvalidPageID;
+        FrameID prev = -1; // towards head
+        FrameID next = -1; // towards tail
+        Queue queue = Queue::None;
+        bool evictable = false;
+    };
+
+    List& list(Queue queue) { return queue == Queue::In ? in_ : main_; }
+    void push_front(Queue queue, FrameID frame_id);
+    void unlink(FrameID frame_id);
+    FrameID oldest_evictable(const List& list) const;
+    void remember(PageID page_id);
+
+    std::vector<Frame> frames_;
+    List in_;
+    List main_;
+    size_t in_limit_;
+    size_t out_limit_;
+    size_t size_ = 0;
+    // A1out, oldest first, with how many times each page is in it
+    std::deque<PageID> out_;
+    std::unordered_map<PageID, size_t> out_count_;
+};
+
+} // namespace buffer
+} // namespace graph_db
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "types.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace graph_db {
+
+class Graph;
+
+// Read-only view over a contiguous run of a CSR array
+template <typename T>
+class Span {
+public:
+    Span(const T* first, const T* last) : first_(first), last_(last) {}
+    const T* begin() const { return first_; }
+    const T* end() const { return last_; }
+    size_t size() const { return static_cast<size_t>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+    const T& operator[](size_t i) const { return first_[i]; }
+
+private:
+    const T* first_;
+    const T* last_;
+};
+
+// Immutable compressed-sparse-row snapshot of a Graph. Vertices are renumbered to
+// dense indices [0, num_vertices()) in ascending NodeID order; each vertex's out and
+// in edges are contiguous runs in parallel target/weight/edge-id arrays, ordered by EdgeID.
+// Obtain one through Graph::snapshot(); it does not observe later mutations.
+class CSRGraph {
+public:
+    using VertexIndex = uint32_t;
+    static constexpr VertexIndex kInvalidVertex = std::numeric_limits<VertexIndex>::max();
+
+    size_t num_vertices() const { return ids_.size(); }
+    size_t num_edges() const { return out_targets_.size(); }
+    // Graph::version() at the time the snapshot was taken
+    uint64_t version() const { return version_; }
+
+    NodeID node_id(VertexIndex v) const { return ids_[v]; }
+    // kInvalidVertex when the node is not part of the snapshot
+    VertexIndex index_of(NodeID id) const {
+        auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+        if (it == ids_.end() || *it != id) return kInvalidVertex;
+        return static_cast<VertexIndex>(it - ids_.begin());
+    }
+    const std::vector<NodeID>& node_ids() const { return ids_; }
+
+    size_t out_degree(VertexIndex v) const { return out_offsets_[v + 1] - out_offsets_[v]; }
+    Span<VertexIndex> out_neighbors(VertexIndex v) const { return row(out_targets_, out_offsets_, v); }
+    Span<int64_t> out_weights(VertexIndex v) const { return row(out_weights_, out_offsets_, v); }
+    Span<EdgeID> out_edges(VertexIndex v) const { return row(out_edges_, out_offsets_, v); }
+
+    size_t in_degree(VertexIndex v) const { return in_offsets_[v + 1] - in_offsets_[v]; }
+    Span<VertexIndex> in_neighbors(VertexIndex v) const { return row(in_sources_, in_offsets_, v); }
+    Span<int64_t> in_weights(VertexIndex v) const { return row(in_weights_, in_offsets_, v); }
+    Span<EdgeID> in_edges(VertexIndex v) const { return row(in_edges_, in_offsets_, v); }
+
+private:
+    friend class Graph;
+
+    template <typename T>
+    static Span<T> row(const std::vector<T>& data, const std::vector<uint64_t>& offsets, VertexIndex v) {
+        return Span<T>(data.data() + offsets[v], data.data() + offsets[v + 1]);
+    }
+
+    uint64_t version_ = 0;
+    std::vector<NodeID> ids_; // sorted, dense index -> NodeID
+
+    std::vector<uint64_t> out_offsets_{0};
+    std::vector<VertexIndex> out_targets_;
+    std::vector<int64_t> out_weights_;
+    std::vector<EdgeID> out_edges_;
+
+    std::vector<uint64_t> in_offsets_{0};
+    std::vector<VertexIndex> in_sources_;
+    std::vector<int64_t> in_weights_;
+    std::vector<EdgeID> in_edges_;
+};
+
+}
@@ -1,8 +1,11 @@
 #pragma once
 #include"types.h"
 #include "Index/index_manager.h"
+#include<optional>
 #include<string>
 #include<shared_mutex>
+#include<mutex>
+#include<atomic>
 namespace graph_db{
     class Edge{
         private:
@@ -12,8 +15,19 @@ namespace graph_db{
             std::string label_;
             int64_t weight_=1;
             PropertyMap properties_;
-            IndexManager* index_manager_ = nullptr;
+            LabelID label_id_ = 0;
+            uint32_t label_slot_ = 0; // position in the owning shard's label index
+            IndexManager* index_manager_ = nullptr; // the graph's edge indexes
+            bool dirty_ = false; // changed since mark_clean()
             mutable std::shared_mutex mutex_;
+            std::atomic<uint32_t> pins_{0};
+            // Only Graph::set_edge_weight may change the weight: it also updates the
+            // endpoints' adjacency weights and invalidates snapshots
+            void set_weight(int64_t w) {
+                weight_ = w;
+                dirty_ = true;
+            }
+            friend class Graph;
         public:
             explicit Edge(EdgeID id,NodeID from,NodeID to,const std::string& label=" ",int64_t weight=1){
                 id_=id;
@@ -26,6 +40,13 @@ namespace graph_db{
             NodeID from_node()  { return from_node_; }
             NodeID to_node()  { return to_node_; }
             std::string label()  { return label_; }
+            LabelID label_id() const { return label_id_; }
+            void set_label_id(LabelID label) { label_id_ = label; }
+            uint32_t label_slot() const { return label_slot_; }
+            void set_label_slot(uint32_t slot) {
+                label_slot_ = slot;
+                dirty_ = true;
+            }
             PropertyMap get_properties()  { 
                 std::shared_lock lock(mutex_);
                 return properties_; 
@@ -34,9 +55,36 @@ namespace graph_db{
             bool has_property(std::string s);
             void remove_property(std::string s);
             PropertyValue get_property(std::string s);
+            // Value of `key`, or nullopt if the edge does not have it
+            std::optional<PropertyValue> find_property(const std::string& key) const {
+                std::shared_lock lock(mutex_);
+                auto it = properties_.find(key);
+                if (it == properties_.end()) return std::nullopt;
+                return it->second;
+            }
             int64_t get_weight() { return weight_; }
+            // Replaces all properties without touching indexes
+            void init_properties(PropertyMap properties) {
+                std::unique_lock lock(mutex_);
+                properties_ = std::move(properties);
+                dirty_ = true;
+            }
+            // Drops this edge's entries from every index it appears in (used on delete)
+            void unindex_properties();
             void set_index_manager(IndexManager* manager) { index_manager_ = manager; }
-            void set_weight(int64_t w) { weight_ = w; }
+            // Whether the edge changed since mark_clean(); see Node::is_dirty
+            bool is_dirty() const {
+                std::shared_lock lock(mutex_);
+                return dirty_;
+            }
+            void mark_clean() {
+                std::unique_lock lock(mutex_);
+                dirty_ = false;
+            }
+            // Held by RecordRefs; a paged shard never sheds a pinned edge
+            void pin() { pins_.fetch_add(1, std::memory_order_relaxed); }
+            void unpin() { pins_.fetch_sub(1, std::memory_order_release); }
+            bool pinned() const { return pins_.load(std::memory_order_acquire) != 0; }
     };
 } 
 
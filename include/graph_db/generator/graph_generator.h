@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace graph_db {
+class Graph;
+}
+
+namespace graph_db {
+namespace generator {
+
+// Knobs shared by every generator. Everything is derived from `seed`, so the same
+// config always produces the same graph.
+struct GeneratorConfig {
+    uint64_t seed = 1;
+    bool allow_self_loops = false;
+
+    // Edge labels, picked with a Zipf(label_skew) distribution (0 = uniform)
+    std::vector<std::string> labels{"rel"};
+    double label_skew = 0.0;
+
+    // Edge weights, uniform in [min_weight, max_weight]
+    int64_t min_weight = 1;
+    int64_t max_weight = 1;
+
+    // Integer node properties "p0".."p<n-1>", values Zipf(property_skew) over [0, cardinality)
+    size_t node_properties = 0;
+    size_t property_cardinality = 1000;
+    double property_skew = 0.0;
+};
+
+struct GeneratedEdge {
+    uint64_t from;  // 0-based vertex index
+    uint64_t to;
+    uint32_t label; // index into GeneratorConfig::labels
+    int64_t weight;
+};
+
+struct EdgeList {
+    size_t num_nodes = 0;
+    std::vector<GeneratedEdge> edges;
+};
+
+// R-MAT / Kronecker graph with 2^scale vertices and edge_factor * 2^scale edges.
+// a, b, c are the quadrant probabilities (d = 1 - a - b - c); a larger `a` means more skew.
+// Vertex indices are shuffled so hubs are not clustered at low IDs.
+EdgeList rmat(uint32_t scale, size_t edge_factor, const GeneratorConfig& config,
+              double a = 0.57, double b = 0.19, double c = 0.19);
+
+// Barabási–Albert preferential attachment: every new vertex links to `edges_per_node`
+// distinct existing vertices chosen proportionally to their degree.
+EdgeList barabasi_albert(size_t nodes, size_t edges_per_node, const GeneratorConfig& config);
+
+// rows x cols lattice with right/down edges (and left/up ones too when bidirectional)
+EdgeList grid(size_t rows, size_t cols, bool bidirectional, const GeneratorConfig& config);
+
+// Erdős–Rényi G(n, m): `edges` endpoints drawn uniformly at random
+EdgeList erdos_renyi(size_t nodes, size_t edges, const GeneratorConfig& config);
+
+// Creates the nodes (with random properties) and edges in `graph`.
+// Returns the NodeID assigned to each vertex index.
+std::vector<NodeID> populate(Graph& graph, const EdgeList& list, const GeneratorConfig& config);
+
+// Writes the graph straight to a Serializer file without building a Graph first.
+// Vertex i gets NodeID i + 1 and edge j gets EdgeID j + 1, matching a fresh Graph.
+// The file format has no weight column, so edge weights are not written.
+bool write_to_file(const std::string& filename, const EdgeList& list, const GeneratorConfig& config);
+
+} // namespace generator
+} // namespace graph_db
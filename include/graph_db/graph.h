@@ -2,66 +2,487 @@
 
 #include "types.h"
 #include "storage/serializer.h"
+#include "storage/paged_graph_store.h"
 #include "node.h"
 #include "edge.h"
+#include "csr_graph.h"
 #include "Index/index_manager.h"
+#include "label_dictionary.h"
+#include "object_pool.h"
+#include "record_table.h"
+#include "record_ref.h"
 #include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <bitset>
+#include <deque>
+#include <atomic>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 #include <shared_mutex>
+#include <mutex>
 #include <cstdint>
+#include <functional>
+#include <utility>
 
 namespace graph_db {
 
+// Input to Graph::bulk_insert. An id of 0 asks the graph to assign one.
+struct NodeRecord {
+    NodeID id = 0;
+    PropertyMap properties;
+};
+
+struct EdgeRecord {
+    EdgeID id = 0;
+    NodeID from = 0;
+    NodeID to = 0;
+    std::string label;
+    int64_t weight = 1;
+    PropertyMap properties;
+};
+
+// IDs of the inserted elements, in input order
+struct BulkInsertResult {
+    std::vector<NodeID> node_ids;
+    std::vector<EdgeID> edge_ids;
+};
+
+// Where a Graph keeps its nodes and edges
+enum class StorageEngine {
+    InMemory, // every node and edge is an object in memory
+    // Records live in a PagedGraphStore file and only a working set is kept as objects,
+    // so the graph can be larger than memory
+    Paged,
+};
+
+struct GraphOptions {
+    StorageEngine storage = StorageEngine::InMemory;
+    // Paged only: the file, reopened if it exists; 4 KB pages cached by its buffer pool,
+    // and the policy replacing them; and how many nodes, and how many edges, stay in
+    // memory as objects
+    std::string path;
+    size_t pool_pages = 1024;
+    buffer::ReplacerKind replacer = buffer::ReplacerKind::TwoQ;
+    size_t cache_records = 1 << 16;
+};
+
+// Nodes and edges are striped by ID across kShardCount independently locked shards,
+// so writers touching different shards do not contend. Operations that need several
+// shards lock node shards in ascending index order before any edge shard.
+//
+// With StorageEngine::Paged each shard caches up to cache_records / kShardCount nodes
+// and edges. A miss reads the record from the store, and records past the budget are
+// written back if they changed and dropped, oldest first, whenever a shard's exclusive
+// lock is released. Reads therefore lock their shard exclusively, and a Node* or Edge*
+// returned by get_node or get_edge stays valid only until its shard next sheds records;
+// get_node_ref and get_edge_ref return RecordRefs, which pin the record instead.
 class Graph {
 public:
+    static constexpr size_t kShardCount = 64;
+
     Graph() = default;
-    ~Graph() = default;
+    explicit Graph(const GraphOptions& options);
+    ~Graph();
 
     // Node management
     NodeID create_node();
     Node *create_node(NodeID id);
+    // Removes the node, its incident edges and their index entries. Locks only the shards
+    // of the node and its neighbors, so the cost depends on the node's degree.
     bool remove_node(NodeID id);
+    // Batch form: every listed node that exists is removed; an edge between two listed
+    // nodes is removed once. Returns the number of nodes removed.
+    size_t remove_nodes(const std::vector<NodeID>& ids);
     Node* get_node(NodeID id);
+    // Same record, pinned against shedding while the reference lives; see RecordRef
+    RecordRef<Node> get_node_ref(NodeID id);
     bool has_node(NodeID id);
     size_t node_count() const { 
-        std::shared_lock lock(mutex_);
-        return Nodes_.size(); 
+        return node_count_.load(std::memory_order_relaxed); 
     }
     size_t edge_count() const { 
-        std::shared_lock lock(mutex_);
-        return Edges_.size(); 
+        return edge_count_.load(std::memory_order_relaxed); 
     }
     EdgeID create_edge(NodeID from, NodeID to, const std::string& label = "");
     bool remove_edge(EdgeID id);
+    // The only way to change a weight; updates adjacency caches and invalidates snapshots
+    bool set_edge_weight(EdgeID id, int64_t weight);
     Edge* get_edge(EdgeID id);
+    RecordRef<Edge> get_edge_ref(EdgeID id);
     bool has_edge(EdgeID id);
+    // Caller holds the lock of the node's shard, exclusively if the graph is paged
     Node* get_node_unlocked(NodeID id);
     std::vector<NodeID> get_neighbors(NodeID id);
-    std::unordered_map<NodeID, std::unique_ptr<Node>>& get_all_nodes() { return Nodes_; }
-    std::unordered_map<EdgeID, std::unique_ptr<Edge>>& get_all_edges() { return Edges_; }
-    void create_index(const std::string& property_key) {
-        index_manager_.create_index(property_key);
+
+    // Zero-copy adjacency walks under the node's shard lock. fn(edge, other_end, weight)
+    // sees the target for out edges and the source for in edges. The callback must not
+    // mutate the graph. Returns false if the node does not exist.
+    template <typename Fn>
+    bool for_each_out_edge(NodeID id, Fn&& fn) {
+        auto lock = read_lock(node_shard(id));
+        Node* node = get_node_unlocked(id);
+        if (!node) return false;
+        visit_edges(*node, true, fn);
+        return true;
+    }
+    template <typename Fn>
+    bool for_each_in_edge(NodeID id, Fn&& fn) {
+        auto lock = read_lock(node_shard(id));
+        Node* node = get_node_unlocked(id);
+        if (!node) return false;
+        visit_edges(*node, false, fn);
+        return true;
     }
+    // Only the edges labeled `label`: a walk over the node's partition for that label
+    template <typename Fn>
+    bool for_each_out_edge(NodeID id, const std::string& label, Fn&& fn) {
+        return visit_labeled_edges(id, label, true, fn);
+    }
+    template <typename Fn>
+    bool for_each_in_edge(NodeID id, const std::string& label, Fn&& fn) {
+        return visit_labeled_edges(id, label, false, fn);
+    }
+    template <typename Fn>
+    bool for_each_out_neighbor(NodeID id, Fn&& fn) {
+        return for_each_out_edge(id, [&fn](EdgeID, NodeID target, int64_t) { fn(target); });
+    }
+    template <typename Fn>
+    bool for_each_in_neighbor(NodeID id, Fn&& fn) {
+        return for_each_in_edge(id, [&fn](EdgeID, NodeID source, int64_t) { fn(source); });
+    }
+    // Visit every node / edge, one shard at a time under that shard's lock. A paged
+    // graph streams the records through its working set in one pass over the store,
+    // handing each batch of IDs to the shards it spans. The callback must not mutate
+    // the graph.
+    template <typename Fn>
+    void for_each_node(Fn&& fn) {
+        auto visit = [&fn](Node* node) { fn(*node); };
+        if (store_) {
+            for_each_stored_batch(storage::RecordKind::Node, [&](size_t s, const std::vector<uint64_t>& ids) {
+                auto lock = read_lock(node_shards_[s]);
+                scan_nodes(s, ids, visit);
+            });
+            return;
+        }
+        for (size_t s = 0; s < kShardCount; ++s) {
+            auto lock = read_lock(node_shards_[s]);
+            scan_nodes(s, {}, visit);
+        }
+    }
+    template <typename Fn>
+    void for_each_edge(Fn&& fn) {
+        auto visit = [&fn](Edge* edge) { fn(*edge); };
+        if (store_) {
+            for_each_stored_batch(storage::RecordKind::Edge, [&](size_t s, const std::vector<uint64_t>& ids) {
+                auto lock = read_lock(edge_shards_[s]);
+                scan_edges(s, ids, visit);
+            });
+            return;
+        }
+        for (size_t s = 0; s < kShardCount; ++s) {
+            auto lock = read_lock(edge_shards_[s]);
+            scan_edges(s, {}, visit);
+        }
+    }
+    // Indexes `property_key` over the nodes that already have it: shards are scanned and
+    // their entries sorted in parallel, then the tree is bulk-loaded bottom-up. Writes that
+    // land during the build are logged by the index and replayed, and lookups wait for it.
+    // A hash index answers find_nodes only; the range and prefix queries throw on it.
+    void create_index(const std::string& property_key, IndexKind kind = IndexKind::BTree);
     std::vector<NodeID> find_nodes(const std::string& property_key, const PropertyValue& value) {
         Index* index = index_manager_.get_index(property_key);
         return index ? index->find(value) : std::vector<NodeID>{};
     }
+    // Ordered queries on an indexed property; empty when the property has no index.
+    // e.g. age BETWEEN 30 AND 40: {RangeBound{int64_t{30}}, RangeBound{int64_t{40}}};
+    // top 100 by score: {std::nullopt, std::nullopt, true, 100}.
+    std::vector<NodeID> find_nodes_in_range(const std::string& property_key, const RangeScan& scan) {
+        Index* index = index_manager_.get_index(property_key);
+        return index ? index->range(scan) : std::vector<NodeID>{};
+    }
+    std::vector<NodeID> find_nodes_with_prefix(const std::string& property_key, const std::string& prefix,
+                                               size_t limit = 0) {
+        Index* index = index_manager_.get_index(property_key);
+        return index ? index->prefix(prefix, limit) : std::vector<NodeID>{};
+    }
+    // Index over the tuple of `property_keys`, compared column by column; built like
+    // create_index. Nodes missing any of the keys are not in it.
+    void create_composite_index(const std::vector<std::string>& property_keys, IndexKind kind = IndexKind::BTree);
+    // Equality on the first values.size() columns plus an optional range on the next one.
+    // tenant = 7 AND created_at > T on (tenant, created_at):
+    // ({"tenant", "created_at"}, {int64_t{7}}, {RangeBound{T, false}, std::nullopt}).
+    // Empty when there is no composite index over exactly these keys.
+    std::vector<NodeID> find_nodes_composite(const std::vector<std::string>& property_keys,
+                                             const std::vector<PropertyValue>& values, const RangeScan& next = {}) {
+        CompositeIndex* index = index_manager_.get_composite_index(property_keys);
+        return index ? index->find(values, next) : std::vector<NodeID>{};
+    }
     Edge * create_edge(NodeID from, NodeID to, const std::string& label, EdgeID id);
 
+    // Edge indexes live in their own namespace and post EdgeIDs, so "since" on edges and
+    // "since" on nodes are unrelated indexes. Built like create_index.
+    void create_edge_index(const std::string& property_key, IndexKind kind = IndexKind::BTree);
+    std::vector<EdgeID> find_edges(const std::string& property_key, const PropertyValue& value) {
+        Index* index = edge_index_manager_.get_index(property_key);
+        return index ? index->find(value) : std::vector<EdgeID>{};
+    }
+    std::vector<EdgeID> find_edges_in_range(const std::string& property_key, const RangeScan& scan) {
+        Index* index = edge_index_manager_.get_index(property_key);
+        return index ? index->range(scan) : std::vector<EdgeID>{};
+    }
+    // Every edge labeled `label`, from the built-in label index; in no particular order
+    std::vector<EdgeID> find_edges_by_label(const std::string& label);
+
+    // Opens (or creates) the file that IndexKind::Paged indexes live in, caching
+    // `pool_pages` 4 KB pages of it. The paged indexes already in the file are attached as
+    // they are, without a rebuild, so the graph must hold the data they were built from:
+    // after a restart, load_from_file first, then open the index file. load_from_file
+    // throws once indexes were attached, since it would post every loaded record again.
+    void open_index_file(const std::string& path, size_t pool_pages = 1024,
+                         buffer::ReplacerKind replacer = buffer::ReplacerKind::TwoQ);
+    // Writes the index file's dirty pages back; also done when the graph is destroyed
+    void flush_indexes();
+    // Paged graphs: writes every changed record and dirty page back to the file. Also
+    // done when the graph is destroyed, where errors cannot be reported.
+    void flush();
+
+    // Inserts a batch under a single acquisition of every shard lock. The whole batch is
+    // validated first (explicit IDs must be new, edge endpoints must exist in the graph or
+    // the batch) and nothing is inserted if any record is rejected. Edges may refer to
+    // nodes of the same batch only through explicit node IDs.
+    BulkInsertResult bulk_insert(std::vector<NodeRecord> nodes, std::vector<EdgeRecord> edges);
+
     bool save_to_file(const std::string& filename); 
 
+    // Throws if open_index_file attached stored indexes; see there
     bool load_from_file(const std::string& filename); 
+
+    // Immutable CSR view of the current topology for analytics. The last snapshot is
+    // cached; rebuilding it re-reads only nodes whose adjacency changed since then.
+    std::shared_ptr<const CSRGraph> snapshot();
+    // Bumped by every topology or weight change
+    uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
     private:
+    // A paged shard keeps at least this many records whatever cache_records says
+    static constexpr size_t kMinShardCache = 4;
+
+    struct alignas(64) NodeShard {
+        mutable std::shared_mutex mutex;
+        // Nodes live in `pool`; the table holds the owning pointers
+        RecordTable<Node, kShardCount> nodes;
+        ObjectPool<Node> pool;
+        // Paged graphs: IDs of the cached nodes, oldest first; may hold removed ones
+        std::deque<NodeID> resident;
+        // Removed nodes still pinned by a RecordRef; freed by trim once unpinned
+        std::vector<Node*> retired;
+        // Nodes in the shard, cached or not
+        size_t node_count = 0;
+        // Snapshot bookkeeping for this shard's nodes, written under the unique lock
+        std::unordered_set<NodeID> dirty;
+        bool all_dirty = false;
+        bool node_set_changed = false;
+    };
+    struct alignas(64) EdgeShard {
+        mutable std::shared_mutex mutex;
+        RecordTable<Edge, kShardCount> edges;
+        ObjectPool<Edge> pool;
+        std::deque<EdgeID> resident;
+        std::vector<Edge*> retired;
+        // Label index: this shard's edges per label. Edge::label_slot() is the edge's
+        // position in its list, so removal swaps the last entry into its place.
+        std::unordered_map<LabelID, std::vector<EdgeID>> by_label;
+    };
+
+    // Lock on one shard, shared or exclusive. Releasing an exclusive lock first trims
+    // the shard back to its budget, so records paged in under the lock stay put until
+    // the lock goes away.
+    template <typename Shard>
+    class ShardLock {
+    public:
+        ShardLock() = default;
+        ShardLock(Graph& graph, Shard& shard, bool exclusive) : graph_(&graph), shard_(&shard), exclusive_(exclusive) {
+            if (exclusive_) shard.mutex.lock();
+            else shard.mutex.lock_shared();
+        }
+        ShardLock(ShardLock&& other) noexcept { *this = std::move(other); }
+        ShardLock& operator=(ShardLock&& other) noexcept {
+            unlock();
+            graph_ = other.graph_;
+            shard_ = std::exchange(other.shard_, nullptr);
+            exclusive_ = other.exclusive_;
+            return *this;
+        }
+        ~ShardLock() { unlock(); }
+
+        void unlock() {
+            if (!shard_) return;
+            if (exclusive_) {
+                graph_->trim(*shard_);
+                shard_->mutex.unlock();
+            } else {
+                shard_->mutex.unlock_shared();
+            }
+            shard_ = nullptr;
+        }
+
+    private:
+        Graph* graph_ = nullptr;
+        Shard* shard_ = nullptr;
+        bool exclusive_ = false;
+    };
+    using NodeLock = ShardLock<NodeShard>;
+    using EdgeLock = ShardLock<EdgeShard>;
+
+    // Reads page records in on a paged graph, so only an in-memory graph shares the lock
+    template <typename Shard>
+    ShardLock<Shard> read_lock(Shard& shard) { return ShardLock<Shard>(*this, shard, store_ != nullptr); }
+    template <typename Shard>
+    ShardLock<Shard> write_lock(Shard& shard) { return ShardLock<Shard>(*this, shard, true); }
+
+    static size_t shard_index(uint64_t id) { return id % kShardCount; }
+    NodeShard& node_shard(NodeID id) { return node_shards_[shard_index(id)]; }
+    EdgeShard& edge_shard(EdgeID id) { return edge_shards_[shard_index(id)]; }
+
+    // Unique locks on the shards of both endpoints in lock order; the second lock is
+    // empty when both live in the same shard
+    std::pair<NodeLock, NodeLock> lock_endpoints(NodeID a, NodeID b);
+    // Unique locks on every node shard, then every edge shard
+    std::pair<std::vector<NodeLock>, std::vector<EdgeLock>> lock_all_shards();
+    using ShardSet = std::bitset<kShardCount>;
+    // Unique locks on the shards of `ids` and of all their current neighbors
+    std::vector<NodeLock> lock_neighborhood(const std::vector<NodeID>& ids);
+    // Caller holds the node's shard lock
+    static void add_neighbor_shards(const Node& node, ShardSet& shards);
+    // Caller holds lock_neighborhood(ids)
+    size_t remove_nodes_locked(const std::vector<NodeID>& ids);
+    // Endpoints of an existing edge, or false if it does not exist
+    bool edge_endpoints(EdgeID id, NodeID& from, NodeID& to);
+    Node* insert_node(NodeShard& shard, NodeID id);
+    // The record, paged in if the graph is paged and it is not cached; caller holds the
+    // shard's lock, exclusively if paged
+    Node* find_node(NodeShard& shard, NodeID id);
+    Edge* find_edge(EdgeShard& shard, EdgeID id);
+    // find_*, then drops the record from the shard and the store; the caller frees it
+    Node* unlink_node(NodeShard& shard, NodeID id);
+    Edge* unlink_edge(EdgeShard& shard, EdgeID id);
+    // Caller holds the unique lock of the edge's shard
+    Edge* insert_edge(EdgeShard& shard, EdgeID id, NodeID from, NodeID to, const std::string& label,
+                      LabelID label_id, int64_t weight);
+    // Drops an edge already erased from shard.edges from the label and property indexes
+    // and frees it; caller holds the unique lock of the edge's shard
+    void destroy_edge(EdgeShard& shard, Edge* edge);
+
+    using IndexEntry = std::pair<PropertyValue, uint64_t>;
+    // Fills the building `index` over `property_keys` from scan(shard, out); if that
+    // throws, the index is discarded from `manager` before the exception propagates
+    void backfill(IndexManager& manager, const std::vector<std::string>& property_keys, Index* index,
+                  const std::function<void(size_t, std::vector<IndexEntry>&)>& scan);
+
+    // Caller holds the unique lock of the node's shard
+    void mark_dirty(NodeID id);
+
+    // Paged storage (graph_paging.cpp). Callers hold the shard's exclusive lock.
+    Node* page_in(NodeShard& shard, NodeID id);
+    Edge* page_in(EdgeShard& shard, EdgeID id);
+    // Writes the record to the store if it changed since it was last written
+    void write_back(Node& node);
+    void write_back(Edge& edge);
+    void store_record(Node& node);
+    void store_record(Edge& edge);
+    // Drops the oldest cached records until the shard is within its budget; a record
+    // that cannot be written back stays cached. Also frees retired records no longer pinned.
+    void trim(NodeShard& shard) noexcept;
+    void trim(EdgeShard& shard) noexcept;
+    // Frees a record removed from the shard, or retires it while a RecordRef pins it
+    void release(NodeShard& shard, Node* node) noexcept;
+    void release(EdgeShard& shard, Edge* edge) noexcept;
+    // fn(id) for every stored record of `kind`, in ID order
+    void for_each_stored(storage::RecordKind kind, const std::function<void(uint64_t)>& fn);
+    // Same pass, batched: fn(s, ids) for each shard s that a batch of IDs falls into
+    void for_each_stored_batch(storage::RecordKind kind,
+                               const std::function<void(size_t, const std::vector<uint64_t>&)>& fn);
+    // Stored IDs of `kind` bucketed by shard, from one pass; empty if the graph is in memory
+    std::array<std::vector<uint64_t>, kShardCount> stored_by_shard(storage::RecordKind kind);
+    // Counts, next IDs and the label index of a reopened store
+    void load_stored();
+    std::string encode(Node& node);
+    std::string encode(Edge& edge);
+    void decode(const std::string& record, Node& node);
+    static EdgeRecord decode_edge(const std::string& record, uint32_t& label_slot);
+
+    // fn(node) / fn(edge) for every record of shard s; caller holds its lock. A paged
+    // graph visits `stored`, the shard's stored IDs, and an in-memory one its table.
+    template <typename Fn>
+    void scan_nodes(size_t s, const std::vector<uint64_t>& stored, Fn&& fn) {
+        NodeShard& shard = node_shards_[s];
+        if (!store_) return shard.nodes.for_each(fn);
+        for (uint64_t id : stored) {
+            if (Node* node = find_node(shard, id)) fn(node);
+            trim(shard);
+        }
+    }
+    template <typename Fn>
+    void scan_edges(size_t s, const std::vector<uint64_t>& stored, Fn&& fn) {
+        EdgeShard& shard = edge_shards_[s];
+        if (!store_) return shard.edges.for_each(fn);
+        for (uint64_t id : stored) {
+            if (Edge* edge = find_edge(shard, id)) fn(edge);
+            trim(shard);
+        }
+    }
+
+    // Paged graphs store only IDs below kDenseIdLimit; throws for others, before anything
+    // changes. `what` names the caller in the message.
+    void require_storable(uint64_t id, const char* what) const {
+        if (store_ && id >= kDenseIdLimit) {
+            throw std::runtime_error(std::string(what) + ": ID " + std::to_string(id) + " is past the paged store's limit");
+        }
+    }
+
+    // Caller holds the node's shard lock. Adjacency entries carry the neighbor and weight,
+    // so the walk never touches the edge shards.
+    template <typename Fn>
+    static void visit_edges(const Node& node, bool outgoing, Fn& fn) {
+        if (outgoing) node.for_each_out_edge(fn);
+        else node.for_each_in_edge(fn);
+    }
+    template <typename Fn>
+    bool visit_labeled_edges(NodeID id, const std::string& label, bool outgoing, Fn& fn) {
+        std::optional<LabelID> label_id = labels_.find(label);
+        auto lock = read_lock(node_shard(id));
+        Node* node = get_node_unlocked(id);
+        if (!node) return false;
+        if (!label_id) return true;
+        if (outgoing) node->for_each_out_edge(*label_id, fn);
+        else node->for_each_in_edge(*label_id, fn);
+        return true;
+    }
     
-    std::unordered_map<NodeID, std::unique_ptr<Node>> Nodes_;
-    std::unordered_map<EdgeID, std::unique_ptr<Edge>> Edges_;
-    NodeID next_node_id_ = 1;
-    EdgeID next_edge_id_ = 1;
+    // Paged graphs only; declared before the shards, whose records it outlives
+    std::unique_ptr<storage::PagedGraphStore> store_;
+    size_t shard_cache_ = 0; // records per shard
+    std::array<NodeShard, kShardCount> node_shards_;
+    std::array<EdgeShard, kShardCount> edge_shards_;
+    std::atomic<NodeID> next_node_id_{1};
+    std::atomic<EdgeID> next_edge_id_{1};
+    std::atomic<size_t> node_count_{0};
+    std::atomic<size_t> edge_count_{0};
+    // Declared before the index managers so it outlives the trees they hold
+    std::unique_ptr<IndexStore> index_store_;
+    bool attached_stored_indexes_ = false; // open_index_file found indexes in the file
     IndexManager index_manager_;
+    IndexManager edge_index_manager_;
+    LabelDictionary labels_;
 
-
-    mutable std::shared_mutex mutex_;
+    // Bumped while holding the shard locks of the change, so it is stable under all of them
+    std::atomic<uint64_t> version_{0};
+    std::shared_ptr<const CSRGraph> snapshot_;
+    std::mutex snapshot_mutex_;
 };
 
 } 
\ No newline at end of file
@@ -1,21 +1,69 @@
 #pragma once
 #include "graph.h"
+#include "csr_graph.h"
+#include "parallel/thread_pool.h"
 #include <vector>
 #include <queue>
 #include <stack>
+#include <functional>
 #include <limits>
 #include <unordered_map>
 namespace graph_db {
 
+    struct PathResult {
+        bool found = false;
+        int64_t distance = std::numeric_limits<int64_t>::max();
+        std::vector<NodeID> nodes; // source ... target
+        std::vector<EdgeID> edges; // edges[i] goes from nodes[i] to nodes[i + 1]
+        size_t settled = 0;        // vertices taken off a queue, i.e. the work done
+    };
+
+    struct PathOptions {
+        // Search from both ends (out-edges forward, in-edges backward) and stop once
+        // the two frontiers can no longer improve on the best meeting point
+        bool bidirectional = true;
+        // A* lower bound on the distance from a node to the target. It must never
+        // overestimate; when set the search runs forward only.
+        std::function<int64_t(NodeID)> heuristic;
+    };
+
+    // The Graph& overloads take (or reuse) g.snapshot() and run on the CSR view.
+    // A start node that does not exist yields an empty result.
+
     // BFS from a source node
     std::vector<NodeID> bfs(Graph& g, NodeID start);
+    std::vector<NodeID> bfs(const CSRGraph& g, NodeID start);
 
     std::vector<NodeID> bfs_level(Graph& g,NodeID start , int level);
+    std::vector<NodeID> bfs_level(const CSRGraph& g, NodeID start, int level);
+
+    // Level-synchronous, direction-optimizing BFS: switches between top-down expansion of
+    // the frontier and bottom-up probing of unvisited vertices' in-edges depending on how
+    // many edges the frontier would touch. Returns nodes level by level; the order within
+    // a level is unspecified. The Graph& overload runs on ThreadPool::global().
+    std::vector<NodeID> parallel_bfs(Graph& g, NodeID start);
+    std::vector<NodeID> parallel_bfs(const CSRGraph& g, NodeID start, parallel::ThreadPool& pool);
 
     // DFS from a source node
     std::vector<NodeID> dfs(Graph& g, NodeID start);
+    std::vector<NodeID> dfs(const CSRGraph& g, NodeID start);
+
+    // Parallel delta-stepping SSSP over non-negative weights; a negative weight throws.
+    // Vertices are bucketed by distance / delta. Within a bucket, light edges (weight <=
+    // delta) are relaxed in rounds until it stops refilling, then the heavy edges of its
+    // vertices once, in parallel with an atomic min on a dense distance array. Buckets
+    // live in a bounded cyclic window. Smaller deltas do less redundant work, larger ones
+    // expose more parallelism; delta <= 0 picks the mean edge weight.
+    // The CSR overload returns distances by dense vertex index (max() if unreachable).
+    std::vector<int64_t> delta_stepping(const CSRGraph& g, NodeID start, int64_t delta, parallel::ThreadPool& pool);
+    std::unordered_map<NodeID, int64_t> delta_stepping(Graph& g, NodeID start, int64_t delta = 0);
+
+    // Point-to-point shortest path over non-negative edge weights. Walks the live graph
+    // adjacency rather than a snapshot, so the cost is bounded by the explored region.
+    PathResult shortest_path(Graph& g, NodeID source, NodeID target, const PathOptions& options = {});
 
-    // Dijkstra shortest path
+    // Dijkstra shortest path; unreachable nodes map to numeric_limits<int64_t>::max()
     std::unordered_map<NodeID, int64_t> dijkstra(Graph& g, NodeID start);
+    std::unordered_map<NodeID, int64_t> dijkstra(const CSRGraph& g, NodeID start);
 
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "types.h"
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace graph_db {
+
+// Interns edge labels as dense LabelIDs, so adjacency partitions and the label index key
+// on four bytes rather than a string. The empty label is 0; IDs are never reused.
+class LabelDictionary {
+public:
+    LabelDictionary() {
+        ids_.emplace(std::string(), 0);
+        names_.emplace_back();
+    }
+
+    LabelID intern(const std::string& label) {
+        if (auto id = find(label)) return *id;
+        std::unique_lock lock(mutex_);
+        auto [it, added] = ids_.emplace(label, static_cast<LabelID>(ids_.size()));
+        if (added) names_.push_back(label);
+        return it->second;
+    }
+
+    // nullopt if no edge ever had `label`
+    std::optional<LabelID> find(const std::string& label) const {
+        std::shared_lock lock(mutex_);
+        auto it = ids_.find(label);
+        if (it == ids_.end()) return std::nullopt;
+        return it->second;
+    }
+
+    // The label interned as `id`
+    std::string name(LabelID id) const {
+        std::shared_lock lock(mutex_);
+        return names_.at(id);
+    }
+
+private:
+    std::unordered_map<std::string, LabelID> ids_;
+    std::vector<std::string> names_; // by LabelID
+    mutable std::shared_mutex mutex_;
+};
+
+}
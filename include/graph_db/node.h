@@ -1,36 +1,116 @@
 #pragma once 
 #include"types.h"
 #include"Index/index_manager.h"
+#include"adjacency_list.h"
 #include<vector>
 #include<memory>
+#include<optional>
 #include<unordered_set>
 #include<shared_mutex>
+#include<mutex>
+#include<atomic>
 namespace graph_db{
     class Node{
         private:
             NodeID id_;
-            std::unordered_set<EdgeID>Incoming_Edges_;
-            std::unordered_set<EdgeID>Outgoing_Edges_;
+            LabeledAdjacency Incoming_Edges_;
+            LabeledAdjacency Outgoing_Edges_;
             PropertyMap properties_;
             IndexManager* index_manager_ = nullptr;
+            bool dirty_ = false; // changed since mark_clean()
             mutable std::shared_mutex mutex_;
+            std::atomic<uint32_t> pins_{0};
         public:
             explicit Node(NodeID id) : id_(id) {}
             NodeID get_id()const {    return id_; }
              std::unordered_set<EdgeID> get_out_edges();
              std::unordered_set<EdgeID>get_in_edges();
+            // Visit adjacency in place under the node's shared lock. fn(edge, other_end, weight)
+            // must not modify this node.
+            template <typename Fn>
+            void for_each_out_edge(Fn&& fn) const {
+                std::shared_lock lock(mutex_);
+                Outgoing_Edges_.for_each([&fn](const AdjacencyEntry& e) { fn(e.edge, e.neighbor, e.weight); });
+            }
+            template <typename Fn>
+            void for_each_in_edge(Fn&& fn) const {
+                std::shared_lock lock(mutex_);
+                Incoming_Edges_.for_each([&fn](const AdjacencyEntry& e) { fn(e.edge, e.neighbor, e.weight); });
+            }
+            // Same, restricted to the edges of one label: a walk over that label's partition
+            template <typename Fn>
+            void for_each_out_edge(LabelID label, Fn&& fn) const {
+                std::shared_lock lock(mutex_);
+                if (const AdjacencyList* edges = Outgoing_Edges_.find(label)) {
+                    for (const AdjacencyEntry& e : *edges) fn(e.edge, e.neighbor, e.weight);
+                }
+            }
+            template <typename Fn>
+            void for_each_in_edge(LabelID label, Fn&& fn) const {
+                std::shared_lock lock(mutex_);
+                if (const AdjacencyList* edges = Incoming_Edges_.find(label)) {
+                    for (const AdjacencyEntry& e : *edges) fn(e.edge, e.neighbor, e.weight);
+                }
+            }
+            // fn(label, list) for each label's partition of the adjacency
+            template <typename Fn>
+            void for_each_out_partition(Fn&& fn) const {
+                std::shared_lock lock(mutex_);
+                Outgoing_Edges_.for_each_partition(fn);
+            }
+            template <typename Fn>
+            void for_each_in_partition(Fn&& fn) const {
+                std::shared_lock lock(mutex_);
+                Incoming_Edges_.for_each_partition(fn);
+            }
+            size_t out_degree() const {
+                std::shared_lock lock(mutex_);
+                return Outgoing_Edges_.size();
+            }
+            size_t in_degree() const {
+                std::shared_lock lock(mutex_);
+                return Incoming_Edges_.size();
+            }
             PropertyMap get_properties()  { 
                 std::shared_lock lock(mutex_);
                 return properties_; 
             }
-            void add_outgoing_edge(EdgeID edge_id);
-            void add_incoming_edge(EdgeID edge_id);
+            void add_outgoing_edge(EdgeID edge_id, NodeID target, int64_t weight = 1, LabelID label = 0);
+            void add_incoming_edge(EdgeID edge_id, NodeID source, int64_t weight = 1, LabelID label = 0);
+            // Batched forms for a run of one label: one lock acquisition and one growth step
+            void add_outgoing_edges(LabelID label, const AdjacencyEntry* first, const AdjacencyEntry* last);
+            void add_incoming_edges(LabelID label, const AdjacencyEntry* first, const AdjacencyEntry* last);
             void remove_outgoing_edge(EdgeID edge_id);
             void remove_incoming_edge(EdgeID edge_id);
+            // Keeps the weight cached in the adjacency entry in sync with the Edge
+            void set_outgoing_weight(EdgeID edge_id, int64_t weight);
+            void set_incoming_weight(EdgeID edge_id, int64_t weight);
             void set_property(std::string key,PropertyValue p);
             bool has_property(std::string s);
             void remove_property(std::string s);
             PropertyValue get_property(std::string s);
+            // Value of `key`, or nullopt if the node does not have it
+            std::optional<PropertyValue> find_property(const std::string& key) const;
+            // This node's encoded tuple for `index`, read under one lock
+            std::optional<std::string> composite_key(const CompositeIndex& index) const;
+            // Replaces all properties without touching indexes; the caller indexes them
+            void init_properties(PropertyMap properties);
+            // Drops this node's entries from every index it appears in (used on delete)
+            void unindex_properties();
             void set_index_manager(IndexManager* manager) { index_manager_ = manager; }
+            // Whether the properties or adjacency changed since mark_clean(); the paged
+            // storage engine writes the node back when they did
+            bool is_dirty() const {
+                std::shared_lock lock(mutex_);
+                return dirty_;
+            }
+            void mark_clean() {
+                std::unique_lock lock(mutex_);
+                dirty_ = false;
+            }
+            // Held by RecordRefs; a paged shard never sheds a pinned node
+            void pin() { pins_.fetch_add(1, std::memory_order_relaxed); }
+            void unpin() { pins_.fetch_sub(1, std::memory_order_release); }
+            bool pinned() const { return pins_.load(std::memory_order_acquire) != 0; }
     };
  }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace graph_db {
+
+// Slab allocator for objects of one type. Objects are constructed in place inside
+// fixed-size slabs that are never moved or released while the pool lives, so their
+// addresses are stable; destroyed slots go on a free list and are reused first.
+// Not thread-safe: callers serialize access (Graph keeps one pool per shard, used
+// under that shard's unique lock). Live objects are not destroyed by ~ObjectPool.
+template <typename T, size_t SlabSize = 512>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot = acquire();
+        try {
+            T* object = new (slot->storage) T(std::forward<Args>(args)...);
+            ++live_;
+            return object;
+        } catch (...) {
+            release(slot);
+            throw;
+        }
+    }
+
+    void destroy(T* object) {
+        if (!object) return;
+        object->~T();
+        release(reinterpret_cast<Slot*>(object));
+        --live_;
+    }
+
+    // Allocates slabs so the next `count` creates do not allocate
+    void reserve(size_t count) {
+        size_t available = free_count_ + (slabs_.size() * SlabSize - used_in_slabs_);
+        while (available < count) {
+            add_slab();
+            available += SlabSize;
+        }
+    }
+
+    size_t size() const { return live_; }
+    size_t capacity() const { return slabs_.size() * SlabSize; }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    Slot* acquire() {
+        if (free_list_) {
+            Slot* slot = free_list_;
+            free_list_ = slot->next;
+            --free_count_;
+            return slot;
+        }
+        if (used_in_slabs_ == slabs_.size() * SlabSize) add_slab();
+        Slot* slot = &slabs_[used_in_slabs_ / SlabSize][used_in_slabs_ % SlabSize];
+        ++used_in_slabs_;
+        return slot;
+    }
+
+    void release(Slot* slot) {
+        slot->next = free_list_;
+        free_list_ = slot;
+        ++free_count_;
+    }
+
+    // Default-initialized, so untouched slots cost no resident memory
+    void add_slab() { slabs_.push_back(std::unique_ptr<Slot[]>(new Slot[SlabSize])); }
+
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    size_t used_in_slabs_ = 0; // slots handed out by bump allocation, slabs fill in order
+    Slot* free_list_ = nullptr;
+    size_t free_count_ = 0;
+    size_t live_ = 0;
+};
+
+} // namespace graph_db
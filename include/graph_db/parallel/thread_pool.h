@@ -0,0 +1,75 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graph_db {
+namespace parallel {
+
+// Fixed-size pool for data-parallel loops. Each parallel_for splits its range into
+// contiguous blocks of chunks dealt out to per-worker deques; a worker drains its own
+// deque from the front and, once empty, steals from the back of a victim's deque, so
+// skewed chunks (e.g. hub vertices) do not leave the other cores idle.
+class ThreadPool {
+public:
+    // `threads` counts the calling thread, which takes part in every parallel_for
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return queues_.size(); }
+
+    // Runs fn(chunk_begin, chunk_end, worker) over [begin, end) in chunks of `grain`
+    // and blocks until all chunks are done. `worker` is in [0, size()) and is stable
+    // for the duration of one chunk, so it can index per-worker scratch buffers.
+    // Calls from inside a worker run serially on that worker. The first exception
+    // thrown by fn is rethrown here once the loop has drained.
+    void parallel_for(size_t begin, size_t end, size_t grain,
+                      const std::function<void(size_t, size_t, size_t)>& fn);
+
+    // Process-wide pool sized to the hardware
+    static ThreadPool& global();
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> chunks;
+    };
+
+    void worker_loop(size_t worker);
+    void run_chunks(size_t worker);
+    bool pop_local(size_t worker, size_t& chunk);
+    bool steal(size_t thief, size_t& chunk);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // The job currently being executed, published under wake_mutex_
+    std::mutex job_mutex_; // serializes parallel_for callers
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+    // Every worker checks in once per generation, so none can lag into the next job
+    size_t finished_workers_ = 0;
+    const std::function<void(size_t, size_t, size_t)>* job_ = nullptr;
+    size_t job_begin_ = 0;
+    size_t job_end_ = 0;
+    size_t job_grain_ = 1;
+    std::exception_ptr error_;
+    std::mutex error_mutex_;
+};
+
+} // namespace parallel
+} // namespace graph_db
@@ -12,6 +12,7 @@ enum class QueryType {
     BFS,
     DFS,
     DIJKSTRA,
+    SSSP,
     UNKNOWN
 };
 
@@ -19,6 +20,8 @@ struct ParsedQuery {
     QueryType type = QueryType::UNKNOWN;
     NodeID start_node;
     NodeID end_node; // For shortest path
+    bool parallel = false; // BFS FROM <id> PARALLEL
+    int64_t delta = 0;     // SSSP FROM <id> DELTA <d>; 0 = automatic
 };
 
 class QueryParser {
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+namespace graph_db {
+
+// Pointer to a node or edge handed out by Graph::get_node_ref and get_edge_ref. On a
+// paged graph it pins the record: the shard keeps a pinned record cached, past its budget
+// if need be, until every reference to it is gone. Drop references once done with them.
+// A pinned record that is removed from the graph stays allocated, though detached from
+// it, until its last reference goes away.
+template <typename T>
+class RecordRef {
+public:
+    RecordRef() = default;
+    RecordRef(std::nullptr_t) {}
+    // Pins `record` if `pin` is set; the caller holds the lock of the record's shard
+    RecordRef(T* record, bool pin) : record_(record), pinned_(pin ? record : nullptr) {
+        if (pinned_) pinned_->pin();
+    }
+    RecordRef(const RecordRef& other) : record_(other.record_), pinned_(other.pinned_) {
+        if (pinned_) pinned_->pin();
+    }
+    RecordRef(RecordRef&& other) noexcept
+        : record_(std::exchange(other.record_, nullptr)), pinned_(std::exchange(other.pinned_, nullptr)) {}
+    RecordRef& operator=(RecordRef other) noexcept {
+        std::swap(record_, other.record_);
+        std::swap(pinned_, other.pinned_);
+        return *this;
+    }
+    ~RecordRef() {
+        if (pinned_) pinned_->unpin();
+    }
+
+    T* get() const { return record_; }
+    T* operator->() const { return record_; }
+    T& operator*() const { return *record_; }
+    explicit operator bool() const { return record_ != nullptr; }
+
+    friend bool operator==(const RecordRef& a, const RecordRef& b) { return a.record_ == b.record_; }
+    friend bool operator!=(const RecordRef& a, const RecordRef& b) { return a.record_ != b.record_; }
+    friend bool operator==(const RecordRef& ref, std::nullptr_t) { return !ref.record_; }
+    friend bool operator!=(const RecordRef& ref, std::nullptr_t) { return ref.record_ != nullptr; }
+    friend bool operator==(const RecordRef& ref, const T* record) { return ref.record_ == record; }
+    friend bool operator!=(const RecordRef& ref, const T* record) { return ref.record_ != record; }
+
+private:
+    T* record_ = nullptr;
+    T* pinned_ = nullptr; // record_ if this reference pinned it
+};
+
+}
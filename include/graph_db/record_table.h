@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "types.h"
+
+namespace graph_db {
+
+// Dense table of T* indexed directly by ID. IDs are handed out sequentially, so a
+// vector-backed table needs no hashing: lookup is one division and two array reads.
+// Slots live in fixed-size chunks that are allocated on first use and never moved, so
+// growth does not touch existing entries. A null slot marks a missing or deleted ID.
+//
+// With Stride > 1 the table holds every Stride-th ID (id % Stride is fixed by the
+// caller, e.g. a shard index) and stores id / Stride, keeping the slots dense.
+// IDs from kDenseIdLimit up, which only explicit IDs reach, go to an ordered map, so a
+// single huge ID costs one map node rather than a chunk array sized by its value.
+// Not thread-safe; the table does not own the pointed-to objects.
+template <typename T, size_t Stride = 1, size_t ChunkSize = 1024>
+class RecordTable {
+public:
+    T* get(uint64_t id) const {
+        uint64_t slot = id / Stride;
+        if (slot >= kDenseSlots) {
+            auto it = sparse_.find(id);
+            return it == sparse_.end() ? nullptr : it->second;
+        }
+        uint64_t chunk = slot / ChunkSize;
+        if (chunk >= chunks_.size() || !chunks_[chunk]) return nullptr;
+        return chunks_[chunk][slot % ChunkSize];
+    }
+
+    bool contains(uint64_t id) const { return get(id) != nullptr; }
+
+    // Stores `record` for `id`, which must not be present
+    void insert(uint64_t id, T* record) {
+        uint64_t slot = id / Stride;
+        T*& entry = slot >= kDenseSlots ? sparse_[id] : chunk_for(slot / ChunkSize)[slot % ChunkSize];
+        if (!entry) ++size_;
+        entry = record;
+    }
+
+    // Clears the slot and returns what it held (nullptr if it was empty)
+    T* erase(uint64_t id) {
+        uint64_t slot = id / Stride;
+        if (slot >= kDenseSlots) {
+            auto it = sparse_.find(id);
+            if (it == sparse_.end()) return nullptr;
+            T* record = it->second;
+            sparse_.erase(it);
+            --size_;
+            return record;
+        }
+        uint64_t chunk = slot / ChunkSize;
+        if (chunk >= chunks_.size() || !chunks_[chunk]) return nullptr;
+        T* record = chunks_[chunk][slot % ChunkSize];
+        chunks_[chunk][slot % ChunkSize] = nullptr;
+        if (record) --size_;
+        return record;
+    }
+
+    // Allocates the chunks covering every dense ID up to `max_id`
+    void reserve(uint64_t max_id) {
+        uint64_t last_chunk = std::min(max_id / Stride, kDenseSlots - 1) / ChunkSize;
+        for (uint64_t chunk = 0; chunk <= last_chunk; ++chunk) chunk_for(chunk);
+    }
+
+    size_t size() const { return size_; }
+
+    // Visits live records in ascending ID order
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& chunk : chunks_) {
+            if (!chunk) continue;
+            for (size_t i = 0; i < ChunkSize; ++i) {
+                if (chunk[i]) fn(chunk[i]);
+            }
+        }
+        for (const auto& [id, record] : sparse_) fn(record);
+    }
+
+private:
+    T** chunk_for(uint64_t chunk) {
+        if (chunk >= chunks_.size()) chunks_.resize(chunk + 1);
+        if (!chunks_[chunk]) chunks_[chunk] = std::make_unique<T*[]>(ChunkSize); // zeroed
+        return chunks_[chunk].get();
+    }
+
+    static constexpr uint64_t kDenseSlots = (kDenseIdLimit + Stride - 1) / Stride;
+
+    std::vector<std::unique_ptr<T*[]>> chunks_;
+    std::map<uint64_t, T*> sparse_;
+    size_t size_ = 0;
+};
+
+} // namespace graph_db
@@ -0,0 +1,51 @@
+#pragma once
+#include "../types.h"
+#include <cstddef>
+#include <string>
+
+namespace graph_db {
+    class Graph;
+}
+
+namespace graph_db {
+namespace storage {
+
+struct ImportOptions {
+    char delimiter = ',';
+    // Parser threads; 0 uses the process-wide pool
+    size_t threads = 0;
+    // Target bytes per parse chunk; chunks are cut on line boundaries
+    size_t chunk_bytes = size_t{4} << 20;
+};
+
+struct ImportStats {
+    size_t nodes = 0;
+    size_t edges = 0;
+    size_t bytes = 0;
+};
+
+// Imports delimited text files with a header row. Each header column is `name` or
+// `name:type`, type being one of string (default), int, double or bool; typed columns
+// become node/edge properties and empty fields are left unset.
+//
+// Node files: an optional `id` column holds the NodeID (assigned by the graph when absent).
+// Edge files: `from` and `to` are required NodeIDs; `label`, `weight` (int) and `id` are optional.
+//
+// Fields may be quoted with "..." ("" escapes a quote) but must not contain line breaks.
+// The file is memory-mapped, parsed in parallel chunks and inserted in file order via
+// Graph::bulk_insert, one batch per chunk. Malformed rows throw std::runtime_error naming
+// the file and line; rows of earlier batches may already have been inserted.
+class CsvImporter {
+public:
+    explicit CsvImporter(Graph& graph, ImportOptions options = ImportOptions());
+
+    ImportStats import_nodes(const std::string& filename);
+    ImportStats import_edges(const std::string& filename);
+
+private:
+    Graph& graph_;
+    ImportOptions options_;
+};
+
+} // namespace storage
+} // namespace graph_db
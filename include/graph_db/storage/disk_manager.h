@@ -1,26 +1,34 @@
 #pragma once
 
-#include <fstream>
+#include <atomic>
 #include <string>
-#include <mutex>
 #include "../types.h"
 
 namespace graph_db {
 namespace storage {
 
+// Pages of one file, read and written with positioned I/O: there is no shared file
+// offset, so calls for different pages run in parallel without a latch.
 class DiskManager {
 public:
     DiskManager(const std::string& db_file);
     ~DiskManager();
+    DiskManager(const DiskManager&) = delete;
+    DiskManager& operator=(const DiskManager&) = delete;
 
     void write_page(PageID page_id, const char* page_data);
     void read_page(PageID page_id, char* page_data);
+    // Next unused page at the end of the file. IDs are not reused; whoever frees a page
+    // keeps it on a free list of its own.
+    PageID allocate_page();
+    // Pages allocated so far, including those allocated by earlier runs
+    PageID num_pages() const { return next_page_id_.load(std::memory_order_relaxed); }
 
 private:
-    std::fstream db_io_;
+    int fd_ = -1;
     std::string file_name_;
-    std::mutex db_io_latch_;
+    std::atomic<PageID> next_page_id_{0};
 };
 
 } // namespace storage
-} // namespace graph_db
\ No newline at end of file
+} // namespace graph_db
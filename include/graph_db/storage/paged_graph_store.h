@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../buffer/partitioned_buffer_pool.h"
+#include "../buffer/page_guard.h"
+#include "disk_manager.h"
+#include "../types.h"
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace graph_db {
+namespace storage {
+
+enum class RecordKind : uint8_t { Node = 0, Edge = 1 };
+
+// File of node and edge records for Graph's paged storage engine. Records are opaque
+// byte strings (Graph encodes properties and adjacency into them) kept in slotted heap
+// pages: a slot array of (offset, size) grows from the page header while the cells fill
+// the page from its end. A record over kMaxInline bytes, typically a hub's adjacency,
+// moves to a chain of overflow pages and leaves a stub in its slot, so a record never
+// changes slots once written.
+//
+// Each kind has a directory from ID to (page, slot): pages of 511 entries indexed
+// directly by ID, like RecordTable, found through a chain of list pages that is read
+// into memory on open. IDs must be below kDenseIdLimit, so the directory, and the list
+// pages written to the file, stay proportional to the IDs in use; write throws otherwise.
+//
+// Page 0 is the store header. Every page goes through one PartitionedBufferPool, so only
+// the pages in use take memory; dirty pages reach the file on flush() and on
+// destruction. Safe for concurrent use: every call takes mutex_.
+class PagedGraphStore {
+public:
+    // Opens `path`, creating an empty store if the file is new; `pool_pages` frames of
+    // 4 KB are cached, replaced as `replacer` picks
+    PagedGraphStore(const std::string& path, size_t pool_pages,
+                    buffer::ReplacerKind replacer = buffer::ReplacerKind::TwoQ);
+
+    // Copies the record into `out`; false if there is none
+    bool read(RecordKind kind, uint64_t id, std::string& out);
+    // Inserts or replaces the record of `id`
+    void write(RecordKind kind, uint64_t id, const std::string& record);
+    bool erase(RecordKind kind, uint64_t id);
+    // Up to `limit` IDs of stored records, ascending from `from`
+    std::vector<uint64_t> ids(RecordKind kind, uint64_t from, size_t limit);
+    void flush();
+
+private:
+    static constexpr size_t kMaxInline = 1024;
+    // A page goes back to the insert candidates once it has this much to reclaim
+    static constexpr size_t kRoomy = 1024;
+
+    // Packed (page, slot) of a record, 0 if none: page 0 is never a heap page
+    using RecordRef = uint64_t;
+
+    RecordRef lookup(RecordKind kind, uint64_t id);
+    void set_ref(RecordKind kind, uint64_t id, RecordRef ref);
+    // Slot for a cell of `size` bytes, in the current fill page or a page with room
+    RecordRef place(const std::string& cell);
+    // Cell holding `record`, inline or as a stub for an overflow chain
+    std::string make_cell(const std::string& record);
+    void drop_cell(const char* cell);
+
+    PageID write_chain(const char* bytes, size_t size);
+    void read_chain(PageID page, std::string& out);
+    void free_chain(PageID page);
+
+    buffer::PageGuard allocate(uint8_t type);
+    void free_page(PageID page);
+    void note_free_space(const buffer::PageGuard& page);
+    void sync_header();
+
+    DiskManager disk_;
+    buffer::PartitionedBufferPool pool_;
+    // Per kind: directory page of each run of kPerDirectory IDs (0 if none yet), and the
+    // chain of pages that lists them
+    std::vector<PageID> directories_[2];
+    std::vector<PageID> lists_[2];
+    PageID free_list_ = kInvalidPageID;
+    PageID fill_ = kInvalidPageID; // heap page taking new records
+    std::set<PageID> roomy_;       // other heap pages worth filling
+    bool header_dirty_ = false;
+    std::mutex mutex_;
+};
+
+} // namespace storage
+} // namespace graph_db
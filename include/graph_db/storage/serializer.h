@@ -18,11 +18,26 @@ public:
     bool save_to_file(const std::string& filename);
     bool load_from_file(const std::string& filename);
 
+    // Record writers for the file format, so other producers (e.g. the graph
+    // generators) can stream a file without going through a Graph.
+    // Layout: node count, node records, edge count, edge records.
+    static void write_count(std::ofstream& out, size_t count);
+    static void write_node_record(std::ofstream& out, NodeID id, const PropertyMap& properties);
+    static void write_edge_record(std::ofstream& out, EdgeID id, NodeID from, NodeID to,
+                                  const std::string& label, const PropertyMap& properties);
+
 private:
     Graph& graph_;
 
-    void write_property_value(std::ofstream& out, const PropertyValue& value);
+    static void write_properties(std::ofstream& out, const PropertyMap& properties);
+    static void write_property_value(std::ofstream& out, const PropertyValue& value);
     PropertyValue read_property_value(std::ifstream& in);
+    // False, with the stream failed, unless `count` items of at least `size` bytes each
+    // fit in the rest of the file: sizes read from a corrupt file must not drive huge
+    // allocations
+    bool fits(std::ifstream& in, size_t count, size_t size = 1);
+
+    std::streamoff file_end_ = 0;
 };
 
 } // namespace storage
@@ -6,10 +6,15 @@
 namespace graph_db{
     using NodeID= std::uint64_t;
     using EdgeID=std::uint64_t;
+    using LabelID = std::uint32_t;
     using PropertyValue = std::variant<std::int64_t, double, std::string, bool>;
     using PropertyMap=std::unordered_map<std::string,PropertyValue>;
+    // IDs below this are stored densely by value: RecordTable chunks and the paged store's
+    // directories. RecordTable keeps larger IDs in a sparse map; the paged store rejects them.
+    constexpr std::uint64_t kDenseIdLimit = std::uint64_t{1} << 30;
     using PageID = int32_t;
     using FrameID = int32_t;
+    constexpr PageID kInvalidPageID = -1;
 
     class Page {
     public:
@@ -1,8 +1,25 @@
 #include "../../include/graph_db/Index/b_plus_tree.h"
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 namespace graph_db {
 
+namespace {
+
+// Smallest value of the variant alternative `type`; keys of one type are contiguous
+// in the tree, so this is where that type's run starts
+PropertyValue smallest_of(size_t type) {
+    switch (type) {
+        case 0: return std::numeric_limits<int64_t>::min();
+        case 1: return -std::numeric_limits<double>::infinity();
+        case 2: return std::string();
+        default: return false;
+    }
+}
+
+} // namespace
+
 void BPlusTree::insert(const PropertyValue& key, NodeID value) {
     tree_.insert(key, value);
 }
@@ -15,4 +32,47 @@ void BPlusTree::remove(const PropertyValue& key, NodeID value) {
     tree_.remove(key, value);
 }
 
-}
\ No newline at end of file
+void BPlusTree::scan(const RangeScan& range, const ScanFn& fn) const {
+    using Iterator = decltype(tree_.begin());
+    if (range.lower && range.upper && range.lower->value.index() != range.upper->value.index()) {
+        throw std::runtime_error("range scan: bounds must have the same type");
+    }
+    // [first, last) covers the range; with a single bound it ends at the bound type's run
+    Iterator first = tree_.begin();
+    Iterator last = tree_.end();
+    size_t type = range.lower ? range.lower->value.index() : range.upper ? range.upper->value.index() : 0;
+    bool typed = range.lower || range.upper;
+    if (range.lower) {
+        first = range.lower->inclusive ? tree_.lower_bound(range.lower->value) : tree_.upper_bound(range.lower->value);
+    } else if (typed) {
+        first = tree_.lower_bound(smallest_of(type));
+    }
+    if (range.upper) {
+        last = range.upper->inclusive ? tree_.upper_bound(range.upper->value) : tree_.lower_bound(range.upper->value);
+    } else if (typed && type + 1 < std::variant_size_v<PropertyValue>) {
+        last = tree_.lower_bound(smallest_of(type + 1));
+    }
+    bool inverted = first == tree_.end() ? last != tree_.end() : last != tree_.end() && last.key() < first.key();
+    if (first == last || inverted) return;
+
+    if (!range.descending) {
+        for (Iterator it = first; it != last; ++it) {
+            if (!fn(it.key(), it.values())) return;
+        }
+        return;
+    }
+    for (Iterator it = last; it != first;) {
+        --it;
+        if (!fn(it.key(), it.values())) return;
+    }
+}
+
+void BPlusTree::scan_prefix(const std::string& prefix, const ScanFn& fn) const {
+    for (auto it = tree_.lower_bound(prefix); it != tree_.end(); ++it) {
+        const std::string* key = std::get_if<std::string>(&it.key());
+        if (!key || key->compare(0, prefix.size(), prefix) != 0) return;
+        if (!fn(it.key(), it.values())) return;
+    }
+}
+
+}
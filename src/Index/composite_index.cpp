@@ -0,0 +1,130 @@
+#include "../../include/graph_db/Index/composite_index.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace graph_db {
+
+namespace {
+
+void append_big_endian(std::string& out, uint64_t bits) {
+    for (int shift = 56; shift >= 0; shift -= 8) out.push_back(static_cast<char>(bits >> shift));
+}
+
+// Sorts after every extension of the string it is appended to, since columns start
+// with a type tag below it
+constexpr char kAfterColumns = '\xFF';
+
+} // namespace
+
+bool CompositeIndex::covers(const std::string& key) const {
+    return std::find(keys_.begin(), keys_.end(), key) != keys_.end();
+}
+
+void CompositeIndex::append(std::string& out, const PropertyValue& value) {
+    out.push_back(static_cast<char>(value.index()));
+    std::visit([&out](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, int64_t>) {
+            append_big_endian(out, static_cast<uint64_t>(v) ^ (uint64_t{1} << 63));
+        } else if constexpr (std::is_same_v<T, double>) {
+            double d = v == 0 ? 0.0 : v; // -0.0 == 0.0
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            append_big_endian(out, bits >> 63 ? ~bits : bits ^ (uint64_t{1} << 63));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            // NUL is escaped to 00 FF and the string ends with 00 01
+            for (char c : v) {
+                out.push_back(c);
+                if (c == '\0') out.push_back('\xFF');
+            }
+            out.append("\0\1", 2);
+        } else {
+            out.push_back(v ? 1 : 0);
+        }
+    }, value);
+}
+
+std::string CompositeIndex::encode(const std::vector<PropertyValue>& values) {
+    std::string out;
+    for (const PropertyValue& value : values) append(out, value);
+    return out;
+}
+
+std::optional<std::string> CompositeIndex::key_of(const PropertyMap& properties) const {
+    std::string out;
+    for (const std::string& column : keys_) {
+        auto it = properties.find(column);
+        if (it == properties.end()) return std::nullopt;
+        append(out, it->second);
+    }
+    return out;
+}
+
+std::optional<std::string> CompositeIndex::key_of(const PropertyMap& properties, const std::string& key,
+                                                  const PropertyValue* value) const {
+    std::string out;
+    for (const std::string& column : keys_) {
+        if (column == key) {
+            if (!value) return std::nullopt;
+            append(out, *value);
+            continue;
+        }
+        auto it = properties.find(column);
+        if (it == properties.end()) return std::nullopt;
+        append(out, it->second);
+    }
+    return out;
+}
+
+void CompositeIndex::replace(const std::optional<std::string>& before, const std::optional<std::string>& after,
+                             NodeID id) {
+    if (before == after) return;
+    if (before) index_.remove(*before, id);
+    if (after) index_.insert(*after, id);
+}
+
+std::vector<NodeID> CompositeIndex::find(const std::vector<PropertyValue>& prefix, const RangeScan& next) const {
+    if (prefix.size() > keys_.size()) throw std::runtime_error("composite lookup: more values than keys");
+    bool bounded = next.lower || next.upper;
+    if (prefix.size() == keys_.size()) {
+        if (bounded) throw std::runtime_error("composite lookup: no column left for the range");
+        std::vector<NodeID> ids = index_.find(encode(prefix));
+        if (next.limit && ids.size() > next.limit) ids.resize(next.limit);
+        return ids;
+    }
+    if (next.lower && next.upper && next.lower->value.index() != next.upper->value.index()) {
+        throw std::runtime_error("range scan: bounds must have the same type");
+    }
+
+    std::string base = encode(prefix);
+    auto column = [&base](const PropertyValue& value) {
+        std::string key = base;
+        append(key, value);
+        return key;
+    };
+    RangeScan scan{std::nullopt, std::nullopt, next.descending, next.limit};
+    if (next.lower) {
+        // Inclusive takes every tuple extending (prefix, lower); exclusive skips them
+        std::string key = column(next.lower->value);
+        if (!next.lower->inclusive) key.push_back(kAfterColumns);
+        scan.lower = RangeBound{std::move(key), true};
+    }
+    if (next.upper) {
+        std::string key = column(next.upper->value);
+        if (next.upper->inclusive) key.push_back(kAfterColumns);
+        scan.upper = RangeBound{std::move(key), false};
+    }
+    // A one-sided range stays within its bound's type; no bounds means the whole prefix
+    if (bounded) {
+        char tag = static_cast<char>((next.lower ? next.lower->value : next.upper->value).index());
+        if (!scan.lower) scan.lower = RangeBound{base + tag, true};
+        if (!scan.upper) scan.upper = RangeBound{base + static_cast<char>(tag + 1), false};
+    } else if (!base.empty()) {
+        scan.lower = RangeBound{base, true};
+        scan.upper = RangeBound{base + kAfterColumns, false};
+    }
+    return index_.range(scan);
+}
+
+}
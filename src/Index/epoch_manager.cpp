@@ -0,0 +1,110 @@
+#include "../../include/graph_db/Index/epoch_manager.h"
+#include <algorithm>
+
+namespace graph_db {
+
+// Hands the thread's slot back when the thread exits
+struct EpochSlotHandle {
+    EpochManager::Slot* slot = nullptr;
+    ~EpochSlotHandle() {
+        if (slot) EpochManager::global().release_slot(slot);
+    }
+};
+
+namespace {
+thread_local EpochSlotHandle local_handle;
+} // namespace
+
+EpochManager& EpochManager::global() {
+    static EpochManager manager;
+    return manager;
+}
+
+EpochManager::~EpochManager() {
+    // Process exit: nothing can be pinned any more
+    for (Slot* slot = slots_.load(); slot;) {
+        for (const Retired& r : slot->retired) r.deleter(r.ptr);
+        Slot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+    for (const Retired& r : orphans_) r.deleter(r.ptr);
+}
+
+EpochManager::Slot* EpochManager::local_slot() {
+    if (!local_handle.slot) local_handle.slot = acquire_slot();
+    return local_handle.slot;
+}
+
+EpochManager::Slot* EpochManager::acquire_slot() {
+    for (Slot* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+        bool expected = false;
+        if (!slot->owned.load(std::memory_order_relaxed) && slot->owned.compare_exchange_strong(expected, true)) {
+            return slot;
+        }
+    }
+    Slot* slot = new Slot;
+    slot->owned.store(true, std::memory_order_relaxed);
+    slot->next = slots_.load(std::memory_order_relaxed);
+    while (!slots_.compare_exchange_weak(slot->next, slot, std::memory_order_release)) {
+    }
+    return slot;
+}
+
+void EpochManager::release_slot(Slot* slot) {
+    if (!slot->retired.empty()) {
+        std::lock_guard lock(orphans_mutex_);
+        orphans_.insert(orphans_.end(), slot->retired.begin(), slot->retired.end());
+        slot->retired.clear();
+    }
+    slot->owned.store(false, std::memory_order_release);
+}
+
+EpochManager::Guard EpochManager::pin() {
+    Slot* slot = local_slot();
+    if (slot->depth++ == 0) {
+        slot->epoch.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // Loads of shared pointers must not be reordered before the published epoch; the
+        // fence is the only full barrier a pin pays
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    return Guard();
+}
+
+EpochManager::Guard::~Guard() {
+    EpochManager::Slot* slot = local_handle.slot;
+    if (--slot->depth == 0) slot->epoch.store(0, std::memory_order_release);
+}
+
+void EpochManager::retire(void* ptr, void (*deleter)(void*)) {
+    Slot* slot = local_slot();
+    // Orders the caller's unlink before the epoch it is stamped with
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    slot->retired.push_back({epoch_.load(std::memory_order_seq_cst), ptr, deleter});
+    if (slot->retired.size() >= kReclaimBatch) reclaim(slot->retired);
+}
+
+uint64_t EpochManager::min_pinned_epoch() const {
+    uint64_t min = epoch_.load(std::memory_order_seq_cst);
+    for (Slot* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+        uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) min = std::min(min, epoch);
+    }
+    return min;
+}
+
+void EpochManager::reclaim(std::vector<Retired>& list) {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t safe = min_pinned_epoch();
+    auto free_older = [safe](std::vector<Retired>& retired) {
+        auto keep = std::partition(retired.begin(), retired.end(), [safe](const Retired& r) { return r.epoch >= safe; });
+        for (auto it = keep; it != retired.end(); ++it) it->deleter(it->ptr);
+        retired.erase(keep, retired.end());
+    };
+    free_older(list);
+    std::unique_lock lock(orphans_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) free_older(orphans_);
+}
+
+}
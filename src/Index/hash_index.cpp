@@ -0,0 +1,172 @@
+#include "../../include/graph_db/Index/hash_index.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace graph_db {
+
+HashIndex::Table::Table(size_t capacity)
+    : tags(static_cast<uint64_t*>(std::calloc(capacity, sizeof(uint64_t)))),
+      entries(static_cast<Entry*>(::operator new(capacity * sizeof(Entry)))),
+      capacity_(capacity) {
+    if (!tags && capacity) {
+        ::operator delete(entries);
+        throw std::bad_alloc();
+    }
+}
+
+HashIndex::Table& HashIndex::Table::operator=(Table&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    tags = std::exchange(other.tags, nullptr);
+    entries = std::exchange(other.entries, nullptr);
+    size = std::exchange(other.size, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    return *this;
+}
+
+void HashIndex::Table::release() {
+    // A drained table has no live entries, so dropping it does not walk its slots
+    for (size_t slot = 0; size && slot < capacity_; ++slot) {
+        if (tags[slot] > kDeleted) {
+            std::destroy_at(&entries[slot]);
+            --size;
+        }
+    }
+    std::free(tags);
+    ::operator delete(entries);
+    tags = nullptr;
+    entries = nullptr;
+    size = 0;
+    capacity_ = 0;
+}
+
+uint64_t HashIndex::tag_of(const PropertyValue& key) {
+    // std::hash is the identity for integers; mix so consecutive keys spread out
+    uint64_t h = std::hash<PropertyValue>{}(key);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return (h ^ (h >> 31)) | (1ULL << 63);
+}
+
+size_t HashIndex::find_slot(const Table& table, const PropertyValue& key, uint64_t tag) {
+    size_t mask = table.capacity() - 1;
+    for (size_t slot = tag & mask;; slot = (slot + 1) & mask) {
+        uint64_t t = table.tags[slot];
+        if (t == kEmpty) return table.capacity();
+        if (t == tag && table.entries[slot].key == key) return slot;
+    }
+}
+
+HashIndex::Location HashIndex::locate(const PropertyValue& key, uint64_t tag) const {
+    size_t slot = find_slot(table_, key, tag);
+    if (slot != table_.capacity()) return {true, false, slot};
+    if (old_.size) {
+        slot = find_slot(old_, key, tag);
+        if (slot != old_.capacity()) return {true, true, slot};
+    }
+    return {false, false, 0};
+}
+
+size_t HashIndex::place(Table& table, uint64_t tag, Entry entry) {
+    size_t mask = table.capacity() - 1;
+    size_t slot = tag & mask;
+    while (table.tags[slot] != kEmpty) slot = (slot + 1) & mask;
+    table.tags[slot] = tag;
+    new (&table.entries[slot]) Entry(std::move(entry));
+    ++table.size;
+    return slot;
+}
+
+void HashIndex::erase(const Location& at) {
+    Table& table = at.old ? old_ : table_;
+    std::destroy_at(&table.entries[at.slot]);
+    --table.size;
+    if (at.old) {
+        table.tags[at.slot] = kDeleted;
+        return;
+    }
+    // Backward shift: pull later members of the probe run into the hole, so the table
+    // never accumulates tombstones
+    size_t mask = table.capacity() - 1;
+    size_t hole = at.slot;
+    for (size_t slot = (hole + 1) & mask; table.tags[slot] != kEmpty; slot = (slot + 1) & mask) {
+        size_t home = table.tags[slot] & mask;
+        // Movable unless its home lies cyclically in (hole, slot]
+        if (((slot - home) & mask) < ((slot - hole) & mask)) continue;
+        table.tags[hole] = table.tags[slot];
+        new (&table.entries[hole]) Entry(std::move(table.entries[slot]));
+        std::destroy_at(&table.entries[slot]);
+        hole = slot;
+    }
+    table.tags[hole] = kEmpty;
+}
+
+void HashIndex::migrate(size_t slots) {
+    if (old_.capacity() == 0) return;
+    size_t end = std::min(old_.capacity(), migrated_ + slots);
+    for (; migrated_ < end; ++migrated_) {
+        uint64_t& tag = old_.tags[migrated_];
+        if (tag == kEmpty || tag == kDeleted) continue;
+        place(table_, tag, std::move(old_.entries[migrated_]));
+        std::destroy_at(&old_.entries[migrated_]);
+        // Tombstone, so probes for keys further along the run still get past it
+        tag = kDeleted;
+        --old_.size;
+    }
+    if (migrated_ == old_.capacity()) {
+        old_ = Table();
+        migrated_ = 0;
+    }
+}
+
+void HashIndex::grow() {
+    // Drained long before the new table fills, but never run two resizes at once
+    migrate(old_.capacity());
+    old_ = std::move(table_);
+    table_ = Table(old_.capacity() * 2);
+}
+
+void HashIndex::insert(const PropertyValue& key, NodeID value) {
+    std::unique_lock lock(mutex_);
+    migrate(kMigrateStep);
+    uint64_t tag = tag_of(key);
+    Location at = locate(key, tag);
+    if (!at.found) {
+        // Past 3/4 load: the old table drains after capacity / kMigrateStep writes, well
+        // before the doubled table reaches 3/4 in turn
+        if ((table_.size + 1) * 4 > table_.capacity() * 3) grow();
+        at = {true, false, place(table_, tag, Entry{key, {}})};
+    }
+    entry(at).ids.push_back(value);
+}
+
+void HashIndex::remove(const PropertyValue& key, NodeID value) {
+    std::unique_lock lock(mutex_);
+    migrate(kMigrateStep);
+    Location at = locate(key, tag_of(key));
+    if (!at.found) return;
+    std::vector<NodeID>& ids = entry(at).ids;
+    auto it = std::find(ids.begin(), ids.end(), value);
+    if (it == ids.end()) return;
+    ids.erase(it);
+    if (ids.empty()) erase(at);
+}
+
+std::vector<NodeID> HashIndex::find(const PropertyValue& key) const {
+    std::shared_lock lock(mutex_);
+    Location at = locate(key, tag_of(key));
+    if (!at.found) return {};
+    return (at.old ? old_ : table_).entries[at.slot].ids;
+}
+
+size_t HashIndex::size() const {
+    std::shared_lock lock(mutex_);
+    return table_.size + old_.size;
+}
+
+}
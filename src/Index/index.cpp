@@ -0,0 +1,186 @@
+#include "../../include/graph_db/Index/index.h"
+
+namespace graph_db {
+
+void Index::insert(const PropertyValue& key, NodeID value) {
+    if (failed_.load(std::memory_order_relaxed)) return;
+    if (!log_if_building(key, value, true)) apply_insert(key, value);
+}
+
+void Index::remove(const PropertyValue& key, NodeID value) {
+    if (failed_.load(std::memory_order_relaxed)) return;
+    if (!log_if_building(key, value, false)) apply_remove(key, value);
+}
+
+bool Index::log_if_building(const PropertyValue& key, NodeID value, bool insert) {
+    if (!building_.load(std::memory_order_acquire)) return false;
+    std::lock_guard lock(build_mutex_);
+    if (!building_.load(std::memory_order_relaxed)) return failed_.load(std::memory_order_relaxed);
+    pending_.push_back({key, value, insert});
+    return true;
+}
+
+void Index::wait_until_built() const {
+    if (building_.load(std::memory_order_acquire)) {
+        std::unique_lock lock(build_mutex_);
+        built_.wait(lock, [this]() { return !building_.load(std::memory_order_relaxed); });
+    }
+    if (failed_.load(std::memory_order_acquire)) throw std::runtime_error("index: its build failed");
+}
+
+void Index::finish_build(std::vector<std::pair<PropertyValue, NodeID>> sorted) {
+    // Writers only log while building_ is set, so the tree is ours until then
+    if (hash_) {
+        for (const auto& [key, value] : sorted) hash_->insert(key, value);
+    } else if (paged_) {
+        // In key order, so every insert appends to the rightmost leaf and leaves full pages
+        for (const auto& [key, value] : sorted) paged_->insert(key, value);
+    } else if (!sorted.empty() && sorted.front().first.index() == sorted.back().first.index()) {
+        std::unique_lock lock(tree_mutex_);
+        make_typed(sorted.front().first.index());
+        std::visit([&sorted](auto& tree) {
+            using T = std::decay_t<decltype(tree)>;
+            if constexpr (!std::is_same_v<T, std::monostate> && !std::is_same_v<T, std::unique_ptr<BPlusTree>>) {
+                tree->bulk_load(sorted);
+            }
+        }, tree_);
+    } else {
+        for (const auto& [key, value] : sorted) apply_insert(key, value);
+    }
+    sorted = {};
+
+    std::lock_guard lock(build_mutex_);
+    for (const PendingWrite& write : pending_) {
+        if (!write.insert) {
+            apply_remove(write.key, write.value);
+            continue;
+        }
+        auto existing = find_in_tree(write.key);
+        if (std::find(existing.begin(), existing.end(), write.value) == existing.end()) {
+            apply_insert(write.key, write.value);
+        }
+    }
+    pending_ = {};
+    building_.store(false, std::memory_order_release);
+    built_.notify_all();
+}
+
+void Index::abandon_build() {
+    std::lock_guard lock(build_mutex_);
+    failed_.store(true, std::memory_order_release);
+    pending_ = {};
+    building_.store(false, std::memory_order_release);
+    built_.notify_all();
+}
+
+void Index::apply_insert(const PropertyValue& key, NodeID value) {
+    if (hash_) {
+        hash_->insert(key, value);
+        return;
+    }
+    if (paged_) {
+        paged_->insert(key, value);
+        return;
+    }
+    {
+        // Common case: the key fits the typed tree, which takes concurrent writers
+        std::shared_lock lock(tree_mutex_);
+        if (typed_for(key)) {
+            insert_into_tree(key, value);
+            return;
+        }
+    }
+    std::unique_lock lock(tree_mutex_);
+    if (std::holds_alternative<std::monostate>(tree_)) {
+        make_typed(key.index());
+    } else if (!generic() && !typed_for(key)) {
+        make_generic();
+    }
+    insert_into_tree(key, value);
+}
+
+void Index::insert_into_tree(const PropertyValue& key, NodeID value) {
+    std::visit([&](auto& tree) {
+        using T = std::decay_t<decltype(tree)>;
+        if constexpr (std::is_same_v<T, std::unique_ptr<BPlusTree>>) {
+            tree->insert(key, value);
+        } else if constexpr (!std::is_same_v<T, std::monostate>) {
+            tree->insert(std::get<typename T::element_type::Key>(key), value);
+        }
+    }, tree_);
+}
+
+std::vector<NodeID> Index::find(const PropertyValue& key) const {
+    wait_until_built();
+    return find_in_tree(key);
+}
+
+std::vector<NodeID> Index::find_in_tree(const PropertyValue& key) const {
+    if (hash_) return hash_->find(key);
+    if (paged_) return paged_->find(key);
+    std::shared_lock lock(tree_mutex_);
+    return std::visit([&](const auto& tree) -> std::vector<NodeID> {
+        using T = std::decay_t<decltype(tree)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+            return {};
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<BPlusTree>>) {
+            return tree->find(key);
+        } else {
+            auto* typed = std::get_if<typename T::element_type::Key>(&key);
+            return typed ? tree->find(*typed) : std::vector<NodeID>{};
+        }
+    }, tree_);
+}
+
+void Index::apply_remove(const PropertyValue& key, NodeID value) {
+    if (hash_) {
+        hash_->remove(key, value);
+        return;
+    }
+    if (paged_) {
+        paged_->remove(key, value);
+        return;
+    }
+    {
+        std::shared_lock lock(tree_mutex_);
+        if (!generic()) {
+            remove_from_tree(key, value);
+            return;
+        }
+    }
+    std::unique_lock lock(tree_mutex_);
+    remove_from_tree(key, value);
+}
+
+void Index::remove_from_tree(const PropertyValue& key, NodeID value) {
+    std::visit([&](auto& tree) {
+        using T = std::decay_t<decltype(tree)>;
+        if constexpr (std::is_same_v<T, std::unique_ptr<BPlusTree>>) {
+            tree->remove(key, value);
+        } else if constexpr (!std::is_same_v<T, std::monostate>) {
+            if (auto* typed = std::get_if<typename T::element_type::Key>(&key)) tree->remove(*typed, value);
+        }
+    }, tree_);
+}
+
+void Index::make_typed(size_t type) {
+    switch (type) {
+        case 0: tree_ = std::make_unique<TypedBPlusTree<Int64KeyTraits>>(); break;
+        case 1: tree_ = std::make_unique<TypedBPlusTree<DoubleKeyTraits>>(); break;
+        case 2: tree_ = std::make_unique<TypedBPlusTree<StringKeyTraits>>(); break;
+        default: tree_ = std::make_unique<TypedBPlusTree<BoolKeyTraits>>(); break;
+    }
+}
+
+void Index::make_generic() {
+    auto generic = std::make_unique<BPlusTree>();
+    visit_scan([&generic](const auto& tree) {
+        tree.scan({}, [&generic](const PropertyValue& key, const std::vector<NodeID>& values) {
+            for (NodeID value : values) generic->insert(key, value);
+            return true;
+        });
+    });
+    tree_ = std::move(generic);
+}
+
+}
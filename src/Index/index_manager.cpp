@@ -1,12 +1,19 @@
 #include "../../include/graph_db/Index/index_manager.h"
+#include <stdexcept>
 
 namespace graph_db {
 
-void IndexManager::create_index(const std::string& property_key) {
+Index* IndexManager::create_index(const std::string& property_key, IndexKind kind) {
     std::unique_lock lock(mutex_);
-    if (indexes_.find(property_key) == indexes_.end()) {
-        indexes_[property_key] = std::make_unique<Index>();
+    auto& index = indexes_[property_key];
+    if (index) return nullptr;
+    try {
+        index = std::make_unique<Index>(true, kind, open_paged({property_key}, kind));
+    } catch (...) {
+        indexes_.erase(property_key);
+        throw;
     }
+    return index.get();
 }
 
 Index* IndexManager::get_index(const std::string& property_key) {
@@ -18,4 +25,103 @@ Index* IndexManager::get_index(const std::string& property_key) {
     return nullptr;
 }
 
-}
\ No newline at end of file
+CompositeIndex* IndexManager::create_composite_index(const std::vector<std::string>& property_keys,
+                                                   IndexKind kind) {
+    std::unique_lock lock(mutex_);
+    auto& index = composites_[property_keys];
+    if (index) return nullptr;
+    try {
+        index = std::make_unique<CompositeIndex>(property_keys, true, kind, open_paged(property_keys, kind));
+    } catch (...) {
+        composites_.erase(property_keys);
+        throw;
+    }
+    has_composites_.store(true, std::memory_order_release);
+    return index.get();
+}
+
+CompositeIndex* IndexManager::get_composite_index(const std::vector<std::string>& property_keys) {
+    std::shared_lock lock(mutex_);
+    auto it = composites_.find(property_keys);
+    return it != composites_.end() ? it->second.get() : nullptr;
+}
+
+std::vector<CompositeIndex*> IndexManager::composites_with(const std::string& property_key) {
+    std::vector<CompositeIndex*> result;
+    if (!has_composites_.load(std::memory_order_acquire)) return result;
+    std::shared_lock lock(mutex_);
+    for (const auto& [keys, index] : composites_) {
+        if (property_key.empty() || index->covers(property_key)) result.push_back(index.get());
+    }
+    return result;
+}
+
+void IndexManager::discard_build(const std::vector<std::string>& property_keys) {
+    std::unique_lock lock(mutex_);
+    Index* index = nullptr;
+    if (property_keys.size() == 1) {
+        auto it = indexes_.find(property_keys[0]);
+        if (it == indexes_.end()) return;
+        index = it->second.get();
+        retired_.push_back(std::move(it->second));
+        indexes_.erase(it);
+    } else {
+        auto it = composites_.find(property_keys);
+        if (it == composites_.end()) return;
+        index = &it->second->index();
+        retired_composites_.push_back(std::move(it->second));
+        composites_.erase(it);
+        has_composites_.store(!composites_.empty(), std::memory_order_release);
+    }
+    index->abandon_build();
+    if (index->kind() == IndexKind::Paged) store_->drop(store_name(property_keys));
+}
+
+std::string IndexManager::store_name(const std::vector<std::string>& property_keys) const {
+    // "scope\0key" for single keys, "scope\0k1\0k2..." for composites
+    std::string name = scope_;
+    for (const std::string& key : property_keys) {
+        name.push_back('\0');
+        name += key;
+    }
+    return name;
+}
+
+std::unique_ptr<PagedBPlusTree> IndexManager::open_paged(const std::vector<std::string>& property_keys,
+                                                         IndexKind kind) {
+    if (kind != IndexKind::Paged) return nullptr;
+    if (!store_) throw std::runtime_error("paged index: no index file is open");
+    return store_->open(store_name(property_keys));
+}
+
+bool IndexManager::attach_store(IndexStore* store, const std::string& scope) {
+    std::unique_lock lock(mutex_);
+    if (store_) throw std::runtime_error("index file: one is already attached");
+    std::string prefix = scope + '\0';
+    std::vector<std::vector<std::string>> stored;
+    for (const std::string& name : store->names()) {
+        if (name.compare(0, prefix.size(), prefix) != 0) continue;
+        std::vector<std::string> keys(1);
+        for (size_t i = prefix.size(); i < name.size(); ++i) {
+            if (name[i] == '\0') keys.emplace_back();
+            else keys.back().push_back(name[i]);
+        }
+        bool taken = keys.size() == 1 ? indexes_.count(keys[0]) > 0 : composites_.count(keys) > 0;
+        if (taken) throw std::runtime_error("index file: " + keys[0] + " is already indexed in memory");
+        stored.push_back(std::move(keys));
+    }
+    store_ = store;
+    scope_ = scope;
+    for (const std::vector<std::string>& keys : stored) {
+        auto tree = store->open(store_name(keys));
+        if (keys.size() == 1) {
+            indexes_[keys[0]] = std::make_unique<Index>(false, IndexKind::Paged, std::move(tree));
+        } else {
+            composites_[keys] = std::make_unique<CompositeIndex>(keys, false, IndexKind::Paged, std::move(tree));
+            has_composites_.store(true, std::memory_order_release);
+        }
+    }
+    return !stored.empty();
+}
+
+}
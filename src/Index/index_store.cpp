@@ -0,0 +1,105 @@
+#include "../../include/graph_db/Index/index_store.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace graph_db {
+
+namespace {
+
+constexpr PageID kCatalogPage = 0;
+constexpr uint32_t kCatalogMagic = 0x58444947; // "GIDX"
+
+// Catalog page: magic, entry count, then per entry a u16 name size, the name and the
+// tree's header page
+template <typename T>
+void put(char*& at, T value) {
+    std::memcpy(at, &value, sizeof(T));
+    at += sizeof(T);
+}
+template <typename T>
+T take(const char*& at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    at += sizeof(T);
+    return value;
+}
+
+} // namespace
+
+IndexStore::IndexStore(const std::string& path, size_t pool_pages, buffer::ReplacerKind replacer)
+    : disk_(path), pool_(pool_pages, &disk_, buffer::PartitionedBufferPool::default_instances(pool_pages), replacer) {
+    if (disk_.num_pages() == 0) {
+        PageID id;
+        if (!pool_.new_page(&id)) throw std::runtime_error("index file: buffer pool has no frames");
+        pool_.unpin_page(id, false);
+        write_catalog();
+        return;
+    }
+    Page* page = pool_.fetch_page(kCatalogPage);
+    if (!page) throw std::runtime_error("index file: buffer pool has no frames");
+    const char* at = page->data_;
+    const char* end = page->data_ + sizeof(page->data_);
+    bool valid = take<uint32_t>(at) == kCatalogMagic;
+    for (uint32_t n = valid ? take<uint32_t>(at) : 0; valid && n > 0; --n) {
+        valid = end - at >= static_cast<std::ptrdiff_t>(sizeof(uint16_t));
+        uint16_t size = valid ? take<uint16_t>(at) : 0;
+        valid = valid && end - at >= static_cast<std::ptrdiff_t>(size + sizeof(PageID));
+        if (!valid) break;
+        std::string name(at, size);
+        at += size;
+        catalog_[name] = take<PageID>(at);
+    }
+    pool_.unpin_page(kCatalogPage, false);
+    if (!valid) throw std::runtime_error("index file: " + path + " is not an index file");
+}
+
+void IndexStore::write_catalog() {
+    size_t size = 2 * sizeof(uint32_t);
+    for (const auto& [name, header] : catalog_) size += sizeof(uint16_t) + name.size() + sizeof(PageID);
+    if (size > sizeof(Page::data_)) throw std::runtime_error("index file: catalog is full");
+    Page* page = pool_.fetch_page(kCatalogPage);
+    if (!page) throw std::runtime_error("index file: every buffer pool frame is pinned");
+    char* at = page->data_;
+    put<uint32_t>(at, kCatalogMagic);
+    put<uint32_t>(at, static_cast<uint32_t>(catalog_.size()));
+    for (const auto& [name, header] : catalog_) {
+        put<uint16_t>(at, static_cast<uint16_t>(name.size()));
+        std::memcpy(at, name.data(), name.size());
+        at += name.size();
+        put<PageID>(at, header);
+    }
+    pool_.unpin_page(kCatalogPage, true);
+}
+
+std::unique_ptr<PagedBPlusTree> IndexStore::open(const std::string& name) {
+    std::lock_guard lock(mutex_);
+    auto it = catalog_.find(name);
+    if (it != catalog_.end()) return std::make_unique<PagedBPlusTree>(pool_, it->second);
+    auto tree = std::make_unique<PagedBPlusTree>(pool_);
+    catalog_[name] = tree->header_page();
+    try {
+        write_catalog();
+    } catch (...) {
+        catalog_.erase(name);
+        throw;
+    }
+    return tree;
+}
+
+std::vector<std::string> IndexStore::names() const {
+    std::lock_guard lock(mutex_);
+    std::vector<std::string> result;
+    for (const auto& [name, header] : catalog_) result.push_back(name);
+    return result;
+}
+
+void IndexStore::drop(const std::string& name) {
+    std::lock_guard lock(mutex_);
+    if (catalog_.erase(name)) write_catalog();
+}
+
+void IndexStore::flush() {
+    pool_.flush_all_pages();
+}
+
+}
@@ -0,0 +1,692 @@
+#include "../../include/graph_db/Index/paged_b_plus_tree.h"
+#include "../../include/graph_db/Index/composite_index.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace graph_db {
+
+namespace {
+
+constexpr size_t kPageSize = sizeof(Page::data_);
+
+enum PageType : uint8_t { kHeaderPage = 1, kLeafPage, kInnerPage, kOverflowPage, kFreePage };
+
+struct TreeHeader {
+    uint8_t type;
+    uint8_t unused[3];
+    PageID root;
+    PageID free_list;
+    uint32_t reserved;
+    uint64_t keys;
+};
+
+// Leaf and inner pages. Slots follow the header; cells fill [heap, kPageSize).
+struct NodeHeader {
+    uint8_t type;
+    uint8_t unused;
+    uint16_t count;     // slots
+    uint16_t heap;      // start of the cell area
+    uint16_t garbage;   // bytes of dead cells inside the cell area
+    PageID prev;        // siblings on the same level
+    PageID next;
+    PageID first_child; // inner pages: child for keys below the first separator
+};
+
+// Overflow pages, and free pages on the free list
+struct ChainHeader {
+    uint8_t type;
+    uint8_t unused;
+    uint16_t used; // payload bytes
+    PageID next;
+};
+
+constexpr size_t kSlots = sizeof(NodeHeader);
+constexpr size_t kChainCapacity = kPageSize - sizeof(ChainHeader);
+static_assert(kChainCapacity % sizeof(NodeID) == 0, "ID chains pack whole IDs");
+// Key head flag: the key continues in overflow pages
+constexpr uint16_t kSpills = 0x8000;
+// Posting count flag: the IDs live in an overflow chain
+constexpr uint32_t kChained = 0x80000000;
+// Sorts after every encoded key, since those start with a type tag
+const std::string kAfterKeys(1, static_cast<char>(std::variant_size_v<PropertyValue>));
+
+template <typename T>
+T load(const char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+template <typename T>
+void store(char* at, T value) {
+    std::memcpy(at, &value, sizeof(T));
+}
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+NodeHeader& node(char* page) { return *reinterpret_cast<NodeHeader*>(page); }
+const NodeHeader& node(const char* page) { return *reinterpret_cast<const NodeHeader*>(page); }
+ChainHeader& chain(char* page) { return *reinterpret_cast<ChainHeader*>(page); }
+const ChainHeader& chain(const char* page) { return *reinterpret_cast<const ChainHeader*>(page); }
+bool is_leaf(const char* page) { return node(page).type == kLeafPage; }
+
+const char* cell_at(const char* page, size_t slot) {
+    return page + load<uint16_t>(page + kSlots + slot * sizeof(uint16_t));
+}
+char* cell_at(char* page, size_t slot) {
+    return page + load<uint16_t>(page + kSlots + slot * sizeof(uint16_t));
+}
+
+// Cell key: u16 inline size (| kSpills), [u32 full size, overflow PageID], inline bytes.
+// Leaf cells go on with u32 count (| kChained), then the IDs or the chain's first and
+// last page; inner cells with the child's PageID.
+struct KeyHead {
+    const char* bytes; // inline part
+    size_t inline_size;
+    size_t full_size;
+    bool spills;
+    PageID overflow;
+    size_t end; // offset of the value part
+};
+
+KeyHead key_head(const char* cell) {
+    uint16_t head = load<uint16_t>(cell);
+    KeyHead key{};
+    key.inline_size = head & ~kSpills;
+    key.full_size = key.inline_size;
+    key.spills = head & kSpills;
+    size_t at = sizeof(uint16_t);
+    if (key.spills) {
+        key.full_size = load<uint32_t>(cell + at);
+        key.overflow = load<PageID>(cell + at + sizeof(uint32_t));
+        at += sizeof(uint32_t) + sizeof(PageID);
+    }
+    key.bytes = cell + at;
+    key.end = at + key.inline_size;
+    return key;
+}
+
+size_t cell_size(const char* cell, bool leaf) {
+    size_t size = key_head(cell).end;
+    if (!leaf) return size + sizeof(PageID);
+    uint32_t count = load<uint32_t>(cell + size);
+    size += sizeof(uint32_t);
+    return size + (count & kChained ? 2 * sizeof(PageID) : count * sizeof(NodeID));
+}
+
+PageID child_of(const char* cell) { return load<PageID>(cell + key_head(cell).end); }
+
+size_t free_space(const char* page) {
+    const NodeHeader& header = node(page);
+    return header.heap - kSlots - header.count * sizeof(uint16_t);
+}
+
+// Caller checked free_space
+void place(char* page, size_t pos, const std::string& cell) {
+    NodeHeader& header = node(page);
+    header.heap -= cell.size();
+    std::memcpy(page + header.heap, cell.data(), cell.size());
+    char* slots = page + kSlots;
+    std::memmove(slots + (pos + 1) * sizeof(uint16_t), slots + pos * sizeof(uint16_t),
+                 (header.count - pos) * sizeof(uint16_t));
+    store<uint16_t>(slots + pos * sizeof(uint16_t), header.heap);
+    ++header.count;
+}
+
+void erase_slot(char* page, size_t pos) {
+    NodeHeader& header = node(page);
+    header.garbage += cell_size(cell_at(page, pos), is_leaf(page));
+    char* slots = page + kSlots;
+    std::memmove(slots + pos * sizeof(uint16_t), slots + (pos + 1) * sizeof(uint16_t),
+                 (header.count - pos - 1) * sizeof(uint16_t));
+    --header.count;
+}
+
+std::vector<std::string> cells_of(const char* page) {
+    std::vector<std::string> cells;
+    cells.reserve(node(page).count);
+    for (size_t i = 0; i < node(page).count; ++i) {
+        const char* cell = cell_at(page, i);
+        cells.emplace_back(cell, cell_size(cell, is_leaf(page)));
+    }
+    return cells;
+}
+
+// Replaces the page's cells with [first, last); the header links stay
+void fill(char* page, const std::string* first, const std::string* last) {
+    NodeHeader& header = node(page);
+    header.count = 0;
+    header.heap = kPageSize;
+    header.garbage = 0;
+    for (; first != last; ++first) place(page, header.count, *first);
+}
+
+void compact(char* page) {
+    std::vector<std::string> cells = cells_of(page);
+    fill(page, cells.data(), cells.data() + cells.size());
+}
+
+} // namespace
+
+PagedBPlusTree::PagedBPlusTree(buffer::BufferPool& pool, PageID header)
+    : pool_(pool), header_(header), root_(kInvalidPageID), free_list_(kInvalidPageID) {
+    if (header_ != kInvalidPageID) {
+        PageGuard page(pool_, header_);
+        const TreeHeader& stored = *reinterpret_cast<const TreeHeader*>(page.data());
+        if (stored.type != kHeaderPage) {
+            throw std::runtime_error("paged index: page " + std::to_string(header_) + " is not a tree header");
+        }
+        root_ = stored.root;
+        free_list_ = stored.free_list;
+        keys_ = stored.keys;
+        return;
+    }
+    header_ = allocate(kHeaderPage).id();
+    root_ = allocate(kLeafPage).id();
+    header_dirty_ = true;
+    sync_header();
+}
+
+void PagedBPlusTree::sync_header() {
+    if (!header_dirty_) return;
+    PageGuard page(pool_, header_);
+    TreeHeader& stored = *reinterpret_cast<TreeHeader*>(page.write());
+    stored.type = kHeaderPage;
+    stored.root = root_;
+    stored.free_list = free_list_;
+    stored.keys = keys_;
+    header_dirty_ = false;
+}
+
+PagedBPlusTree::PageGuard PagedBPlusTree::allocate(uint8_t type) {
+    PageGuard page;
+    if (free_list_ != kInvalidPageID) {
+        page = PageGuard(pool_, free_list_);
+        free_list_ = chain(page.data()).next;
+        header_dirty_ = true;
+    } else {
+        PageID id;
+        Page* fresh = pool_.new_page(&id);
+        page = PageGuard(pool_, id, fresh);
+    }
+    char* data = page.write();
+    std::memset(data, 0, kPageSize);
+    if (type == kLeafPage || type == kInnerPage) {
+        NodeHeader& header = node(data);
+        header.type = type;
+        header.heap = kPageSize;
+        header.prev = header.next = header.first_child = kInvalidPageID;
+    } else {
+        chain(data).type = type;
+        chain(data).next = kInvalidPageID;
+    }
+    return page;
+}
+
+void PagedBPlusTree::free_page(PageID id) {
+    PageGuard page(pool_, id);
+    ChainHeader& header = chain(page.write());
+    header.type = kFreePage;
+    header.used = 0;
+    header.next = free_list_;
+    free_list_ = id;
+    header_dirty_ = true;
+}
+
+std::pair<PageID, PageID> PagedBPlusTree::write_chain(const char* bytes, size_t size) {
+    PageID head = kInvalidPageID;
+    PageGuard last;
+    size_t done = 0;
+    do {
+        PageGuard page = allocate(kOverflowPage);
+        char* data = page.write();
+        size_t n = std::min(kChainCapacity, size - done);
+        std::memcpy(data + sizeof(ChainHeader), bytes + done, n);
+        chain(data).used = static_cast<uint16_t>(n);
+        if (last) chain(last.write()).next = page.id();
+        else head = page.id();
+        last = std::move(page);
+        done += n;
+    } while (done < size);
+    return {head, last.id()};
+}
+
+void PagedBPlusTree::read_chain(PageID id, std::string& out) const {
+    while (id != kInvalidPageID) {
+        PageGuard page(pool_, id);
+        const ChainHeader& header = chain(page.data());
+        out.append(page.data() + sizeof(ChainHeader), header.used);
+        id = header.next;
+    }
+}
+
+void PagedBPlusTree::free_chain(PageID id) {
+    while (id != kInvalidPageID) {
+        PageID next = chain(PageGuard(pool_, id).data()).next;
+        free_page(id);
+        id = next;
+    }
+}
+
+std::string PagedBPlusTree::make_key(const std::string& key) {
+    std::string cell;
+    if (key.size() <= kInlineKey) {
+        put<uint16_t>(cell, static_cast<uint16_t>(key.size()));
+        cell += key;
+        return cell;
+    }
+    PageID overflow = write_chain(key.data() + kInlineKey, key.size() - kInlineKey).first;
+    put<uint16_t>(cell, static_cast<uint16_t>(kInlineKey) | kSpills);
+    put<uint32_t>(cell, static_cast<uint32_t>(key.size()));
+    put<PageID>(cell, overflow);
+    cell.append(key, 0, kInlineKey);
+    return cell;
+}
+
+std::string PagedBPlusTree::read_key(const char* cell) const {
+    KeyHead key = key_head(cell);
+    std::string out(key.bytes, key.inline_size);
+    if (key.spills) read_chain(key.overflow, out);
+    return out;
+}
+
+int PagedBPlusTree::compare(const char* cell, const std::string& key) const {
+    KeyHead head = key_head(cell);
+    int c = std::memcmp(head.bytes, key.data(), std::min(head.inline_size, key.size()));
+    if (c != 0) return c;
+    // Only a spilled key that matches all of its inline part needs its overflow pages
+    if (head.spills && key.size() > head.inline_size) return read_key(cell).compare(key);
+    return head.full_size < key.size() ? -1 : head.full_size > key.size() ? 1 : 0;
+}
+
+bool PagedBPlusTree::has_prefix(const char* cell, const std::string& prefix) const {
+    KeyHead head = key_head(cell);
+    if (head.full_size < prefix.size()) return false;
+    if (head.inline_size >= prefix.size()) return std::memcmp(head.bytes, prefix.data(), prefix.size()) == 0;
+    return read_key(cell).compare(0, prefix.size(), prefix) == 0;
+}
+
+size_t PagedBPlusTree::lower_bound(const char* page, const std::string& key) const {
+    size_t lo = 0, hi = node(page).count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compare(cell_at(page, mid), key) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t PagedBPlusTree::upper_bound(const char* page, const std::string& key) const {
+    size_t lo = 0, hi = node(page).count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compare(cell_at(page, mid), key) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+PagedBPlusTree::PageGuard PagedBPlusTree::find_leaf(const std::string& key, std::vector<PageID>* path) const {
+    PageGuard page(pool_, root_);
+    while (!is_leaf(page.data())) {
+        if (path) path->push_back(page.id());
+        // Separators are the smallest keys of their child
+        size_t pos = upper_bound(page.data(), key);
+        PageID child = pos == 0 ? node(page.data()).first_child : child_of(cell_at(page.data(), pos - 1));
+        page = PageGuard(pool_, child);
+    }
+    return page;
+}
+
+void PagedBPlusTree::insert(const PropertyValue& key, NodeID value) {
+    std::string encoded;
+    CompositeIndex::append(encoded, key);
+    std::unique_lock lock(mutex_);
+    std::vector<PageID> path;
+    PageGuard leaf = find_leaf(encoded, &path);
+    size_t pos = lower_bound(leaf.data(), encoded);
+    if (pos < node(leaf.data()).count && compare(cell_at(leaf.data(), pos), encoded) == 0) {
+        const char* found = cell_at(leaf.data(), pos);
+        std::string cell(found, cell_size(found, true));
+        append_id(cell, value);
+        replace_cell(std::move(leaf), pos, std::move(cell), path);
+    } else {
+        std::string cell = make_key(encoded);
+        put<uint32_t>(cell, 1);
+        put<NodeID>(cell, value);
+        ++keys_;
+        header_dirty_ = true;
+        insert_cell(std::move(leaf), pos, std::move(cell), path);
+    }
+    sync_header();
+}
+
+void PagedBPlusTree::remove(const PropertyValue& key, NodeID value) {
+    std::string encoded;
+    CompositeIndex::append(encoded, key);
+    std::unique_lock lock(mutex_);
+    std::vector<PageID> path;
+    PageGuard leaf = find_leaf(encoded, &path);
+    size_t pos = lower_bound(leaf.data(), encoded);
+    if (pos == node(leaf.data()).count || compare(cell_at(leaf.data(), pos), encoded) != 0) return;
+    const char* found = cell_at(leaf.data(), pos);
+    std::string cell(found, cell_size(found, true));
+    if (!remove_id(cell, value)) return;
+    KeyHead head = key_head(cell.data());
+    if (load<uint32_t>(cell.data() + head.end) == 0) {
+        if (head.spills) free_chain(head.overflow);
+        erase_slot(leaf.write(), pos);
+        --keys_;
+        header_dirty_ = true;
+    } else {
+        replace_cell(std::move(leaf), pos, std::move(cell), path);
+    }
+    sync_header();
+}
+
+void PagedBPlusTree::replace_cell(PageGuard page, size_t pos, std::string cell, std::vector<PageID>& path) {
+    char* data = page.write();
+    char* old = cell_at(data, pos);
+    size_t old_size = cell_size(old, is_leaf(data));
+    if (cell.size() <= old_size) {
+        std::memcpy(old, cell.data(), cell.size());
+        node(data).garbage += old_size - cell.size();
+        return;
+    }
+    erase_slot(data, pos);
+    insert_cell(std::move(page), pos, std::move(cell), path);
+}
+
+void PagedBPlusTree::insert_cell(PageGuard page, size_t pos, std::string cell, std::vector<PageID>& path) {
+    for (;;) {
+        char* data = page.write();
+        size_t needed = cell.size() + sizeof(uint16_t);
+        if (free_space(data) < needed && free_space(data) + node(data).garbage >= needed) compact(data);
+        if (free_space(data) >= needed) {
+            place(data, pos, cell);
+            return;
+        }
+        Split halves = split(page, pos, cell);
+        PageID left = page.id();
+        page.release();
+        cell = std::move(halves.key_cell);
+        put<PageID>(cell, halves.right);
+        if (path.empty()) {
+            PageGuard root = allocate(kInnerPage);
+            node(root.write()).first_child = left;
+            place(root.write(), 0, cell);
+            root_ = root.id();
+            header_dirty_ = true;
+            return;
+        }
+        page = PageGuard(pool_, path.back());
+        path.pop_back();
+        pos = lower_bound(page.data(), halves.separator);
+    }
+}
+
+PagedBPlusTree::Split PagedBPlusTree::split(PageGuard& page, size_t pos, const std::string& cell) {
+    char* data = page.write();
+    bool leaf = is_leaf(data);
+    std::vector<std::string> cells = cells_of(data);
+    // Appending at the right edge (sequential inserts, bulk loads) keeps the left page full
+    bool append = pos == cells.size() && node(data).next == kInvalidPageID;
+    cells.insert(cells.begin() + pos, cell);
+    size_t mid = cells.size() - 1;
+    if (!append) {
+        size_t total = 0;
+        for (const std::string& c : cells) total += c.size();
+        size_t bytes = 0;
+        mid = 0;
+        while (bytes * 2 < total) bytes += cells[mid++].size();
+        mid = std::clamp<size_t>(mid, 1, cells.size() - 1);
+    }
+
+    PageGuard right = allocate(leaf ? kLeafPage : kInnerPage);
+    char* other = right.write();
+    const std::string* first = cells.data();
+    Split result;
+    result.right = right.id();
+    if (leaf) {
+        fill(data, first, first + mid);
+        fill(other, first + mid, first + cells.size());
+        // Shortest key above the left half that is still <= the right half
+        std::string low = read_key(cells[mid - 1].data());
+        std::string high = read_key(cells[mid].data());
+        size_t common = std::mismatch(low.begin(), low.end(), high.begin(), high.end()).first - low.begin();
+        result.separator = high.substr(0, common + 1);
+        result.key_cell = make_key(result.separator);
+    } else {
+        // The middle separator moves up; its child starts the right page
+        const std::string& middle = cells[mid];
+        fill(data, first, first + mid);
+        fill(other, first + mid + 1, first + cells.size());
+        node(other).first_child = child_of(middle.data());
+        result.separator = read_key(middle.data());
+        result.key_cell = middle.substr(0, key_head(middle.data()).end);
+    }
+
+    NodeHeader& header = node(data);
+    node(other).prev = page.id();
+    node(other).next = header.next;
+    if (header.next != kInvalidPageID) node(PageGuard(pool_, header.next).write()).prev = right.id();
+    header.next = right.id();
+    return result;
+}
+
+void PagedBPlusTree::append_id(std::string& cell, NodeID value) {
+    size_t at = key_head(cell.data()).end;
+    uint32_t count = load<uint32_t>(cell.data() + at);
+    if (!(count & kChained)) {
+        if (count < kInlineIds) {
+            put<NodeID>(cell, value);
+            store<uint32_t>(cell.data() + at, count + 1);
+            return;
+        }
+        // Too long for the cell: move the list to a chain
+        std::string ids = cell.substr(at + sizeof(uint32_t));
+        put<NodeID>(ids, value);
+        auto [head, tail] = write_chain(ids.data(), ids.size());
+        cell.resize(at);
+        put<uint32_t>(cell, (count + 1) | kChained);
+        put<PageID>(cell, head);
+        put<PageID>(cell, tail);
+        return;
+    }
+    char* tail_at = cell.data() + at + sizeof(uint32_t) + sizeof(PageID);
+    PageGuard tail(pool_, load<PageID>(tail_at));
+    if (chain(tail.data()).used + sizeof(NodeID) > kChainCapacity) {
+        PageGuard next = allocate(kOverflowPage);
+        chain(tail.write()).next = next.id();
+        store<PageID>(tail_at, next.id());
+        tail = std::move(next);
+    }
+    char* data = tail.write();
+    store<NodeID>(data + sizeof(ChainHeader) + chain(data).used, value);
+    chain(data).used += sizeof(NodeID);
+    store<uint32_t>(cell.data() + at, (count + 1) | kChained);
+}
+
+bool PagedBPlusTree::remove_id(std::string& cell, NodeID value) {
+    size_t at = key_head(cell.data()).end;
+    uint32_t count = load<uint32_t>(cell.data() + at);
+    size_t ids_at = at + sizeof(uint32_t);
+    if (!(count & kChained)) {
+        for (size_t i = 0; i < count; ++i) {
+            if (load<NodeID>(cell.data() + ids_at + i * sizeof(NodeID)) != value) continue;
+            cell.erase(ids_at + i * sizeof(NodeID), sizeof(NodeID));
+            store<uint32_t>(cell.data() + at, count - 1);
+            return true;
+        }
+        return false;
+    }
+
+    count &= ~kChained;
+    PageID head = load<PageID>(cell.data() + ids_at);
+    PageID tail = load<PageID>(cell.data() + ids_at + sizeof(PageID));
+    PageGuard previous;
+    bool found = false;
+    for (PageID id = head; id != kInvalidPageID && !found;) {
+        PageGuard page(pool_, id);
+        const ChainHeader& header = chain(page.data());
+        PageID next = header.next;
+        size_t used = header.used;
+        size_t i = 0;
+        while (i < used && load<NodeID>(page.data() + sizeof(ChainHeader) + i) != value) i += sizeof(NodeID);
+        if (i == used) {
+            previous = std::move(page);
+            id = next;
+            continue;
+        }
+        found = true;
+        char* ids = page.write() + sizeof(ChainHeader);
+        std::memmove(ids + i, ids + i + sizeof(NodeID), used - i - sizeof(NodeID));
+        chain(page.write()).used -= sizeof(NodeID);
+        if (used == sizeof(NodeID)) {
+            // Unlink the emptied page
+            if (previous) chain(previous.write()).next = next;
+            else head = next;
+            if (tail == id) tail = previous ? previous.id() : kInvalidPageID;
+            page.release();
+            free_page(id);
+        }
+    }
+    if (!found) return false;
+    --count;
+    cell.resize(ids_at);
+    if (count <= kUnchainAt) {
+        std::string ids;
+        read_chain(head, ids);
+        free_chain(head);
+        store<uint32_t>(cell.data() + at, count);
+        cell += ids;
+        return true;
+    }
+    store<uint32_t>(cell.data() + at, count | kChained);
+    put<PageID>(cell, head);
+    put<PageID>(cell, tail);
+    return true;
+}
+
+bool PagedBPlusTree::read_ids(const char* cell, size_t limit, std::vector<NodeID>& out) const {
+    auto take = [&](const char* ids, size_t count) {
+        if (limit) count = std::min(count, limit - out.size());
+        for (size_t i = 0; i < count; ++i) out.push_back(load<NodeID>(ids + i * sizeof(NodeID)));
+    };
+    size_t at = key_head(cell).end;
+    uint32_t count = load<uint32_t>(cell + at);
+    const char* ids = cell + at + sizeof(uint32_t);
+    if (!(count & kChained)) {
+        take(ids, count);
+    } else {
+        for (PageID id = load<PageID>(ids); id != kInvalidPageID && (!limit || out.size() < limit);) {
+            PageGuard page(pool_, id);
+            const ChainHeader& header = chain(page.data());
+            take(page.data() + sizeof(ChainHeader), header.used / sizeof(NodeID));
+            id = header.next;
+        }
+    }
+    return !limit || out.size() < limit;
+}
+
+void PagedBPlusTree::walk(const std::string& from, bool inclusive, bool descending,
+                          const std::function<bool(const char*)>& fn) const {
+    PageGuard page = find_leaf(from, nullptr);
+    if (!descending) {
+        size_t pos = inclusive ? lower_bound(page.data(), from) : upper_bound(page.data(), from);
+        for (;;) {
+            for (; pos < node(page.data()).count; ++pos) {
+                if (!fn(cell_at(page.data(), pos))) return;
+            }
+            PageID next = node(page.data()).next;
+            if (next == kInvalidPageID) return;
+            page = PageGuard(pool_, next);
+            pos = 0;
+        }
+    }
+    size_t pos = inclusive ? upper_bound(page.data(), from) : lower_bound(page.data(), from);
+    for (;;) {
+        while (pos > 0) {
+            if (!fn(cell_at(page.data(), --pos))) return;
+        }
+        PageID prev = node(page.data()).prev;
+        if (prev == kInvalidPageID) return;
+        page = PageGuard(pool_, prev);
+        pos = node(page.data()).count;
+    }
+}
+
+std::vector<NodeID> PagedBPlusTree::find(const PropertyValue& key) const {
+    std::string encoded;
+    CompositeIndex::append(encoded, key);
+    std::shared_lock lock(mutex_);
+    std::vector<NodeID> result;
+    PageGuard leaf = find_leaf(encoded, nullptr);
+    size_t pos = lower_bound(leaf.data(), encoded);
+    if (pos < node(leaf.data()).count && compare(cell_at(leaf.data(), pos), encoded) == 0) {
+        read_ids(cell_at(leaf.data(), pos), 0, result);
+    }
+    return result;
+}
+
+std::vector<NodeID> PagedBPlusTree::range(const RangeScan& scan) const {
+    if (scan.lower && scan.upper && scan.lower->value.index() != scan.upper->value.index()) {
+        throw std::runtime_error("range scan: bounds must have the same type");
+    }
+    // [low, high] in encoded keys; a single bound stops at the edge of its type's run
+    std::string low, high = kAfterKeys;
+    bool low_inclusive = true, high_inclusive = false;
+    if (scan.lower || scan.upper) {
+        char type = static_cast<char>((scan.lower ? scan.lower->value : scan.upper->value).index());
+        low.assign(1, type);
+        high.assign(1, static_cast<char>(type + 1));
+    }
+    if (scan.lower) {
+        low.clear();
+        CompositeIndex::append(low, scan.lower->value);
+        low_inclusive = scan.lower->inclusive;
+    }
+    if (scan.upper) {
+        high.clear();
+        CompositeIndex::append(high, scan.upper->value);
+        high_inclusive = scan.upper->inclusive;
+    }
+
+    std::shared_lock lock(mutex_);
+    std::vector<NodeID> result;
+    if (!scan.descending) {
+        walk(low, low_inclusive, false, [&](const char* cell) {
+            int c = compare(cell, high);
+            return (c < 0 || (c == 0 && high_inclusive)) && read_ids(cell, scan.limit, result);
+        });
+    } else {
+        walk(high, high_inclusive, true, [&](const char* cell) {
+            int c = compare(cell, low);
+            return (c > 0 || (c == 0 && low_inclusive)) && read_ids(cell, scan.limit, result);
+        });
+    }
+    return result;
+}
+
+std::vector<NodeID> PagedBPlusTree::prefix(const std::string& prefix, size_t limit) const {
+    // The encoded string without its terminator prefixes exactly the strings extending it
+    std::string encoded;
+    CompositeIndex::append(encoded, prefix);
+    encoded.resize(encoded.size() - 2);
+    std::shared_lock lock(mutex_);
+    std::vector<NodeID> result;
+    walk(encoded, true, false, [&](const char* cell) {
+        return has_prefix(cell, encoded) && read_ids(cell, limit, result);
+    });
+    return result;
+}
+
+size_t PagedBPlusTree::size() const {
+    std::shared_lock lock(mutex_);
+    return keys_;
+}
+
+}
@@ -1,13 +1,17 @@
 #include "../../include/graph_db/buffer/buffer_pool_manager.h"
+#include <exception>
 #include <stdexcept>
+#include <string>
 
 namespace graph_db {
 namespace buffer {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, storage::DiskManager* disk_manager)
-    : disk_manager_(disk_manager), replacer_(pool_size) { // The 'pool_size_(pool_size)' part is removed here
+BufferPoolManager::BufferPoolManager(size_t pool_size, storage::DiskManager* disk_manager,
+                                     ReplacerKind replacer)
+    : disk_manager_(disk_manager), replacer_(make_replacer(replacer, pool_size)), frames_(new Frame[pool_size]) {
     pages_ = new Page[pool_size];
     for (size_t i = 0; i < pool_size; ++i) {
+        pages_[i].page_id_ = kInvalidPageID;
         free_list_.push_back(&pages_[i]);
     }
 }
@@ -17,36 +21,89 @@ BufferPoolManager::~BufferPoolManager() {
 }
 
 Page* BufferPoolManager::fetch_page(PageID page_id) {
-    std::lock_guard<std::mutex> lock(latch_);
-    if (page_table_.count(page_id)) {
-        FrameID frame_id = page_table_[page_id];
-        pages_[frame_id].pin_count_++;
-        replacer_.pin(frame_id);
-        return &pages_[frame_id];
+    std::unique_lock lock(latch_);
+    for (;;) {
+        auto hit = page_table_.find(page_id);
+        if (hit != page_table_.end()) {
+            FrameID frame_id = hit->second;
+            Page& page = pages_[frame_id];
+            Frame& frame = frames_[frame_id];
+            page.pin_count_++;
+            replacer_->pin(frame_id);
+            replacer_->record_access(frame_id, page_id);
+            ++hits_;
+            if (!frame.loading) return &page;
+            // Pinned, the frame cannot be reused while this thread waits for the read
+            lock.unlock();
+            { std::lock_guard io(frame.io); }
+            lock.lock();
+            if (!frame.failed) return &page;
+            if (--page.pin_count_ == 0) release_frame(frame_id);
+            throw std::runtime_error("buffer pool: reading page " + std::to_string(page_id) + " failed");
+        }
+        if (!writing_.count(page_id)) break;
+        // The disk copy is stale until the write-back lands. The frame already holds
+        // another page and may be evicted again, so this waits on the latch, not on it.
+        written_.wait(lock, [&]() { return !writing_.count(page_id); });
     }
 
     FrameID frame_id;
     if (!free_list_.empty()) {
         frame_id = free_list_.front() - pages_;
         free_list_.pop_front();
-    } else if (replacer_.victim(&frame_id)) {
-        Page& victim = pages_[frame_id];
-        if (victim.is_dirty_) {
-            disk_manager_->write_page(victim.page_id_, victim.data_);
-        }
-        page_table_.erase(victim.page_id_);
-    } else {
+    } else if (!replacer_->victim(&frame_id)) {
         return nullptr; // No frame available
     }
-
-    Page& new_page = pages_[frame_id];
-    new_page.page_id_ = page_id;
-    new_page.pin_count_ = 1;
-    new_page.is_dirty_ = false;
-    disk_manager_->read_page(page_id, new_page.data_);
+    Page& page = pages_[frame_id];
+    Frame& frame = frames_[frame_id];
+    // Unpinned and idle, so nobody else holds or waits for its latch; try_lock says so
+    // without ordering it after latch_
+    if (!frame.io.try_lock()) throw std::logic_error("buffer pool: victim frame is doing I/O");
+    PageID victim = page.page_id_;
+    bool write_back = victim != kInvalidPageID && page.is_dirty_;
+    if (victim != kInvalidPageID) page_table_.erase(victim);
+    if (write_back) writing_[victim] = frame_id;
+    page.page_id_ = page_id;
+    page.pin_count_ = 1;
+    page.is_dirty_ = false;
+    frame.loading = true;
     page_table_[page_id] = frame_id;
-    replacer_.pin(frame_id);
-    return &new_page;
+    replacer_->pin(frame_id);
+    replacer_->record_access(frame_id, page_id);
+    ++misses_;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+        if (write_back) disk_manager_->write_page(victim, page.data_);
+        disk_manager_->read_page(page_id, page.data_);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    lock.lock();
+    if (write_back) {
+        writing_.erase(victim);
+        written_.notify_all();
+    }
+    frame.loading = false;
+    // Idle again before the frame can go back on the free list, where a fetch expects
+    // to find its latch free
+    frame.io.unlock();
+    if (error) {
+        frame.failed = true;
+        page_table_.erase(page_id);
+        if (--page.pin_count_ == 0) release_frame(frame_id);
+    }
+    lock.unlock();
+    if (error) std::rethrow_exception(error);
+    return &page;
+}
+
+void BufferPoolManager::release_frame(FrameID frame_id) {
+    frames_[frame_id].failed = false;
+    pages_[frame_id].page_id_ = kInvalidPageID;
+    free_list_.push_back(&pages_[frame_id]);
 }
 
 bool BufferPoolManager::unpin_page(PageID page_id, bool is_dirty) {
@@ -64,37 +121,76 @@ bool BufferPoolManager::unpin_page(PageID page_id, bool is_dirty) {
         page.is_dirty_ = true;
     }
     if (page.pin_count_ == 0) {
-        replacer_.unpin(frame_id);
+        replacer_->unpin(frame_id);
     }
     return true;
 }
 
 bool BufferPoolManager::flush_page(PageID page_id) {
-    std::lock_guard<std::mutex> lock(latch_);
-    if (!page_table_.count(page_id)) {
+    std::unique_lock lock(latch_);
+    auto it = page_table_.find(page_id);
+    if (it == page_table_.end()) {
         return false;
     }
-    FrameID frame_id = page_table_[page_id];
-    Page& page = pages_[frame_id];
-    if (page.is_dirty_) {
-        disk_manager_->write_page(page.page_id_, page.data_);
-        page.is_dirty_ = false;
-    }
+    // A frame still loading is clean
+    if (pages_[it->second].is_dirty_) write_out(lock, {it->second});
     return true;
 }
 
 void BufferPoolManager::flush_all_pages() {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::unique_lock lock(latch_);
+    std::vector<FrameID> dirty;
     for (auto const& [page_id, frame_id] : page_table_) {
-        flush_page(page_id);
+        if (pages_[frame_id].is_dirty_) dirty.push_back(frame_id);
+    }
+    if (!dirty.empty()) write_out(lock, dirty);
+}
+
+void BufferPoolManager::write_out(std::unique_lock<std::mutex>& lock, const std::vector<FrameID>& frame_ids) {
+    // Pinned, the frames keep their pages while the latch is released for the writes
+    std::vector<PageID> page_ids;
+    page_ids.reserve(frame_ids.size());
+    for (FrameID frame_id : frame_ids) {
+        Page& page = pages_[frame_id];
+        page.pin_count_++;
+        replacer_->pin(frame_id);
+        page.is_dirty_ = false;
+        page_ids.push_back(page.page_id_);
+    }
+    lock.unlock();
+
+    std::exception_ptr error;
+    size_t written = 0;
+    try {
+        for (; written < frame_ids.size(); ++written) {
+            disk_manager_->write_page(page_ids[written], pages_[frame_ids[written]].data_);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    lock.lock();
+    for (size_t i = 0; i < frame_ids.size(); ++i) {
+        Page& page = pages_[frame_ids[i]];
+        if (i >= written) page.is_dirty_ = true;
+        if (--page.pin_count_ == 0) replacer_->unpin(frame_ids[i]);
     }
+    if (error) std::rethrow_exception(error);
+}
+
+uint64_t BufferPoolManager::hits() {
+    std::lock_guard<std::mutex> lock(latch_);
+    return hits_;
+}
+
+uint64_t BufferPoolManager::misses() {
+    std::lock_guard<std::mutex> lock(latch_);
+    return misses_;
 }
 
 Page* BufferPoolManager::new_page(PageID* page_id) {
-    // This is a simplified version. A real implementation would need to manage page allocation on disk.
-    // For now, we'll just use a placeholder.
-    static PageID next_page_id = 0;
-    *page_id = next_page_id++;
+    // The disk manager hands out IDs past the end of the file, which read back as zeroes
+    *page_id = disk_manager_->allocate_page();
     return fetch_page(*page_id);
 }
 
@@ -112,10 +208,11 @@ bool BufferPoolManager::delete_page(PageID page_id) {
         disk_manager_->write_page(page.page_id_, page.data_);
     }
     page_table_.erase(page_id);
-    replacer_.pin(frame_id); // so it's not victimized
+    replacer_->pin(frame_id); // so it's not victimized
+    page.page_id_ = kInvalidPageID;
     free_list_.push_back(&page);
     return true;
 }
 
 } // namespace buffer
-} // namespace graph_db
\ No newline at end of file
+} // namespace graph_db
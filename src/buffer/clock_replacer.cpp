@@ -0,0 +1,55 @@
+#include "../../include/graph_db/buffer/clock_replacer.h"
+#include <bitset>
+
+namespace graph_db {
+namespace buffer {
+
+ClockReplacer::ClockReplacer(size_t num_frames)
+    : num_frames_(num_frames),
+      referenced_(new std::atomic<uint64_t>[(num_frames + 63) / 64]),
+      evictable_(new std::atomic<uint64_t>[(num_frames + 63) / 64]) {
+    for (size_t i = 0; i < words(); ++i) {
+        referenced_[i].store(0, std::memory_order_relaxed);
+        evictable_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void ClockReplacer::record_access(FrameID frame_id, PageID) {
+    referenced_[word(frame_id)].fetch_or(bit(frame_id), std::memory_order_relaxed);
+}
+
+bool ClockReplacer::victim(FrameID* frame_id) {
+    if (size() == 0) return false;
+    // Two turns of the hand clear every referenced bit, so a third finds nothing new
+    for (size_t step = 0; step < 2 * num_frames_ + 1; ++step) {
+        FrameID frame = static_cast<FrameID>(hand_.fetch_add(1, std::memory_order_relaxed) % num_frames_);
+        uint64_t mask = bit(frame);
+        if (!(evictable_[word(frame)].load(std::memory_order_relaxed) & mask)) continue;
+        if (referenced_[word(frame)].fetch_and(~mask, std::memory_order_relaxed) & mask) continue;
+        // Claim it, unless a pin or another sweep got there first
+        if (evictable_[word(frame)].fetch_and(~mask, std::memory_order_acq_rel) & mask) {
+            *frame_id = frame;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ClockReplacer::pin(FrameID frame_id) {
+    evictable_[word(frame_id)].fetch_and(~bit(frame_id), std::memory_order_acq_rel);
+}
+
+void ClockReplacer::unpin(FrameID frame_id) {
+    evictable_[word(frame_id)].fetch_or(bit(frame_id), std::memory_order_acq_rel);
+}
+
+size_t ClockReplacer::size() {
+    size_t count = 0;
+    for (size_t i = 0; i < words(); ++i) {
+        count += std::bitset<64>(evictable_[i].load(std::memory_order_relaxed)).count();
+    }
+    return count;
+}
+
+} // namespace buffer
+} // namespace graph_db
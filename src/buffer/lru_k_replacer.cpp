@@ -0,0 +1,92 @@
+#include "../../include/graph_db/buffer/lru_k_replacer.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace graph_db {
+namespace buffer {
+
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k, uint64_t correlated_period)
+    : k_(k), correlated_period_(correlated_period), frames_(num_frames) {
+    if (k == 0 || k > kMaxK) throw std::runtime_error("LRU-K replacer: K must be between 1 and 8");
+}
+
+void LRUKReplacer::record_access(FrameID frame_id, PageID page_id) {
+    Frame& frame = frames_[frame_id];
+    ++now_;
+    if (frame.page != page_id) {
+        frame.page = page_id;
+        frame.history = History{};
+        auto it = retained_.find(page_id);
+        if (it != retained_.end()) {
+            frame.history = it->second.history;
+            retained_.erase(it);
+        }
+    }
+    History& history = frame.history;
+    if (history.count > 0 && now_ - history.times[0] <= correlated_period_) {
+        history.times[0] = now_;
+        return;
+    }
+    std::copy_backward(history.times.begin(), history.times.begin() + std::min(history.count, k_ - 1),
+                       history.times.begin() + std::min(history.count + 1, k_));
+    history.times[0] = now_;
+    history.count = std::min(history.count + 1, k_);
+}
+
+bool LRUKReplacer::victim(FrameID* frame_id) {
+    // Fewer than K accesses sorts before K, then by the oldest access on record
+    FrameID best = -1;
+    bool best_full = true;
+    uint64_t best_time = UINT64_MAX;
+    for (size_t i = 0; i < frames_.size(); ++i) {
+        const Frame& frame = frames_[i];
+        if (!frame.evictable) continue;
+        bool full = frame.history.count == k_;
+        uint64_t time = frame.history.count ? frame.history.times[frame.history.count - 1] : 0;
+        if (best < 0 || (!full && best_full) || (full == best_full && time < best_time)) {
+            best = static_cast<FrameID>(i);
+            best_full = full;
+            best_time = time;
+        }
+    }
+    if (best < 0) return false;
+    Frame& frame = frames_[best];
+    if (frame.page != kInvalidPageID) retain(frame.page, frame.history);
+    frame.page = kInvalidPageID;
+    frame.history = History{};
+    frame.evictable = false;
+    --size_;
+    *frame_id = best;
+    return true;
+}
+
+void LRUKReplacer::retain(PageID page_id, const History& history) {
+    retained_[page_id] = Retained{history, ++generation_};
+    retired_order_.emplace_back(page_id, generation_);
+    // Pages that came back leave stale entries behind, hence the bound on the queue too
+    while (retained_.size() > frames_.size() || retired_order_.size() > 2 * frames_.size()) {
+        auto [page, generation] = retired_order_.front();
+        retired_order_.pop_front();
+        auto it = retained_.find(page);
+        if (it != retained_.end() && it->second.generation == generation) retained_.erase(it);
+    }
+}
+
+void LRUKReplacer::pin(FrameID frame_id) {
+    Frame& frame = frames_[frame_id];
+    if (frame.evictable) {
+        frame.evictable = false;
+        --size_;
+    }
+}
+
+void LRUKReplacer::unpin(FrameID frame_id) {
+    Frame& frame = frames_[frame_id];
+    if (!frame.evictable) {
+        frame.evictable = true;
+        ++size_;
+    }
+}
+
+} // namespace buffer
+} // namespace graph_db
@@ -0,0 +1,66 @@
+#include "../../include/graph_db/buffer/partitioned_buffer_pool.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace graph_db {
+namespace buffer {
+
+PartitionedBufferPool::PartitionedBufferPool(size_t pool_size, storage::DiskManager* disk_manager,
+                                             size_t instances, ReplacerKind replacer)
+    : disk_manager_(disk_manager) {
+    if (instances == 0 || instances > pool_size) {
+        throw std::runtime_error("buffer pool: need between 1 and pool_size instances");
+    }
+    // The first pool_size % instances instances take one frame more
+    for (size_t i = 0; i < instances; ++i) {
+        size_t frames = pool_size / instances + (i < pool_size % instances ? 1 : 0);
+        instances_.push_back(std::make_unique<BufferPoolManager>(frames, disk_manager, replacer));
+    }
+}
+
+size_t PartitionedBufferPool::default_instances(size_t pool_size) {
+    size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return std::clamp<size_t>(threads, 1, std::max<size_t>(pool_size / 64, 1));
+}
+
+uint64_t PartitionedBufferPool::hits() {
+    uint64_t total = 0;
+    for (auto& pool : instances_) total += pool->hits();
+    return total;
+}
+
+uint64_t PartitionedBufferPool::misses() {
+    uint64_t total = 0;
+    for (auto& pool : instances_) total += pool->misses();
+    return total;
+}
+
+Page* PartitionedBufferPool::fetch_page(PageID page_id) {
+    return instance(page_id).fetch_page(page_id);
+}
+
+bool PartitionedBufferPool::unpin_page(PageID page_id, bool is_dirty) {
+    return instance(page_id).unpin_page(page_id, is_dirty);
+}
+
+bool PartitionedBufferPool::flush_page(PageID page_id) {
+    return instance(page_id).flush_page(page_id);
+}
+
+void PartitionedBufferPool::flush_all_pages() {
+    for (auto& pool : instances_) pool->flush_all_pages();
+}
+
+Page* PartitionedBufferPool::new_page(PageID* page_id) {
+    // The ID decides the instance, so allocate it here rather than in one of them
+    *page_id = disk_manager_->allocate_page();
+    return instance(*page_id).fetch_page(*page_id);
+}
+
+bool PartitionedBufferPool::delete_page(PageID page_id) {
+    return instance(page_id).delete_page(page_id);
+}
+
+} // namespace buffer
+} // namespace graph_db
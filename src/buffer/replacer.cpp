@@ -0,0 +1,21 @@
+#include "../../include/graph_db/buffer/replacer.h"
+#include "../../include/graph_db/buffer/clock_replacer.h"
+#include "../../include/graph_db/buffer/lru_k_replacer.h"
+#include "../../include/graph_db/buffer/lru_replacer.h"
+#include "../../include/graph_db/buffer/two_q_replacer.h"
+
+namespace graph_db {
+namespace buffer {
+
+std::unique_ptr<Replacer> make_replacer(ReplacerKind kind, size_t num_frames) {
+    switch (kind) {
+        case ReplacerKind::Clock: return std::make_unique<ClockReplacer>(num_frames);
+        case ReplacerKind::LRUK: return std::make_unique<LRUKReplacer>(num_frames);
+        case ReplacerKind::TwoQ: return std::make_unique<TwoQReplacer>(num_frames);
+        case ReplacerKind::LRU: break;
+    }
+    return std::make_unique<LRUReplacer>(num_frames);
+}
+
+} // namespace buffer
+} // namespace graph_db
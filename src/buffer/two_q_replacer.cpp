@@ -0,0 +1,99 @@
+#include "../../include/graph_db/buffer/two_q_replacer.h"
+#include <algorithm>
+
+namespace graph_db {
+namespace buffer {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : frames_(num_frames),
+      in_limit_(std::max<size_t>(num_frames / 4, 1)),
+      out_limit_(std::max<size_t>(num_frames / 2, 1)) {}
+
+void TwoQReplacer::record_access(FrameID frame_id, PageID page_id) {
+    Frame& frame = frames_[frame_id];
+    if (frame.page == page_id && frame.queue != Queue::None) {
+        if (frame.queue == Queue::Main) {
+            unlink(frame_id);
+            push_front(Queue::Main, frame_id);
+        }
+        return;
+    }
+    // A new residency: frames freed without being victims still sit in a queue
+    if (frame.queue != Queue::None) unlink(frame_id);
+    frame.page = page_id;
+    push_front(out_count_.count(page_id) ? Queue::Main : Queue::In, frame_id);
+}
+
+bool TwoQReplacer::victim(FrameID* frame_id) {
+    FrameID found = in_.size > in_limit_ ? oldest_evictable(in_) : -1;
+    if (found < 0) found = oldest_evictable(main_);
+    if (found < 0) found = oldest_evictable(in_);
+    if (found < 0) return false;
+    Frame& frame = frames_[found];
+    if (frame.queue == Queue::In) remember(frame.page);
+    unlink(found);
+    frame.page = kInvalidPageID;
+    frame.evictable = false;
+    --size_;
+    *frame_id = found;
+    return true;
+}
+
+void TwoQReplacer::pin(FrameID frame_id) {
+    Frame& frame = frames_[frame_id];
+    if (frame.evictable) {
+        frame.evictable = false;
+        --size_;
+    }
+}
+
+void TwoQReplacer::unpin(FrameID frame_id) {
+    Frame& frame = frames_[frame_id];
+    if (!frame.evictable) {
+        frame.evictable = true;
+        ++size_;
+    }
+}
+
+void TwoQReplacer::push_front(Queue queue, FrameID frame_id) {
+    List& into = list(queue);
+    Frame& frame = frames_[frame_id];
+    frame.queue = queue;
+    frame.prev = -1;
+    frame.next = into.head;
+    if (into.head >= 0) frames_[into.head].prev = frame_id;
+    else into.tail = frame_id;
+    into.head = frame_id;
+    ++into.size;
+}
+
+void TwoQReplacer::unlink(FrameID frame_id) {
+    Frame& frame = frames_[frame_id];
+    List& from = list(frame.queue);
+    if (frame.prev >= 0) frames_[frame.prev].next = frame.next;
+    else from.head = frame.next;
+    if (frame.next >= 0) frames_[frame.next].prev = frame.prev;
+    else from.tail = frame.prev;
+    --from.size;
+    frame.prev = frame.next = -1;
+    frame.queue = Queue::None;
+}
+
+FrameID TwoQReplacer::oldest_evictable(const List& list) const {
+    FrameID frame_id = list.tail;
+    while (frame_id >= 0 && !frames_[frame_id].evictable) frame_id = frames_[frame_id].prev;
+    return frame_id;
+}
+
+void TwoQReplacer::remember(PageID page_id) {
+    out_.push_back(page_id);
+    ++out_count_[page_id];
+    while (out_.size() > out_limit_) {
+        auto it = out_count_.find(out_.front());
+        if (--it->second == 0) out_count_.erase(it);
+        out_.pop_front();
+    }
+}
+
+} // namespace buffer
+} // namespace graph_db
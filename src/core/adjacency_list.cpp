@@ -0,0 +1,174 @@
+#include "../../include/graph_db/adjacency_list.h"
+#include <algorithm>
+#include <cstring>
+
+namespace graph_db {
+
+namespace {
+
+bool edge_less(const AdjacencyEntry& a, const AdjacencyEntry& b) { return a.edge < b.edge; }
+
+} // namespace
+
+AdjacencyList::~AdjacencyList() {
+    delete[] heap_;
+}
+
+void AdjacencyList::grow(uint32_t min_capacity) {
+    uint32_t capacity = std::max(min_capacity, capacity_ + capacity_ / 2 + 2);
+    AdjacencyEntry* entries = new AdjacencyEntry[capacity];
+    std::memcpy(entries, data(), size_ * sizeof(AdjacencyEntry));
+    delete[] heap_;
+    heap_ = entries;
+    capacity_ = capacity;
+}
+
+void AdjacencyList::build_hub_index() {
+    hub_ = std::make_unique<HubIndex>();
+    hub_->reserve(size_ * 2);
+    for (uint32_t i = 0; i < size_; ++i) (*hub_)[heap_[i].edge] = i;
+}
+
+void AdjacencyList::drop_hub_index() {
+    hub_.reset();
+    std::sort(heap_, heap_ + size_, edge_less);
+}
+
+void AdjacencyList::add(const AdjacencyEntry& entry) {
+    if (size_ == capacity_) grow(size_ + 1);
+    AdjacencyEntry* entries = data();
+    if (hub_) {
+        (*hub_)[entry.edge] = size_;
+        entries[size_++] = entry;
+        return;
+    }
+    if (size_ == 0 || entries[size_ - 1].edge < entry.edge) {
+        entries[size_++] = entry;
+    } else {
+        AdjacencyEntry* pos = std::upper_bound(entries, entries + size_, entry, edge_less);
+        std::memmove(pos + 1, pos, (entries + size_ - pos) * sizeof(AdjacencyEntry));
+        *pos = entry;
+        ++size_;
+    }
+    if (size_ > kHubDegree) build_hub_index();
+}
+
+void AdjacencyList::add(const AdjacencyEntry* first, const AdjacencyEntry* last) {
+    uint32_t count = static_cast<uint32_t>(last - first);
+    if (count == 0) return;
+    if (size_ + count > capacity_) grow(size_ + count);
+    AdjacencyEntry* entries = data();
+    std::memcpy(entries + size_, first, count * sizeof(AdjacencyEntry));
+    uint32_t old_size = size_;
+    size_ += count;
+    if (hub_) {
+        for (uint32_t i = old_size; i < size_; ++i) (*hub_)[entries[i].edge] = i;
+        return;
+    }
+    if (!std::is_sorted(entries + old_size, entries + size_, edge_less)) {
+        std::sort(entries + old_size, entries + size_, edge_less);
+    }
+    if (old_size > 0 && entries[old_size].edge < entries[old_size - 1].edge) {
+        std::inplace_merge(entries, entries + old_size, entries + size_, edge_less);
+    }
+    if (size_ > kHubDegree) build_hub_index();
+}
+
+const AdjacencyEntry* AdjacencyList::find(EdgeID edge) const {
+    const AdjacencyEntry* entries = data();
+    if (hub_) {
+        auto it = hub_->find(edge);
+        return it == hub_->end() ? nullptr : entries + it->second;
+    }
+    if (size_ <= kInlineCapacity) {
+        for (uint32_t i = 0; i < size_; ++i) {
+            if (entries[i].edge == edge) return entries + i;
+        }
+        return nullptr;
+    }
+    const AdjacencyEntry* pos = std::lower_bound(entries, entries + size_, AdjacencyEntry{edge, 0, 0}, edge_less);
+    return (pos != entries + size_ && pos->edge == edge) ? pos : nullptr;
+}
+
+bool AdjacencyList::remove(EdgeID edge) {
+    AdjacencyEntry* pos = const_cast<AdjacencyEntry*>(find(edge));
+    if (!pos) return false;
+    AdjacencyEntry* entries = data();
+    if (hub_) {
+        // Swap-remove keeps hub deletions O(1)
+        AdjacencyEntry& last = entries[size_ - 1];
+        hub_->erase(edge);
+        if (pos != &last) {
+            *pos = last;
+            (*hub_)[pos->edge] = static_cast<uint32_t>(pos - entries);
+        }
+        --size_;
+        if (size_ < kHubDegree / 2) drop_hub_index();
+        return true;
+    }
+    std::memmove(pos, pos + 1, (entries + size_ - pos - 1) * sizeof(AdjacencyEntry));
+    --size_;
+    if (heap_ && size_ <= kInlineCapacity) {
+        // Back to inline storage
+        std::memcpy(inline_, heap_, size_ * sizeof(AdjacencyEntry));
+        delete[] heap_;
+        heap_ = nullptr;
+        capacity_ = kInlineCapacity;
+    }
+    return true;
+}
+
+bool AdjacencyList::set_weight(EdgeID edge, int64_t weight) {
+    AdjacencyEntry* pos = const_cast<AdjacencyEntry*>(find(edge));
+    if (!pos) return false;
+    pos->weight = weight;
+    return true;
+}
+
+size_t LabeledAdjacency::size() const {
+    size_t size = first_.size();
+    for (const auto& partition : rest_) size += partition->list.size();
+    return size;
+}
+
+AdjacencyList& LabeledAdjacency::list_for(LabelID label) {
+    if (label == first_label_) return first_;
+    for (const auto& partition : rest_) {
+        if (partition->label == label) return partition->list;
+    }
+    // The inline list is free again once its label's edges are gone
+    if (first_.empty()) {
+        first_label_ = label;
+        return first_;
+    }
+    rest_.push_back(std::make_unique<Partition>(label));
+    return rest_.back()->list;
+}
+
+bool LabeledAdjacency::remove(EdgeID edge) {
+    if (first_.remove(edge)) return true;
+    for (auto it = rest_.begin(); it != rest_.end(); ++it) {
+        if (!(*it)->list.remove(edge)) continue;
+        if ((*it)->list.empty()) rest_.erase(it);
+        return true;
+    }
+    return false;
+}
+
+bool LabeledAdjacency::set_weight(EdgeID edge, int64_t weight) {
+    if (first_.set_weight(edge, weight)) return true;
+    for (const auto& partition : rest_) {
+        if (partition->list.set_weight(edge, weight)) return true;
+    }
+    return false;
+}
+
+const AdjacencyList* LabeledAdjacency::find(LabelID label) const {
+    if (label == first_label_) return first_.empty() ? nullptr : &first_;
+    for (const auto& partition : rest_) {
+        if (partition->label == label) return &partition->list;
+    }
+    return nullptr;
+}
+
+} // namespace graph_db
@@ -0,0 +1,181 @@
+#include "../../include/graph_db/graph_algo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+
+namespace graph_db {
+
+namespace {
+
+using VertexIndex = CSRGraph::VertexIndex;
+constexpr int64_t kInfinity = std::numeric_limits<int64_t>::max();
+constexpr size_t kGrain = 64;
+
+// Cap on the cyclic bucket window; relaxations further ahead wait in an overflow list
+constexpr size_t kMaxWindow = 1024;
+
+// Largest edge weight and the mean weight, rejecting negative weights
+void scan_weights(const CSRGraph& g, int64_t& max_weight, int64_t& mean_weight) {
+    max_weight = 0;
+    int64_t total = 0;
+    for (size_t v = 0; v < g.num_vertices(); ++v) {
+        for (int64_t w : g.out_weights(static_cast<VertexIndex>(v))) {
+            if (w < 0) throw std::runtime_error("delta_stepping: negative edge weight");
+            max_weight = std::max(max_weight, w);
+            total += w;
+        }
+    }
+    size_t edges = g.num_edges();
+    mean_weight = edges ? std::max<int64_t>(1, total / static_cast<int64_t>(edges)) : 1;
+}
+
+// Lowers dist to `value`; true if this call made the improvement
+bool atomic_min(std::atomic<int64_t>& dist, int64_t value) {
+    int64_t current = dist.load(std::memory_order_relaxed);
+    while (value < current) {
+        if (dist.compare_exchange_weak(current, value, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::unordered_map<NodeID, int64_t> delta_stepping(Graph& g, NodeID start, int64_t delta) {
+    auto csr = g.snapshot();
+    std::unordered_map<NodeID, int64_t> distances;
+    auto dense = delta_stepping(*csr, start, delta, parallel::ThreadPool::global());
+    distances.reserve(dense.size());
+    for (size_t v = 0; v < dense.size(); ++v) {
+        distances[csr->node_id(static_cast<VertexIndex>(v))] = dense[v];
+    }
+    return distances;
+}
+
+std::vector<int64_t> delta_stepping(const CSRGraph& g, NodeID start, int64_t delta, parallel::ThreadPool& pool) {
+    const size_t n = g.num_vertices();
+    VertexIndex source = g.index_of(start);
+    if (source == CSRGraph::kInvalidVertex) return {};
+    int64_t max_weight, mean_weight;
+    scan_weights(g, max_weight, mean_weight);
+    if (delta <= 0) delta = mean_weight;
+
+    std::vector<std::atomic<int64_t>> dist(n);
+    for (auto& d : dist) d.store(kInfinity, std::memory_order_relaxed);
+    dist[source].store(0, std::memory_order_relaxed);
+
+    // A relaxation from bucket b lands in b .. b + max_weight / delta + 1, so buckets are
+    // kept in a cyclic window of that many slots per worker. Past kMaxWindow, targets
+    // further ahead go to the worker's overflow list with their bucket and move into the
+    // window once it reaches them.
+    const size_t window = std::clamp<size_t>(static_cast<size_t>(max_weight / delta) + 2, 2, kMaxWindow);
+    struct Pending {
+        VertexIndex vertex;
+        size_t bucket;
+    };
+    struct WorkerBins {
+        std::vector<std::vector<VertexIndex>> slots;
+        std::vector<Pending> overflow;
+        size_t overflow_min = std::numeric_limits<size_t>::max();
+    };
+    std::vector<WorkerBins> bins(pool.size());
+    for (auto& my_bins : bins) my_bins.slots.resize(window);
+    size_t bucket = 0;
+    bins[0].slots[0].push_back(source);
+
+    auto relax = [&](const std::vector<VertexIndex>& from, bool light) {
+        pool.parallel_for(0, from.size(), kGrain, [&](size_t lo, size_t hi, size_t worker) {
+            auto& my_bins = bins[worker];
+            for (size_t i = lo; i < hi; ++i) {
+                VertexIndex u = from[i];
+                int64_t du = dist[u].load(std::memory_order_relaxed);
+                auto targets = g.out_neighbors(u);
+                auto weights = g.out_weights(u);
+                for (size_t k = 0; k < targets.size(); ++k) {
+                    if ((weights[k] <= delta) != light) continue;
+                    int64_t candidate = du + weights[k];
+                    if (!atomic_min(dist[targets[k]], candidate)) continue;
+                    size_t dest = static_cast<size_t>(candidate / delta);
+                    if (dest - bucket < window) {
+                        my_bins.slots[dest % window].push_back(targets[k]);
+                    } else {
+                        my_bins.overflow.push_back({targets[k], dest});
+                        my_bins.overflow_min = std::min(my_bins.overflow_min, dest);
+                    }
+                }
+            }
+        });
+    };
+
+    // Per vertex, the last round it joined the frontier in and the last bucket it was
+    // settled in, so neither list holds duplicates
+    std::vector<size_t> in_round(n, std::numeric_limits<size_t>::max());
+    std::vector<size_t> in_bucket(n, std::numeric_limits<size_t>::max());
+    std::vector<VertexIndex> frontier, settled;
+    size_t round = 0;
+    for (;;) {
+        // Light edges can refill the current bucket, so it may take several rounds; a
+        // vertex whose distance has since dropped to an earlier bucket is stale
+        const int64_t bucket_floor = static_cast<int64_t>(bucket) * delta;
+        settled.clear();
+        for (;;) {
+            frontier.clear();
+            for (auto& my_bins : bins) {
+                auto& slot = my_bins.slots[bucket % window];
+                for (VertexIndex v : slot) {
+                    if (dist[v].load(std::memory_order_relaxed) < bucket_floor || in_round[v] == round) continue;
+                    in_round[v] = round;
+                    frontier.push_back(v);
+                    if (in_bucket[v] != bucket) {
+                        in_bucket[v] = bucket;
+                        settled.push_back(v);
+                    }
+                }
+                slot.clear();
+            }
+            ++round;
+            if (frontier.empty()) break;
+            relax(frontier, true);
+        }
+        // Heavy edges leave the bucket, so each settled vertex relaxes them once
+        relax(settled, false);
+
+        size_t next = std::numeric_limits<size_t>::max();
+        for (size_t b = bucket + 1; b < bucket + window && next == std::numeric_limits<size_t>::max(); ++b) {
+            for (const auto& my_bins : bins) {
+                if (!my_bins.slots[b % window].empty()) {
+                    next = b;
+                    break;
+                }
+            }
+        }
+        size_t overflow_min = std::numeric_limits<size_t>::max();
+        for (const auto& my_bins : bins) overflow_min = std::min(overflow_min, my_bins.overflow_min);
+        if (overflow_min <= next) {
+            // Every slot in use is ahead of overflow_min, so the window can move up to it
+            next = overflow_min;
+            for (auto& my_bins : bins) {
+                size_t kept = 0;
+                my_bins.overflow_min = std::numeric_limits<size_t>::max();
+                for (const Pending& p : my_bins.overflow) {
+                    if (p.bucket - next < window) {
+                        my_bins.slots[p.bucket % window].push_back(p.vertex);
+                    } else {
+                        my_bins.overflow[kept++] = p;
+                        my_bins.overflow_min = std::min(my_bins.overflow_min, p.bucket);
+                    }
+                }
+                my_bins.overflow.resize(kept);
+            }
+        }
+        if (next == std::numeric_limits<size_t>::max()) break;
+        bucket = next;
+    }
+
+    std::vector<int64_t> result(n);
+    for (size_t v = 0; v < n; ++v) result[v] = dist[v].load(std::memory_order_relaxed);
+    return result;
+}
+
+}
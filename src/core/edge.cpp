@@ -3,25 +3,36 @@
 namespace graph_db{
     void Edge::set_property(std::string key,PropertyValue p){
         std::unique_lock lock(mutex_);
+        dirty_ = true;
        if (index_manager_) {
             if (auto index = index_manager_->get_index(key)) {
                 if (properties_.count(key)) {
-                    index->remove(properties_.at(key), from_node_); // Or a designated ID
+                    index->remove(properties_.at(key), id_);
                 }
-                index->insert(p, from_node_); // Or a designated ID
+                index->insert(p, id_);
             }
         }
         properties_[key] = p;
     }
+    void Edge::unindex_properties(){
+        std::unique_lock lock(mutex_);
+        if (!index_manager_) return;
+        for (const auto& [key, value] : properties_) {
+            if (auto index = index_manager_->get_index(key)) {
+                index->remove(value, id_);
+            }
+        }
+    }
     bool Edge::has_property(std::string s){
         return properties_.find(s)!=properties_.end();
     }
     void Edge::remove_property(std::string s){
         std::unique_lock lock(mutex_);
+        dirty_ = true;
         if (index_manager_) {
             if (auto index = index_manager_->get_index(s)) {
                 if (properties_.count(s)) {
-                    index->remove(properties_.at(s), from_node_); // Or a designated ID
+                    index->remove(properties_.at(s), id_);
                 }
             }
         }
@@ -1,171 +1,752 @@
 #include "../../include/graph_db/graph.h"
+#include "../../include/graph_db/parallel/thread_pool.h"
+#include <algorithm>
+#include <iterator>
+#include <tuple>
 namespace graph_db{
+    namespace {
+        // Keeps auto-assigned IDs above any explicitly supplied one
+        template <typename T>
+        void raise_next_id(std::atomic<T>& next, T id) {
+            T current = next.load(std::memory_order_relaxed);
+            while (id >= current && !next.compare_exchange_weak(current, id + 1)) {
+            }
+        }
+    }
+    Graph::~Graph() {
+        if (store_) {
+            try {
+                flush();
+            } catch (...) {
+            }
+        }
+        for (auto& shard : node_shards_) {
+            shard.nodes.for_each([&shard](Node* node) { shard.pool.destroy(node); });
+            for (Node* node : shard.retired) shard.pool.destroy(node);
+        }
+        for (auto& shard : edge_shards_) {
+            shard.edges.for_each([&shard](Edge* edge) { shard.pool.destroy(edge); });
+            for (Edge* edge : shard.retired) shard.pool.destroy(edge);
+        }
+    }
+    Node* Graph::insert_node(NodeShard& shard, NodeID id){
+       Node* raw = shard.pool.create(id);
+       raw->set_index_manager(&index_manager_);
+       shard.nodes.insert(id, raw);
+       if (store_) {
+           shard.resident.push_back(id);
+           store_record(*raw);
+       }
+       shard.node_set_changed = true;
+       ++shard.node_count;
+       node_count_.fetch_add(1, std::memory_order_relaxed);
+       version_.fetch_add(1, std::memory_order_release);
+       return raw;
+    }
     NodeID Graph::create_node(){
-       std::unique_lock lock(mutex_);
-       NodeID id= next_node_id_++;
-       auto node = std::make_unique<Node>(id);
-       node->set_index_manager(&index_manager_);
-       Nodes_[id]=std::move(node);
-       return id;
+       for (;;) {
+          NodeID id= next_node_id_.fetch_add(1, std::memory_order_relaxed);
+          require_storable(id, "create_node");
+          NodeShard& shard = node_shard(id);
+          auto lock = write_lock(shard);
+          // A concurrent create_node(id) can claim the ID before it raises next_node_id_
+          if (find_node(shard, id)) continue;
+          insert_node(shard, id);
+          return id;
+       }
     }
     Node* Graph::create_node(NodeID id){
-       std::unique_lock lock(mutex_);
-       if(Nodes_.find(id)!=Nodes_.end()){
+       require_storable(id, "create_node");
+       NodeShard& shard = node_shard(id);
+       auto lock = write_lock(shard);
+       if(find_node(shard, id)){
         throw std::runtime_error("Node with this ID already exists");
        }
-       if(id>=next_node_id_){
-        next_node_id_=id+1;
-       }
-       auto node = std::make_unique<Node>(id);
-       node->set_index_manager(&index_manager_);
-       Nodes_[id]=std::move(node);
-       return Nodes_[id].get();
+       raise_next_id(next_node_id_, id);
+       return insert_node(shard, id);
+    }
+    void Graph::create_index(const std::string& property_key, IndexKind kind) {
+        Index* index = index_manager_.create_index(property_key, kind);
+        if (!index) return;
+        // From here on the index logs writes, so the scan cannot miss one
+        auto stored = stored_by_shard(storage::RecordKind::Node);
+        backfill(index_manager_, {property_key}, index, [&](size_t s, std::vector<IndexEntry>& out) {
+            auto lock = read_lock(node_shards_[s]);
+            scan_nodes(s, stored[s], [&](Node* node) {
+                if (auto value = node->find_property(property_key)) out.emplace_back(std::move(*value), node->get_id());
+            });
+        });
+    }
+    void Graph::create_composite_index(const std::vector<std::string>& property_keys, IndexKind kind) {
+        if (property_keys.size() < 2) throw std::runtime_error("composite index: needs at least two keys");
+        CompositeIndex* composite = index_manager_.create_composite_index(property_keys, kind);
+        if (!composite) return;
+        auto stored = stored_by_shard(storage::RecordKind::Node);
+        backfill(index_manager_, property_keys, &composite->index(), [&](size_t s, std::vector<IndexEntry>& out) {
+            auto lock = read_lock(node_shards_[s]);
+            scan_nodes(s, stored[s], [&](Node* node) {
+                if (auto key = node->composite_key(*composite)) out.emplace_back(std::move(*key), node->get_id());
+            });
+        });
+    }
+    void Graph::create_edge_index(const std::string& property_key, IndexKind kind) {
+        Index* index = edge_index_manager_.create_index(property_key, kind);
+        if (!index) return;
+        auto stored = stored_by_shard(storage::RecordKind::Edge);
+        backfill(edge_index_manager_, {property_key}, index, [&](size_t s, std::vector<IndexEntry>& out) {
+            auto lock = read_lock(edge_shards_[s]);
+            scan_edges(s, stored[s], [&](Edge* edge) {
+                if (auto value = edge->find_property(property_key)) out.emplace_back(std::move(*value), edge->id());
+            });
+        });
+    }
+    void Graph::open_index_file(const std::string& path, size_t pool_pages, buffer::ReplacerKind replacer) {
+        if (index_store_) throw std::runtime_error("index file: one is already open");
+        index_store_ = std::make_unique<IndexStore>(path, pool_pages, replacer);
+        bool nodes = index_manager_.attach_store(index_store_.get(), "node");
+        bool edges = edge_index_manager_.attach_store(index_store_.get(), "edge");
+        attached_stored_indexes_ = nodes || edges;
+    }
+    void Graph::flush_indexes() {
+        if (index_store_) index_store_->flush();
+    }
+    void Graph::backfill(IndexManager& manager, const std::vector<std::string>& property_keys, Index* index,
+                         const std::function<void(size_t, std::vector<IndexEntry>&)>& scan) {
+        try {
+            std::vector<std::vector<IndexEntry>> runs(kShardCount);
+            parallel::ThreadPool& pool = parallel::ThreadPool::global();
+            pool.parallel_for(0, kShardCount, 1, [&](size_t lo, size_t hi, size_t) {
+                for (size_t s = lo; s < hi; ++s) {
+                    scan(s, runs[s]);
+                    std::sort(runs[s].begin(), runs[s].end());
+                }
+            });
+            // Pairwise merge rounds; run i absorbs run i + width
+            for (size_t width = 1; width < kShardCount; width *= 2) {
+                pool.parallel_for(0, kShardCount / (2 * width), 1, [&](size_t lo, size_t hi, size_t) {
+                    for (size_t pair = lo; pair < hi; ++pair) {
+                        std::vector<IndexEntry>& left = runs[2 * width * pair];
+                        std::vector<IndexEntry>& right = runs[2 * width * pair + width];
+                        std::vector<IndexEntry> merged;
+                        merged.reserve(left.size() + right.size());
+                        std::merge(std::make_move_iterator(left.begin()), std::make_move_iterator(left.end()),
+                                   std::make_move_iterator(right.begin()), std::make_move_iterator(right.end()),
+                                   std::back_inserter(merged));
+                        left = std::move(merged);
+                        right = {};
+                    }
+                });
+            }
+            index->finish_build(std::move(runs[0]));
+        } catch (...) {
+            manager.discard_build(property_keys);
+            throw;
+        }
+    }
+    std::vector<EdgeID> Graph::find_edges_by_label(const std::string& label) {
+        std::vector<EdgeID> result;
+        std::optional<LabelID> label_id = labels_.find(label);
+        if (!label_id) return result;
+        for (auto& shard : edge_shards_) {
+            std::shared_lock lock(shard.mutex);
+            auto it = shard.by_label.find(*label_id);
+            if (it != shard.by_label.end()) result.insert(result.end(), it->second.begin(), it->second.end());
+        }
+        return result;
+    }
+    Edge* Graph::insert_edge(EdgeShard& shard, EdgeID id, NodeID from, NodeID to, const std::string& label,
+                             LabelID label_id, int64_t weight) {
+        Edge* edge = shard.pool.create(id, from, to, label, weight);
+        edge->set_index_manager(&edge_index_manager_);
+        edge->set_label_id(label_id);
+        std::vector<EdgeID>& labeled = shard.by_label[label_id];
+        edge->set_label_slot(static_cast<uint32_t>(labeled.size()));
+        labeled.push_back(id);
+        shard.edges.insert(id, edge);
+        if (store_) shard.resident.push_back(id);
+        return edge;
+    }
+    void Graph::destroy_edge(EdgeShard& shard, Edge* edge) {
+        auto it = shard.by_label.find(edge->label_id());
+        std::vector<EdgeID>& labeled = it->second;
+        EdgeID last = labeled.back();
+        if (last != edge->id()) {
+            labeled[edge->label_slot()] = last;
+            find_edge(shard, last)->set_label_slot(edge->label_slot());
+        }
+        labeled.pop_back();
+        if (labeled.empty()) shard.by_label.erase(it);
+        edge->unindex_properties();
+        release(shard, edge);
     }
     bool Graph::save_to_file(const std::string& filename) {
         storage::Serializer serializer(*this);
         return serializer.save_to_file(filename);
     }
     bool Graph::load_from_file(const std::string& filename) {
+        if (attached_stored_indexes_) {
+            throw std::runtime_error("load: the index file's indexes are attached already; load before opening it");
+        }
         storage::Serializer serializer(*this);
         return serializer.load_from_file(filename);
     }
-    bool Graph::remove_node(NodeID id) {
-        std::unique_lock lock(mutex_);
-        auto it = Nodes_.find(id);
-        if (it == Nodes_.end()) return false;
-
-        // Collect edges connected to the node
-        std::vector<EdgeID> edges_to_remove;
-        for (auto const & [eid, edge_ptr] : Edges_) {
-            if (!edge_ptr) continue;
-            if (edge_ptr->from_node() == id || edge_ptr->to_node() == id) {
-                edges_to_remove.push_back(eid);
-            }
-        }
-
-        // Remove edges directly while holding the unique_lock (avoid calling remove_edge())
-        for (EdgeID eid : edges_to_remove) {
-            auto eit = Edges_.find(eid);
-            if (eit == Edges_.end()) continue;
-            Edge* e = eit->second.get();
-            // remove references from neighbor nodes if they still exist
-            auto fromIt = Nodes_.find(e->from_node());
-            if (fromIt != Nodes_.end()) fromIt->second->remove_outgoing_edge(eid);
-            auto toIt = Nodes_.find(e->to_node());
-            if (toIt != Nodes_.end()) toIt->second->remove_incoming_edge(eid);
-            Edges_.erase(eit);
-        }
-
-        // Erase the node
-        Nodes_.erase(it);
+    std::pair<Graph::NodeLock, Graph::NodeLock> Graph::lock_endpoints(NodeID a, NodeID b) {
+        size_t first = shard_index(a);
+        size_t second = shard_index(b);
+        if (first > second) std::swap(first, second);
+        NodeLock first_lock = write_lock(node_shards_[first]);
+        if (first == second) return {std::move(first_lock), NodeLock()};
+        return {std::move(first_lock), write_lock(node_shards_[second])};
+    }
+    std::pair<std::vector<Graph::NodeLock>, std::vector<Graph::EdgeLock>> Graph::lock_all_shards() {
+        std::pair<std::vector<NodeLock>, std::vector<EdgeLock>> locks;
+        locks.first.reserve(kShardCount);
+        locks.second.reserve(kShardCount);
+        for (auto& shard : node_shards_) locks.first.push_back(write_lock(shard));
+        for (auto& shard : edge_shards_) locks.second.push_back(write_lock(shard));
+        return locks;
+    }
+    bool Graph::edge_endpoints(EdgeID id, NodeID& from, NodeID& to) {
+        EdgeShard& shard = edge_shard(id);
+        auto lock = read_lock(shard);
+        Edge* edge = find_edge(shard, id);
+        if (!edge) return false;
+        from = edge->from_node();
+        to = edge->to_node();
         return true;
     }
+    void Graph::add_neighbor_shards(const Node& node, ShardSet& shards) {
+        auto add = [&shards](EdgeID, NodeID neighbor, int64_t) { shards.set(shard_index(neighbor)); };
+        node.for_each_out_edge(add);
+        node.for_each_in_edge(add);
+    }
+    std::vector<Graph::NodeLock> Graph::lock_neighborhood(const std::vector<NodeID>& ids) {
+        // New edges of a node need its shard lock, so once every shard in the set is held the
+        // set can only be stale if an edge was added before that; widen it and retry
+        ShardSet shards;
+        for (NodeID id : ids) {
+            shards.set(shard_index(id));
+            auto lock = read_lock(node_shard(id));
+            if (Node* node = get_node_unlocked(id)) add_neighbor_shards(*node, shards);
+        }
+        while (true) {
+            std::vector<NodeLock> locks;
+            locks.reserve(shards.count());
+            for (size_t i = 0; i < kShardCount; ++i) {
+                if (shards.test(i)) locks.push_back(write_lock(node_shards_[i]));
+            }
+            ShardSet needed = shards;
+            for (NodeID id : ids) {
+                if (Node* node = get_node_unlocked(id)) add_neighbor_shards(*node, needed);
+            }
+            if (needed == shards) return locks;
+            shards = needed;
+        }
+    }
+    size_t Graph::remove_nodes_locked(const std::vector<NodeID>& ids) {
+        // Unlink the nodes first so the edge pass below only patches surviving neighbors
+        std::vector<std::pair<NodeShard*, Node*>> removed;
+        std::vector<EdgeID> edges;
+        for (NodeID id : ids) {
+            NodeShard& shard = node_shard(id);
+            Node* node = unlink_node(shard, id);
+            if (!node) continue;
+            auto collect = [&edges](EdgeID edge, NodeID, int64_t) { edges.push_back(edge); };
+            node->for_each_out_edge(collect);
+            node->for_each_in_edge(collect);
+            removed.emplace_back(&shard, node);
+        }
+        if (removed.empty()) return 0;
+        // Self-loops and edges between removed nodes show up twice
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        for (EdgeID eid : edges) {
+            NodeID from, to;
+            {
+                EdgeShard& owner = edge_shard(eid);
+                auto edge_lock = write_lock(owner);
+                Edge* e = unlink_edge(owner, eid);
+                if (!e) continue;
+                from = e->from_node();
+                to = e->to_node();
+                destroy_edge(owner, e);
+            }
+            if (Node* n = get_node_unlocked(from)) n->remove_outgoing_edge(eid);
+            if (Node* n = get_node_unlocked(to)) n->remove_incoming_edge(eid);
+            mark_dirty(from);
+            mark_dirty(to);
+            edge_count_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        for (auto [shard, node] : removed) {
+            shard->dirty.erase(node->get_id());
+            shard->node_set_changed = true;
+            --shard->node_count;
+            node->unindex_properties();
+            release(*shard, node);
+        }
+        node_count_.fetch_sub(removed.size(), std::memory_order_relaxed);
+        version_.fetch_add(1, std::memory_order_release);
+        return removed.size();
+    }
+    bool Graph::remove_node(NodeID id) {
+        std::vector<NodeID> ids{id};
+        auto locks = lock_neighborhood(ids);
+        return remove_nodes_locked(ids) > 0;
+    }
+    size_t Graph::remove_nodes(const std::vector<NodeID>& ids) {
+        auto locks = lock_neighborhood(ids);
+        return remove_nodes_locked(ids);
+    }
     Edge* Graph::create_edge(NodeID from, NodeID to, const std::string& label, EdgeID id) {
-        std::unique_lock lock(mutex_);
+        require_storable(id, "create_edge");
+        LabelID label_id = labels_.intern(label);
+        auto locks = lock_endpoints(from, to);
 
         // Validate nodes exist
-        if (Nodes_.find(from) == Nodes_.end()) {
+        Node* from_node = get_node_unlocked(from);
+        Node* to_node = get_node_unlocked(to);
+        if (!from_node) {
             throw std::runtime_error("create_edge: from node does not exist");
         }
-        if (Nodes_.find(to) == Nodes_.end()) {
+        if (!to_node) {
             throw std::runtime_error("create_edge: to node does not exist");
         }
 
-        if (Edges_.find(id) != Edges_.end()) {
-            throw std::runtime_error("create_edge: edge with this ID already exists");
+        Edge* edge;
+        {
+            EdgeShard& shard = edge_shard(id);
+            auto edge_lock = write_lock(shard);
+            if (find_edge(shard, id)) {
+                throw std::runtime_error("create_edge: edge with this ID already exists");
+            }
+            raise_next_id(next_edge_id_, id);
+            edge = insert_edge(shard, id, from, to, label, label_id, 1);
+            if (store_) store_record(*edge);
+        }
+
+        // Update nodes' edge lists
+        from_node->add_outgoing_edge(id, to, edge->get_weight(), label_id);
+        to_node->add_incoming_edge(id, from, edge->get_weight(), label_id);
+        edge_count_.fetch_add(1, std::memory_order_relaxed);
+        version_.fetch_add(1, std::memory_order_release);
+        mark_dirty(from);
+        mark_dirty(to);
+
+        return edge;
+    }
+    BulkInsertResult Graph::bulk_insert(std::vector<NodeRecord> nodes, std::vector<EdgeRecord> edges) {
+        auto locks = lock_all_shards();
+
+        // Validate everything before the first mutation so a rejected batch leaves no trace
+        std::unordered_set<NodeID> batch_nodes;
+        size_t auto_nodes = 0;
+        for (const auto& record : nodes) {
+            require_storable(record.id, "bulk_insert");
+            if (record.id == 0) {
+                ++auto_nodes;
+            } else if (get_node_unlocked(record.id) || !batch_nodes.insert(record.id).second) {
+                throw std::runtime_error("bulk_insert: node with this ID already exists");
+            }
+        }
+        std::unordered_set<EdgeID> batch_edges;
+        size_t auto_edges = 0;
+        for (const auto& record : edges) {
+            if (!get_node_unlocked(record.from) && batch_nodes.count(record.from) == 0) {
+                throw std::runtime_error("bulk_insert: from node does not exist");
+            }
+            if (!get_node_unlocked(record.to) && batch_nodes.count(record.to) == 0) {
+                throw std::runtime_error("bulk_insert: to node does not exist");
+            }
+            require_storable(record.id, "bulk_insert");
+            if (record.id == 0) {
+                ++auto_edges;
+            } else if (find_edge(edge_shard(record.id), record.id) || !batch_edges.insert(record.id).second) {
+                throw std::runtime_error("bulk_insert: edge with this ID already exists");
+            }
+        }
+
+        // Explicit IDs first, so the auto-assigned range starts above all of them
+        BulkInsertResult result;
+        result.node_ids.reserve(nodes.size());
+        result.edge_ids.reserve(edges.size());
+        for (NodeID id : batch_nodes) raise_next_id(next_node_id_, id);
+        for (EdgeID id : batch_edges) raise_next_id(next_edge_id_, id);
+        NodeID next_node = next_node_id_.fetch_add(auto_nodes, std::memory_order_relaxed);
+        EdgeID next_edge = next_edge_id_.fetch_add(auto_edges, std::memory_order_relaxed);
+        if (auto_nodes) require_storable(next_node + auto_nodes - 1, "bulk_insert");
+        if (auto_edges) require_storable(next_edge + auto_edges - 1, "bulk_insert");
+        for (const auto& record : nodes) result.node_ids.push_back(record.id ? record.id : next_node++);
+        for (const auto& record : edges) result.edge_ids.push_back(record.id ? record.id : next_edge++);
+
+        std::array<size_t, kShardCount> per_shard{};
+        for (NodeID id : result.node_ids) ++per_shard[shard_index(id)];
+        for (size_t i = 0; i < kShardCount; ++i) {
+            if (per_shard[i] == 0) continue;
+            node_shards_[i].pool.reserve(per_shard[i]);
+            node_shards_[i].node_set_changed = true;
         }
-        if (id >= next_edge_id_) {
-            next_edge_id_ = id + 1;
+        per_shard.fill(0);
+        for (EdgeID id : result.edge_ids) ++per_shard[shard_index(id)];
+        for (size_t i = 0; i < kShardCount; ++i) {
+            if (per_shard[i] == 0) continue;
+            edge_shards_[i].pool.reserve(per_shard[i]);
         }
 
-        Edges_[id] = std::make_unique<Edge>(id, from, to, label);
+        // Nodes, collecting index entries per indexed key
+        std::unordered_map<std::string, Index*> index_of_key;
+        std::unordered_map<Index*, std::vector<std::pair<PropertyValue, NodeID>>> index_entries;
+        std::vector<CompositeIndex*> composites = index_manager_.composites_with();
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            NodeID id = result.node_ids[i];
+            for (CompositeIndex* composite : composites) {
+                if (auto key = composite->key_of(nodes[i].properties)) {
+                    index_entries[&composite->index()].emplace_back(std::move(*key), id);
+                }
+            }
+            for (const auto& [key, value] : nodes[i].properties) {
+                auto it = index_of_key.find(key);
+                if (it == index_of_key.end()) {
+                    it = index_of_key.emplace(key, index_manager_.get_index(key)).first;
+                }
+                if (it->second) index_entries[it->second].emplace_back(value, id);
+            }
+            NodeShard& shard = node_shard(id);
+            Node* node = shard.pool.create(id);
+            node->set_index_manager(&index_manager_);
+            node->init_properties(std::move(nodes[i].properties));
+            shard.nodes.insert(id, node);
+            ++shard.node_count;
+            if (store_) shard.resident.push_back(id);
+        }
 
-        // Update nodes' edge lists
-        Nodes_[from]->add_outgoing_edge(id);
-        Nodes_[to]->add_incoming_edge(id);
+        // Edges, then adjacency grouped per endpoint and label
+        struct Incidence {
+            NodeID node;
+            LabelID label;
+            AdjacencyEntry entry;
+        };
+        std::vector<Incidence> out_entries;
+        std::vector<Incidence> in_entries;
+        out_entries.reserve(edges.size());
+        in_entries.reserve(edges.size());
+        std::unordered_map<std::string, Index*> edge_index_of_key;
+        for (size_t i = 0; i < edges.size(); ++i) {
+            EdgeRecord& record = edges[i];
+            EdgeID id = result.edge_ids[i];
+            for (const auto& [key, value] : record.properties) {
+                auto it = edge_index_of_key.find(key);
+                if (it == edge_index_of_key.end()) {
+                    it = edge_index_of_key.emplace(key, edge_index_manager_.get_index(key)).first;
+                }
+                if (it->second) index_entries[it->second].emplace_back(value, id);
+            }
+            LabelID label = labels_.intern(record.label);
+            Edge* edge = insert_edge(edge_shard(id), id, record.from, record.to, record.label, label, record.weight);
+            edge->init_properties(std::move(record.properties));
+            out_entries.push_back({record.from, label, {id, record.to, record.weight}});
+            in_entries.push_back({record.to, label, {id, record.from, record.weight}});
+        }
+        auto attach = [this](std::vector<Incidence>& entries, bool outgoing) {
+            std::sort(entries.begin(), entries.end(), [](const Incidence& a, const Incidence& b) {
+                return std::tie(a.node, a.label, a.entry.edge) < std::tie(b.node, b.label, b.entry.edge);
+            });
+            std::vector<AdjacencyEntry> run;
+            for (size_t i = 0; i < entries.size();) {
+                NodeID id = entries[i].node;
+                LabelID label = entries[i].label;
+                run.clear();
+                for (; i < entries.size() && entries[i].node == id && entries[i].label == label; ++i) {
+                    run.push_back(entries[i].entry);
+                }
+                Node* node = get_node_unlocked(id);
+                if (outgoing) node->add_outgoing_edges(label, run.data(), run.data() + run.size());
+                else node->add_incoming_edges(label, run.data(), run.data() + run.size());
+                mark_dirty(id);
+            }
+        };
+        attach(out_entries, true);
+        attach(in_entries, false);
 
-        return Edges_[id].get();
+        for (auto& [index, entries] : index_entries) index->insert_batch(std::move(entries));
+        // The batch reaches the store in one pass, now that the adjacency is complete
+        if (store_) {
+            for (NodeID id : result.node_ids) store_record(*get_node_unlocked(id));
+            for (EdgeID id : result.edge_ids) store_record(*find_edge(edge_shard(id), id));
+        }
+
+        node_count_.fetch_add(nodes.size(), std::memory_order_relaxed);
+        edge_count_.fetch_add(edges.size(), std::memory_order_relaxed);
+        if (!nodes.empty() || !edges.empty()) version_.fetch_add(1, std::memory_order_release);
+        return result;
     }
     Node* Graph::get_node(NodeID id){
-        std::shared_lock lock(mutex_);
-        if(!has_node(id)){
-            return nullptr;
-        }
-        return Nodes_[id].get();
+        NodeShard& shard = node_shard(id);
+        auto lock = read_lock(shard);
+        return get_node_unlocked(id);
+    }
+    RecordRef<Node> Graph::get_node_ref(NodeID id) {
+        NodeShard& shard = node_shard(id);
+        auto lock = read_lock(shard);
+        return {find_node(shard, id), store_ != nullptr};
     }
     bool  Graph::has_node(NodeID id){
-        auto it=Nodes_.find(id);
-        return it!=Nodes_.end();
+        return get_node(id) != nullptr;
     }
     Node* Graph::get_node_unlocked(NodeID id) {
-    auto it = Nodes_.find(id);
-    return (it != Nodes_.end()) ? it->second.get() : nullptr;
+    return find_node(node_shard(id), id);
+    }
+    Node* Graph::find_node(NodeShard& shard, NodeID id) {
+        Node* node = shard.nodes.get(id);
+        if (node || !store_) return node;
+        return page_in(shard, id);
+    }
+    Edge* Graph::find_edge(EdgeShard& shard, EdgeID id) {
+        Edge* edge = shard.edges.get(id);
+        if (edge || !store_) return edge;
+        return page_in(shard, id);
+    }
+    Node* Graph::unlink_node(NodeShard& shard, NodeID id) {
+        Node* node = find_node(shard, id);
+        if (!node) return nullptr;
+        shard.nodes.erase(id);
+        if (store_) store_->erase(storage::RecordKind::Node, id);
+        return node;
+    }
+    Edge* Graph::unlink_edge(EdgeShard& shard, EdgeID id) {
+        Edge* edge = find_edge(shard, id);
+        if (!edge) return nullptr;
+        shard.edges.erase(id);
+        if (store_) store_->erase(storage::RecordKind::Edge, id);
+        return edge;
     }
 
     bool Graph::has_edge(EdgeID id){
-        auto it=Edges_.find(id);
-        return it!=Edges_.end();
+        return get_edge(id) != nullptr;
     }
     Edge* Graph::get_edge(EdgeID id){
-        std::shared_lock lock(mutex_);
-        if(!has_edge(id)){
-            return nullptr;
-        }
-        return Edges_[id].get();
+        EdgeShard& shard = edge_shard(id);
+        auto lock = read_lock(shard);
+        return find_edge(shard, id);
+    }
+    RecordRef<Edge> Graph::get_edge_ref(EdgeID id) {
+        EdgeShard& shard = edge_shard(id);
+        auto lock = read_lock(shard);
+        return {find_edge(shard, id), store_ != nullptr};
     }
     EdgeID Graph::create_edge(NodeID from, NodeID to, const std::string& label) {
-        std::unique_lock lock(mutex_);
+        LabelID label_id = labels_.intern(label);
+        auto locks = lock_endpoints(from, to);
 
         // Validate nodes exist
-        if (Nodes_.find(from) == Nodes_.end()) {
+        Node* from_node = get_node_unlocked(from);
+        Node* to_node = get_node_unlocked(to);
+        if (!from_node) {
             throw std::runtime_error("create_edge: from node does not exist");
         }
-        if (Nodes_.find(to) == Nodes_.end()) {
+        if (!to_node) {
             throw std::runtime_error("create_edge: to node does not exist");
         }
 
-        EdgeID id = next_edge_id_++;
-        Edges_[id] = std::make_unique<Edge>(id, from, to, label);
+        EdgeID id;
+        for (;;) {
+            id = next_edge_id_.fetch_add(1, std::memory_order_relaxed);
+            require_storable(id, "create_edge");
+            EdgeShard& shard = edge_shard(id);
+            auto edge_lock = write_lock(shard);
+            // As in create_node(): an explicit ID may have taken this one first
+            if (find_edge(shard, id)) continue;
+            Edge* edge = insert_edge(shard, id, from, to, label, label_id, 1);
+            if (store_) store_record(*edge);
+            break;
+        }
 
         // Update nodes' edge lists
-        Nodes_[from]->add_outgoing_edge(id);
-        Nodes_[to]->add_incoming_edge(id);
+        from_node->add_outgoing_edge(id, to, 1, label_id);
+        to_node->add_incoming_edge(id, from, 1, label_id);
+        edge_count_.fetch_add(1, std::memory_order_relaxed);
+        version_.fetch_add(1, std::memory_order_release);
+        mark_dirty(from);
+        mark_dirty(to);
 
         return id;
     }
     bool Graph::remove_edge(EdgeID id) {
-        std::unique_lock lock(mutex_);   // lock graph
-
-        auto it = Edges_.find(id);
-        if (it == Edges_.end()) {
+        NodeID from_id, to_id;
+        if (!edge_endpoints(id, from_id, to_id)) {
             return false;   // edge not found
         }
+        auto locks = lock_endpoints(from_id, to_id);
+        // Removing an edge needs both endpoint shards, so it cannot vanish after this check
+        if (!edge_endpoints(id, from_id, to_id)) {
+            return false;   // lost a race with another remover
+        }
 
-        Edge* E = it->second.get();
-        Node* from = get_node_unlocked(E->from_node());  // these should still lock node’s mutex, not graph’s
-        Node* to   = get_node_unlocked(E->to_node());
-
-        if (from) {
+        if (Node* from = get_node_unlocked(from_id)) {
             from->remove_outgoing_edge(id);
         }
-        if (to) {
+        if (Node* to = get_node_unlocked(to_id)) {
             to->remove_incoming_edge(id);
         }
-
-        Edges_.erase(it);   // finally erase edge
+        {
+            EdgeShard& shard = edge_shard(id);
+            auto edge_lock = write_lock(shard);
+            destroy_edge(shard, unlink_edge(shard, id));   // finally erase edge
+        }
+        edge_count_.fetch_sub(1, std::memory_order_relaxed);
+        version_.fetch_add(1, std::memory_order_release);
+        mark_dirty(from_id);
+        mark_dirty(to_id);
         return true;
     }
-    std::vector<NodeID> Graph::get_neighbors(NodeID id){
-        std::shared_lock lock (mutex_);
-        std::vector<NodeID>neighbors;
-        if(!has_node(id)){
-            return neighbors;
+    bool Graph::set_edge_weight(EdgeID id, int64_t weight) {
+        NodeID from, to;
+        if (!edge_endpoints(id, from, to)) {
+            return false;
+        }
+        auto locks = lock_endpoints(from, to);
+        {
+            EdgeShard& shard = edge_shard(id);
+            auto edge_lock = write_lock(shard);
+            Edge* edge = find_edge(shard, id);
+            if (!edge) {
+                return false;
+            }
+            edge->set_weight(weight);
+        }
+        get_node_unlocked(from)->set_outgoing_weight(id, weight);
+        get_node_unlocked(to)->set_incoming_weight(id, weight);
+        version_.fetch_add(1, std::memory_order_release);
+        mark_dirty(from);
+        mark_dirty(to);
+        return true;
+    }
+    void Graph::mark_dirty(NodeID id) {
+        // Nothing to patch until a snapshot exists, and past half the shard a full re-read is cheaper
+        NodeShard& shard = node_shard(id);
+        if (!snapshot_ || shard.all_dirty) return;
+        shard.dirty.insert(id);
+        if (shard.dirty.size() > shard.node_count / 2) {
+            shard.all_dirty = true;
+            shard.dirty.clear();
+        }
+    }
+    std::shared_ptr<const CSRGraph> Graph::snapshot() {
+        std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+        // Writers hold a unique shard lock, so with every shard shared the graph and its bookkeeping are stable
+        std::vector<NodeLock> node_locks;
+        std::vector<EdgeLock> edge_locks;
+        node_locks.reserve(kShardCount);
+        edge_locks.reserve(kShardCount);
+        for (auto& shard : node_shards_) node_locks.push_back(read_lock(shard));
+        for (auto& shard : edge_shards_) edge_locks.push_back(read_lock(shard));
+
+        uint64_t version = version_.load(std::memory_order_acquire);
+        if (snapshot_ && snapshot_->version_ == version) {
+            return snapshot_;
         }
-        Node * N=get_node(id);
-        for( EdgeID edge: N->get_out_edges()){
-            Edge *E=get_edge(edge);
-            neighbors.push_back(E->to_node());
+        using VertexIndex = CSRGraph::VertexIndex;
+        const CSRGraph* prev = snapshot_.get();
+        auto csr = std::make_shared<CSRGraph>();
+        csr->version_ = version;
+
+        bool node_set_changed = false;
+        for (const auto& shard : node_shards_) node_set_changed |= shard.node_set_changed;
+        auto is_dirty = [this](NodeID id) {
+            const NodeShard& shard = node_shard(id);
+            return shard.all_dirty || shard.dirty.count(id) > 0;
+        };
+
+        // Dense renumbering in NodeID order
+        if (prev && !node_set_changed) {
+            csr->ids_ = prev->ids_;
+        } else {
+            csr->ids_.reserve(node_count_.load(std::memory_order_relaxed));
+            if (store_) {
+                for_each_stored(storage::RecordKind::Node, [&csr](uint64_t id) { csr->ids_.push_back(id); });
+            } else {
+                for (const auto& shard : node_shards_) {
+                    shard.nodes.for_each([&csr](Node* node) { csr->ids_.push_back(node->get_id()); });
+                }
+                std::sort(csr->ids_.begin(), csr->ids_.end());
+            }
         }
+        const size_t n = csr->ids_.size();
+        const size_t m = edge_count_.load(std::memory_order_relaxed);
+
+        // Map each new vertex to its row in the previous snapshot and old targets to new indices
+        std::vector<VertexIndex> old_of_new;
+        std::vector<VertexIndex> new_of_old;
+        if (prev) {
+            old_of_new.assign(n, CSRGraph::kInvalidVertex);
+            new_of_old.assign(prev->ids_.size(), CSRGraph::kInvalidVertex);
+            size_t i = 0, j = 0;
+            while (i < n && j < prev->ids_.size()) {
+                if (csr->ids_[i] < prev->ids_[j]) ++i;
+                else if (prev->ids_[j] < csr->ids_[i]) ++j;
+                else {
+                    old_of_new[i] = static_cast<VertexIndex>(j);
+                    new_of_old[j] = static_cast<VertexIndex>(i);
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+
+        auto build_rows = [&](bool outgoing, std::vector<uint64_t>& offsets, std::vector<VertexIndex>& targets,
+                              std::vector<int64_t>& weights, std::vector<EdgeID>& edges) {
+            offsets.assign(1, 0);
+            offsets.reserve(n + 1);
+            targets.reserve(m);
+            weights.reserve(m);
+            edges.reserve(m);
+            std::vector<std::tuple<EdgeID, VertexIndex, int64_t>> row;
+            for (size_t v = 0; v < n; ++v) {
+                NodeID id = csr->ids_[v];
+                VertexIndex old = prev ? old_of_new[v] : CSRGraph::kInvalidVertex;
+                if (old != CSRGraph::kInvalidVertex && !is_dirty(id)) {
+                    // Untouched since the last snapshot: copy the row, renumbering targets
+                    auto old_targets = outgoing ? prev->out_neighbors(old) : prev->in_neighbors(old);
+                    auto old_weights = outgoing ? prev->out_weights(old) : prev->in_weights(old);
+                    auto old_edges = outgoing ? prev->out_edges(old) : prev->in_edges(old);
+                    for (size_t k = 0; k < old_targets.size(); ++k) {
+                        targets.push_back(node_set_changed ? new_of_old[old_targets[k]] : old_targets[k]);
+                    }
+                    weights.insert(weights.end(), old_weights.begin(), old_weights.end());
+                    edges.insert(edges.end(), old_edges.begin(), old_edges.end());
+                } else {
+                    row.clear();
+                    auto collect = [&row, &csr](EdgeID eid, NodeID other, int64_t weight) {
+                        row.emplace_back(eid, csr->index_of(other), weight);
+                    };
+                    visit_edges(*get_node_unlocked(id), outgoing, collect);
+                    // Every shard is held exclusively if paged, so the working set can shed as rows stream by
+                    trim(node_shard(id));
+                    std::sort(row.begin(), row.end());
+                    for (const auto& [eid, target, weight] : row) {
+                        edges.push_back(eid);
+                        targets.push_back(target);
+                        weights.push_back(weight);
+                    }
+                }
+                offsets.push_back(targets.size());
+            }
+        };
+        build_rows(true, csr->out_offsets_, csr->out_targets_, csr->out_weights_, csr->out_edges_);
+        build_rows(false, csr->in_offsets_, csr->in_sources_, csr->in_weights_, csr->in_edges_);
+
+        for (auto& shard : node_shards_) {
+            shard.dirty.clear();
+            shard.all_dirty = false;
+            shard.node_set_changed = false;
+        }
+        snapshot_ = csr;
+        return snapshot_;
+    }
+    std::vector<NodeID> Graph::get_neighbors(NodeID id){
+        std::vector<NodeID>neighbors;
+        for_each_out_neighbor(id, [&neighbors](NodeID target) { neighbors.push_back(target); });
         return neighbors;
     }
-}
\ No newline at end of file
+}
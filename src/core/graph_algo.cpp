@@ -1,77 +1,76 @@
 #include"../../include/graph_db/graph_algo.h"
 #include"../../include/graph_db/graph.h"
 
+#include <functional>
 #include <limits>
 #include <queue>
 #include <unordered_map>
 namespace graph_db{
-    std::vector<NodeID> bfs(Graph& g, NodeID start) {
-        std::vector<NodeID> visited;
-        std::queue<NodeID> q;
-        std::unordered_map<NodeID, bool> in_queue;
-
-        q.push(start);
-        in_queue[start] = true;
-
-        while (!q.empty()) {
-            NodeID current = q.front();
-            q.pop();
-            visited.push_back(current);
+    using VertexIndex = CSRGraph::VertexIndex;
 
-            for (const auto& neighbor : g.get_neighbors(current)) {
-                if (in_queue.find(neighbor) == in_queue.end()) {
-                    q.push(neighbor);
-                    in_queue[neighbor] = true;
-                }
-            }
-        }
+    std::vector<NodeID> bfs(Graph& g, NodeID start) {
+        return bfs(*g.snapshot(), start);
+    }
 
-        return visited;
+    std::vector<NodeID> bfs(const CSRGraph& g, NodeID start) {
+        return bfs_level(g, start, std::numeric_limits<int>::max());
     }
 
     std::vector<NodeID> bfs_level(Graph& g,NodeID start , int level){
-        std::vector<NodeID> visited;
-        std::queue<std::pair<NodeID,int>> q; // Pair of NodeID and its level
-        std::unordered_map<NodeID, bool> in_queue;
-
-        q.push({start, 0});
-        in_queue[start] = true;
-
-        while (!q.empty()) {
-            auto [current, curr_level] = q.front();
-            q.pop();
-
-            if(curr_level > level) break; // Stop if we exceed the desired level
-
-            visited.push_back(current);
+        return bfs_level(*g.snapshot(), start, level);
+    }
 
-            for (const auto& neighbor : g.get_neighbors(current)) {
-                if (in_queue.find(neighbor) == in_queue.end()) {
-                    q.push({neighbor, curr_level + 1});
-                    in_queue[neighbor] = true;
+    std::vector<NodeID> bfs_level(const CSRGraph& g, NodeID start, int level) {
+        std::vector<NodeID> visited;
+        VertexIndex source = g.index_of(start);
+        if (source == CSRGraph::kInvalidVertex || level < 0) return visited;
+
+        // The output doubles as the queue: [head, level_end) is the current level
+        std::vector<VertexIndex> order;
+        std::vector<bool> seen(g.num_vertices(), false);
+        order.push_back(source);
+        seen[source] = true;
+        size_t head = 0;
+        for (int depth = 0; depth < level && head < order.size(); ++depth) {
+            size_t level_end = order.size();
+            for (; head < level_end; ++head) {
+                for (VertexIndex neighbor : g.out_neighbors(order[head])) {
+                    if (!seen[neighbor]) {
+                        seen[neighbor] = true;
+                        order.push_back(neighbor);
+                    }
                 }
             }
         }
 
+        visited.reserve(order.size());
+        for (VertexIndex v : order) visited.push_back(g.node_id(v));
         return visited;
     }
 
     std::vector<NodeID> dfs(Graph& g, NodeID start) {
+        return dfs(*g.snapshot(), start);
+    }
+
+    std::vector<NodeID> dfs(const CSRGraph& g, NodeID start) {
         std::vector<NodeID> visited;
-        std::stack<NodeID> s;
-        std::unordered_map<NodeID, bool> in_stack;
+        VertexIndex source = g.index_of(start);
+        if (source == CSRGraph::kInvalidVertex) return visited;
+
+        std::vector<VertexIndex> s;
+        std::vector<bool> in_stack(g.num_vertices(), false);
 
-        s.push(start);
-        in_stack[start] = true;
+        s.push_back(source);
+        in_stack[source] = true;
 
         while (!s.empty()) {
-            NodeID current = s.top();
-            s.pop();
-            visited.push_back(current);
+            VertexIndex current = s.back();
+            s.pop_back();
+            visited.push_back(g.node_id(current));
 
-            for (const auto& neighbor : g.get_neighbors(current)) {
-                if (in_stack.find(neighbor) == in_stack.end()) {
-                    s.push(neighbor);
+            for (VertexIndex neighbor : g.out_neighbors(current)) {
+                if (!in_stack[neighbor]) {
+                    s.push_back(neighbor);
                     in_stack[neighbor] = true;
                 }
             }
@@ -79,42 +78,45 @@ namespace graph_db{
 
         return visited;
     }
-    
+
     std::unordered_map<NodeID, int64_t> dijkstra(Graph& g, NodeID start) {
+        return dijkstra(*g.snapshot(), start);
+    }
+
+    std::unordered_map<NodeID, int64_t> dijkstra(const CSRGraph& g, NodeID start) {
+        constexpr int64_t kInfinity = std::numeric_limits<int64_t>::max();
         std::unordered_map<NodeID, int64_t> distances;
-        auto cmp = [&distances](NodeID left, NodeID right) { return distances[left] > distances[right]; };
-        std::priority_queue<NodeID, std::vector<NodeID>, decltype(cmp)> pq(cmp);
+        VertexIndex source = g.index_of(start);
+        if (source == CSRGraph::kInvalidVertex) return distances;
 
-        for (const auto& [node_id, _] : g.get_all_nodes()) {
-            distances[node_id] = std::numeric_limits<int64_t>::max();
-        }
-        distances[start] = 0;
-        pq.push(start);
+        std::vector<int64_t> dist(g.num_vertices(), kInfinity);
+        // Entries carry their distance so the heap order never changes under it;
+        // stale entries are skipped when popped.
+        using Entry = std::pair<int64_t, VertexIndex>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        dist[source] = 0;
+        pq.push({0, source});
 
         while (!pq.empty()) {
-            NodeID current = pq.top();
+            auto [d, current] = pq.top();
             pq.pop();
-
-            for (const auto& neighbor : g.get_neighbors(current)) {
-                Edge* edge = nullptr;
-                // Find the edge between current and neighbor
-                for (const auto& edge_id : g.get_node_unlocked(current)->get_out_edges()) {
-                    Edge* e = g.get_edge(edge_id);
-                    if (e && e->to_node() == neighbor) {
-                        edge = e;
-                        break;
-                    }
-                }
-                if (!edge) continue; // No edge found
-
-                int64_t new_dist = distances[current] + edge->get_weight();
-                if (new_dist < distances[neighbor]) {
-                    distances[neighbor] = new_dist;
-                    pq.push(neighbor);
+            if (d > dist[current]) continue;
+
+            auto neighbors = g.out_neighbors(current);
+            auto weights = g.out_weights(current);
+            for (size_t i = 0; i < neighbors.size(); ++i) {
+                int64_t new_dist = d + weights[i];
+                if (new_dist < dist[neighbors[i]]) {
+                    dist[neighbors[i]] = new_dist;
+                    pq.push({new_dist, neighbors[i]});
                 }
             }
         }
 
+        distances.reserve(g.num_vertices());
+        for (size_t v = 0; v < g.num_vertices(); ++v) {
+            distances[g.node_id(static_cast<VertexIndex>(v))] = dist[v];
+        }
         return distances;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,329 @@
+#include "../../include/graph_db/graph.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace graph_db {
+
+namespace {
+
+// Record layouts, all integers in host order:
+//   node: id, properties, out adjacency, in adjacency
+//   edge: id, from, to, weight, label slot, label, properties
+//   properties: u32 count, then per entry the key and a type tag and value
+//   adjacency: u32 partitions, then per partition the label, u32 count and the entries
+// Labels are stored by name since LabelIDs are only stable within one process.
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void put_string(std::string& out, const std::string& value) {
+    put<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+void put_properties(std::string& out, const PropertyMap& properties) {
+    put<uint32_t>(out, static_cast<uint32_t>(properties.size()));
+    for (const auto& [key, value] : properties) {
+        put_string(out, key);
+        out.push_back(static_cast<char>(value.index()));
+        std::visit([&out](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) put_string(out, v);
+            else put<T>(out, v);
+        }, value);
+    }
+}
+
+// Bounds-checked reads from a record
+class RecordReader {
+public:
+    explicit RecordReader(const std::string& record) : at_(record.data()), end_(record.data() + record.size()) {}
+
+    template <typename T>
+    T take() {
+        T value;
+        std::memcpy(&value, bytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+    std::string take_string() {
+        uint32_t size = take<uint32_t>();
+        return std::string(bytes(size), size);
+    }
+    PropertyMap take_properties() {
+        PropertyMap properties;
+        for (uint32_t n = take<uint32_t>(); n > 0; --n) {
+            std::string key = take_string();
+            switch (take<uint8_t>()) {
+                case 0: properties[key] = take<int64_t>(); break;
+                case 1: properties[key] = take<double>(); break;
+                case 2: properties[key] = take_string(); break;
+                case 3: properties[key] = take<bool>(); break;
+                default: throw std::runtime_error("paged storage: unknown property type");
+            }
+        }
+        return properties;
+    }
+    const char* bytes(size_t size) {
+        if (static_cast<size_t>(end_ - at_) < size) throw std::runtime_error("paged storage: truncated record");
+        const char* start = at_;
+        at_ += size;
+        return start;
+    }
+
+private:
+    const char* at_;
+    const char* end_;
+};
+
+// IDs read from the store's directories per call
+constexpr size_t kStoredBatch = 4096;
+
+// Drops the oldest records of `resident` from the table until it is within `budget`.
+// Pinned records go to the back of the queue instead, so each is looked at once per call.
+template <typename T, typename Table, typename WriteBack>
+void shed(Table& table, ObjectPool<T>& pool, std::deque<uint64_t>& resident, size_t budget,
+          WriteBack write_back) noexcept {
+    for (size_t left = resident.size(); table.size() > budget && left > 0; --left) {
+        uint64_t id = resident.front();
+        resident.pop_front();
+        T* record = table.get(id);
+        if (!record) continue;
+        if (record->pinned()) {
+            resident.push_back(id);
+            continue;
+        }
+        try {
+            write_back(*record);
+        } catch (...) {
+            resident.push_front(id); // stays cached, and the next trim tries again
+            return;
+        }
+        table.erase(id);
+        pool.destroy(record);
+    }
+    // Removed records leave their IDs behind
+    if (resident.size() > 2 * (table.size() + budget)) {
+        resident.erase(std::remove_if(resident.begin(), resident.end(),
+                                      [&table](uint64_t id) { return !table.contains(id); }),
+                       resident.end());
+    }
+}
+
+// Frees the retired records nothing pins any more. Pins on a removed record are only
+// ever copied from a live reference, so an unpinned one stays unpinned.
+template <typename T>
+void reclaim(ObjectPool<T>& pool, std::vector<T*>& retired) noexcept {
+    auto pinned = std::partition(retired.begin(), retired.end(), [](T* record) { return record->pinned(); });
+    for (auto it = pinned; it != retired.end(); ++it) pool.destroy(*it);
+    retired.erase(pinned, retired.end());
+}
+
+} // namespace
+
+Graph::Graph(const GraphOptions& options) {
+    if (options.storage == StorageEngine::InMemory) return;
+    if (options.path.empty()) throw std::runtime_error("paged storage: no file given");
+    store_ = std::make_unique<storage::PagedGraphStore>(options.path, options.pool_pages, options.replacer);
+    shard_cache_ = std::max(options.cache_records / kShardCount, kMinShardCache);
+    load_stored();
+}
+
+void Graph::load_stored() {
+    for_each_stored(storage::RecordKind::Node, [this](uint64_t id) {
+        ++node_shard(id).node_count;
+        node_count_.fetch_add(1, std::memory_order_relaxed);
+        next_node_id_.store(id + 1, std::memory_order_relaxed);
+    });
+    // The label index is not stored, so every edge is read once
+    std::string record;
+    for_each_stored(storage::RecordKind::Edge, [&](uint64_t id) {
+        store_->read(storage::RecordKind::Edge, id, record);
+        uint32_t label_slot;
+        EdgeRecord stored = decode_edge(record, label_slot);
+        std::vector<EdgeID>& labeled = edge_shard(id).by_label[labels_.intern(stored.label)];
+        if (labeled.size() <= label_slot) labeled.resize(label_slot + 1);
+        labeled[label_slot] = id;
+        edge_count_.fetch_add(1, std::memory_order_relaxed);
+        next_edge_id_.store(id + 1, std::memory_order_relaxed);
+    });
+}
+
+void Graph::flush() {
+    if (!store_) return;
+    auto locks = lock_all_shards();
+    for (auto& shard : node_shards_) shard.nodes.for_each([this](Node* node) { write_back(*node); });
+    for (auto& shard : edge_shards_) shard.edges.for_each([this](Edge* edge) { write_back(*edge); });
+    store_->flush();
+}
+
+void Graph::for_each_stored(storage::RecordKind kind, const std::function<void(uint64_t)>& fn) {
+    for (uint64_t from = 0;;) {
+        std::vector<uint64_t> ids = store_->ids(kind, from, kStoredBatch);
+        for (uint64_t id : ids) fn(id);
+        if (ids.size() < kStoredBatch) return;
+        from = ids.back() + 1;
+    }
+}
+
+void Graph::for_each_stored_batch(storage::RecordKind kind,
+                                  const std::function<void(size_t, const std::vector<uint64_t>&)>& fn) {
+    std::array<std::vector<uint64_t>, kShardCount> buckets;
+    for (uint64_t from = 0;;) {
+        std::vector<uint64_t> ids = store_->ids(kind, from, kStoredBatch);
+        for (uint64_t id : ids) buckets[shard_index(id)].push_back(id);
+        for (size_t s = 0; s < kShardCount; ++s) {
+            if (buckets[s].empty()) continue;
+            fn(s, buckets[s]);
+            buckets[s].clear();
+        }
+        if (ids.size() < kStoredBatch) return;
+        from = ids.back() + 1;
+    }
+}
+
+std::array<std::vector<uint64_t>, Graph::kShardCount> Graph::stored_by_shard(storage::RecordKind kind) {
+    std::array<std::vector<uint64_t>, kShardCount> buckets;
+    if (store_) for_each_stored(kind, [&](uint64_t id) { buckets[shard_index(id)].push_back(id); });
+    return buckets;
+}
+
+Node* Graph::page_in(NodeShard& shard, NodeID id) {
+    std::string record;
+    if (!store_->read(storage::RecordKind::Node, id, record)) return nullptr;
+    Node* node = shard.pool.create(id);
+    try {
+        node->set_index_manager(&index_manager_);
+        decode(record, *node);
+    } catch (...) {
+        shard.pool.destroy(node);
+        throw;
+    }
+    node->mark_clean();
+    shard.nodes.insert(id, node);
+    shard.resident.push_back(id);
+    return node;
+}
+
+Edge* Graph::page_in(EdgeShard& shard, EdgeID id) {
+    std::string record;
+    if (!store_->read(storage::RecordKind::Edge, id, record)) return nullptr;
+    uint32_t label_slot;
+    EdgeRecord stored = decode_edge(record, label_slot);
+    Edge* edge = shard.pool.create(id, stored.from, stored.to, stored.label, stored.weight);
+    edge->set_index_manager(&edge_index_manager_);
+    edge->set_label_id(labels_.intern(stored.label));
+    edge->set_label_slot(label_slot);
+    edge->init_properties(std::move(stored.properties));
+    edge->mark_clean();
+    shard.edges.insert(id, edge);
+    shard.resident.push_back(id);
+    return edge;
+}
+
+void Graph::write_back(Node& node) {
+    if (node.is_dirty()) store_record(node);
+}
+
+void Graph::write_back(Edge& edge) {
+    if (edge.is_dirty()) store_record(edge);
+}
+
+void Graph::store_record(Node& node) {
+    store_->write(storage::RecordKind::Node, node.get_id(), encode(node));
+    node.mark_clean();
+}
+
+void Graph::store_record(Edge& edge) {
+    store_->write(storage::RecordKind::Edge, edge.id(), encode(edge));
+    edge.mark_clean();
+}
+
+void Graph::trim(NodeShard& shard) noexcept {
+    if (!store_) return;
+    if (!shard.retired.empty()) reclaim(shard.pool, shard.retired);
+    shed(shard.nodes, shard.pool, shard.resident, shard_cache_, [this](Node& node) { write_back(node); });
+}
+
+void Graph::trim(EdgeShard& shard) noexcept {
+    if (!store_) return;
+    if (!shard.retired.empty()) reclaim(shard.pool, shard.retired);
+    shed(shard.edges, shard.pool, shard.resident, shard_cache_, [this](Edge& edge) { write_back(edge); });
+}
+
+void Graph::release(NodeShard& shard, Node* node) noexcept {
+    if (node->pinned()) shard.retired.push_back(node);
+    else shard.pool.destroy(node);
+}
+
+void Graph::release(EdgeShard& shard, Edge* edge) noexcept {
+    if (edge->pinned()) shard.retired.push_back(edge);
+    else shard.pool.destroy(edge);
+}
+
+std::string Graph::encode(Node& node) {
+    std::string out;
+    put<uint64_t>(out, node.get_id());
+    put_properties(out, node.get_properties());
+    auto put_adjacency = [this, &out](auto&& for_each_partition) {
+        size_t count_at = out.size();
+        uint32_t partitions = 0;
+        put<uint32_t>(out, 0);
+        for_each_partition([&](LabelID label, const AdjacencyList& list) {
+            put_string(out, labels_.name(label));
+            put<uint32_t>(out, static_cast<uint32_t>(list.size()));
+            out.append(reinterpret_cast<const char*>(list.begin()), list.size() * sizeof(AdjacencyEntry));
+            ++partitions;
+        });
+        std::memcpy(&out[count_at], &partitions, sizeof(partitions));
+    };
+    put_adjacency([&node](auto&& fn) { node.for_each_out_partition(fn); });
+    put_adjacency([&node](auto&& fn) { node.for_each_in_partition(fn); });
+    return out;
+}
+
+std::string Graph::encode(Edge& edge) {
+    std::string out;
+    put<uint64_t>(out, edge.id());
+    put<uint64_t>(out, edge.from_node());
+    put<uint64_t>(out, edge.to_node());
+    put<int64_t>(out, edge.get_weight());
+    put<uint32_t>(out, edge.label_slot());
+    put_string(out, edge.label());
+    put_properties(out, edge.get_properties());
+    return out;
+}
+
+void Graph::decode(const std::string& record, Node& node) {
+    RecordReader in(record);
+    if (in.take<uint64_t>() != node.get_id()) throw std::runtime_error("paged storage: record of another node");
+    node.init_properties(in.take_properties());
+    std::vector<AdjacencyEntry> entries;
+    for (bool outgoing : {true, false}) {
+        for (uint32_t partitions = in.take<uint32_t>(); partitions > 0; --partitions) {
+            LabelID label = labels_.intern(in.take_string());
+            uint32_t count = in.take<uint32_t>();
+            const char* bytes = in.bytes(size_t{count} * sizeof(AdjacencyEntry));
+            entries.resize(count);
+            std::memcpy(entries.data(), bytes, entries.size() * sizeof(AdjacencyEntry));
+            if (outgoing) node.add_outgoing_edges(label, entries.data(), entries.data() + entries.size());
+            else node.add_incoming_edges(label, entries.data(), entries.data() + entries.size());
+        }
+    }
+}
+
+EdgeRecord Graph::decode_edge(const std::string& record, uint32_t& label_slot) {
+    RecordReader in(record);
+    EdgeRecord edge;
+    edge.id = in.take<uint64_t>();
+    edge.from = in.take<uint64_t>();
+    edge.to = in.take<uint64_t>();
+    edge.weight = in.take<int64_t>();
+    label_slot = in.take<uint32_t>();
+    edge.label = in.take_string();
+    edge.properties = in.take_properties();
+    return edge;
+}
+
+} // namespace graph_db
@@ -4,30 +4,49 @@
 #include<unordered_set>
 #include<shared_mutex>
 namespace graph_db{
-    void Node::add_outgoing_edge(EdgeID edge_id){
+    void Node::add_outgoing_edge(EdgeID edge_id, NodeID target, int64_t weight, LabelID label){
         std::unique_lock lock(mutex_);
-        Outgoing_Edges_.insert(edge_id);
+        dirty_ = true;
+        Outgoing_Edges_.add(label, {edge_id, target, weight});
     }
-    void Node::add_incoming_edge(EdgeID edge_id){
+    void Node::add_incoming_edge(EdgeID edge_id, NodeID source, int64_t weight, LabelID label){
         std::unique_lock lock(mutex_);
-        Incoming_Edges_.insert(edge_id);
+        dirty_ = true;
+        Incoming_Edges_.add(label, {edge_id, source, weight});
+    }
+    void Node::add_outgoing_edges(LabelID label, const AdjacencyEntry* first, const AdjacencyEntry* last){
+        std::unique_lock lock(mutex_);
+        dirty_ = true;
+        Outgoing_Edges_.add(label, first, last);
+    }
+    void Node::add_incoming_edges(LabelID label, const AdjacencyEntry* first, const AdjacencyEntry* last){
+        std::unique_lock lock(mutex_);
+        dirty_ = true;
+        Incoming_Edges_.add(label, first, last);
     }
     void Node::remove_incoming_edge(EdgeID edge_id){
         std::unique_lock lock(mutex_);
-        auto it=Incoming_Edges_.find(edge_id);
-        if(it!=Incoming_Edges_.end()){
-            Incoming_Edges_.erase(it);
-        }
+        dirty_ = true;
+        Incoming_Edges_.remove(edge_id);
     }
     void Node::remove_outgoing_edge(EdgeID edge_id){
         std::unique_lock lock(mutex_);
-        auto it =Outgoing_Edges_.find(edge_id);
-        if(it!=Outgoing_Edges_.end()){
-            Outgoing_Edges_.erase(it);
-        }
+        dirty_ = true;
+        Outgoing_Edges_.remove(edge_id);
+    }
+    void Node::set_outgoing_weight(EdgeID edge_id, int64_t weight){
+        std::unique_lock lock(mutex_);
+        dirty_ = true;
+        Outgoing_Edges_.set_weight(edge_id, weight);
+    }
+    void Node::set_incoming_weight(EdgeID edge_id, int64_t weight){
+        std::unique_lock lock(mutex_);
+        dirty_ = true;
+        Incoming_Edges_.set_weight(edge_id, weight);
     }
     void Node::set_property(std::string key,PropertyValue p){
         std::unique_lock lock(mutex_);
+        dirty_ = true;
         if (index_manager_) {
             if (auto index = index_manager_->get_index(key)) {
                 // If property exists, remove old value from index first
@@ -36,9 +55,29 @@ namespace graph_db{
                 }
                 index->insert(p, id_);
             }
+            for (CompositeIndex* composite : index_manager_->composites_with(key)) {
+                composite->replace(composite->key_of(properties_), composite->key_of(properties_, key, &p), id_);
+            }
         }
         properties_[key] = p;
     }
+    void Node::init_properties(PropertyMap properties){
+        std::unique_lock lock(mutex_);
+        dirty_ = true;
+        properties_ = std::move(properties);
+    }
+    void Node::unindex_properties(){
+        std::unique_lock lock(mutex_);
+        if (!index_manager_) return;
+        for (const auto& [key, value] : properties_) {
+            if (auto index = index_manager_->get_index(key)) {
+                index->remove(value, id_);
+            }
+        }
+        for (CompositeIndex* composite : index_manager_->composites_with()) {
+            composite->replace(composite->key_of(properties_), std::nullopt, id_);
+        }
+    }
     bool Node:: has_property(std::string s){
         if(properties_.find(s)!=properties_.end()){
             return true;
@@ -47,12 +86,16 @@ namespace graph_db{
     }
     void Node::remove_property(std::string s){
         std::unique_lock lock(mutex_);
+        dirty_ = true;
         if (index_manager_) {
             if (auto index = index_manager_->get_index(s)) {
                 if (properties_.count(s)) {
                     index->remove(properties_.at(s), id_);
                 }
             }
+            for (CompositeIndex* composite : index_manager_->composites_with(s)) {
+                composite->replace(composite->key_of(properties_), composite->key_of(properties_, s, nullptr), id_);
+            }
         }
         properties_.erase(s);
     }
@@ -64,12 +107,26 @@ namespace graph_db{
         }
         return it->second;
     }
+    std::optional<std::string> Node::composite_key(const CompositeIndex& index) const {
+        std::shared_lock lock(mutex_);
+        return index.key_of(properties_);
+    }
+    std::optional<PropertyValue> Node::find_property(const std::string& key) const {
+        std::shared_lock lock(mutex_);
+        auto it = properties_.find(key);
+        if (it == properties_.end()) return std::nullopt;
+        return it->second;
+    }
     std::unordered_set<EdgeID> Node:: get_out_edges(){
         std::shared_lock lock(mutex_);
-          return Outgoing_Edges_;
+        std::unordered_set<EdgeID> edges;
+        Outgoing_Edges_.for_each([&edges](const AdjacencyEntry& e) { edges.insert(e.edge); });
+        return edges;
     }
     std::unordered_set<EdgeID> Node:: get_in_edges(){
         std::shared_lock lock(mutex_);
-        return Incoming_Edges_;
+        std::unordered_set<EdgeID> edges;
+        Incoming_Edges_.for_each([&edges](const AdjacencyEntry& e) { edges.insert(e.edge); });
+        return edges;
     }
 }
\ No newline at end of file
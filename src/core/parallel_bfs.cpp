@@ -0,0 +1,115 @@
+#include "../../include/graph_db/graph_algo.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace graph_db {
+
+namespace {
+
+using VertexIndex = CSRGraph::VertexIndex;
+
+// Beamer et al.: go bottom-up once the frontier's edges exceed 1/alpha of the unexplored
+// edges, and back to top-down when the frontier drops below 1/beta of the vertices.
+constexpr size_t kAlpha = 15;
+constexpr size_t kBeta = 18;
+constexpr size_t kTopDownGrain = 64;     // frontier vertices per chunk
+constexpr size_t kBottomUpGrain = 4096;  // vertices per chunk, a multiple of 64 bits
+
+class AtomicBitmap {
+public:
+    explicit AtomicBitmap(size_t bits) : words_((bits + 63) / 64) {}
+
+    // True if this call flipped the bit from 0 to 1
+    bool set(VertexIndex v) {
+        uint64_t mask = uint64_t{1} << (v & 63);
+        return (words_[v >> 6].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+    bool test(VertexIndex v) const {
+        return (words_[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1;
+    }
+    void clear() {
+        for (auto& w : words_) w.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<std::atomic<uint64_t>> words_;
+};
+
+} // namespace
+
+std::vector<NodeID> parallel_bfs(Graph& g, NodeID start) {
+    return parallel_bfs(*g.snapshot(), start, parallel::ThreadPool::global());
+}
+
+std::vector<NodeID> parallel_bfs(const CSRGraph& g, NodeID start, parallel::ThreadPool& pool) {
+    std::vector<NodeID> order;
+    VertexIndex source = g.index_of(start);
+    if (source == CSRGraph::kInvalidVertex) return order;
+
+    const size_t n = g.num_vertices();
+    AtomicBitmap visited(n);
+    AtomicBitmap in_frontier(n);
+    std::vector<std::vector<VertexIndex>> next(pool.size());
+    std::vector<size_t> next_scout(pool.size());
+
+    std::vector<VertexIndex> frontier{source};
+    visited.set(source);
+    order.push_back(start);
+    size_t scout = g.out_degree(source);   // edges leaving the frontier
+    size_t unexplored = g.num_edges();     // edges not yet examined top-down
+    bool bottom_up = false;
+
+    while (!frontier.empty()) {
+        if (!bottom_up && scout > unexplored / kAlpha) {
+            bottom_up = true;
+        } else if (bottom_up && frontier.size() < n / kBeta) {
+            bottom_up = false;
+        }
+        for (auto& buffer : next) buffer.clear();
+        std::fill(next_scout.begin(), next_scout.end(), 0);
+
+        if (bottom_up) {
+            in_frontier.clear();
+            for (VertexIndex v : frontier) in_frontier.set(v);
+            pool.parallel_for(0, n, kBottomUpGrain, [&](size_t lo, size_t hi, size_t worker) {
+                for (size_t i = lo; i < hi; ++i) {
+                    VertexIndex v = static_cast<VertexIndex>(i);
+                    if (visited.test(v)) continue;
+                    for (VertexIndex parent : g.in_neighbors(v)) {
+                        if (in_frontier.test(parent)) {
+                            // Only this chunk looks at v, so a plain set is enough
+                            visited.set(v);
+                            next[worker].push_back(v);
+                            next_scout[worker] += g.out_degree(v);
+                            break;
+                        }
+                    }
+                }
+            });
+        } else {
+            pool.parallel_for(0, frontier.size(), kTopDownGrain, [&](size_t lo, size_t hi, size_t worker) {
+                for (size_t i = lo; i < hi; ++i) {
+                    for (VertexIndex child : g.out_neighbors(frontier[i])) {
+                        if (!visited.test(child) && visited.set(child)) {
+                            next[worker].push_back(child);
+                            next_scout[worker] += g.out_degree(child);
+                        }
+                    }
+                }
+            });
+        }
+
+        unexplored -= std::min(unexplored, scout);
+        frontier.clear();
+        scout = 0;
+        for (size_t w = 0; w < next.size(); ++w) {
+            frontier.insert(frontier.end(), next[w].begin(), next[w].end());
+            scout += next_scout[w];
+        }
+        for (VertexIndex v : frontier) order.push_back(g.node_id(v));
+    }
+    return order;
+}
+
+}
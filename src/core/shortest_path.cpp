@@ -0,0 +1,159 @@
+#include "../../include/graph_db/graph_algo.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace graph_db {
+
+namespace {
+
+constexpr int64_t kInfinity = std::numeric_limits<int64_t>::max();
+
+struct Label {
+    int64_t dist = kInfinity;
+    NodeID parent = 0; // previous node towards this search's origin
+    EdgeID edge = 0;   // edge connecting parent and this node
+    bool settled = false;
+};
+
+using Labels = std::unordered_map<NodeID, Label>;
+using Entry = std::pair<int64_t, NodeID>; // (priority, node)
+using MinQueue = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+// Appends `node` and its parents up to the search origin, with the edges between them
+void walk_back(const Labels& labels, NodeID origin, NodeID node,
+               std::vector<NodeID>& nodes, std::vector<EdgeID>& edges) {
+    nodes.push_back(node);
+    while (node != origin) {
+        const Label& label = labels.at(node);
+        edges.push_back(label.edge);
+        node = label.parent;
+        nodes.push_back(node);
+    }
+}
+
+PathResult unidirectional(Graph& g, NodeID source, NodeID target, const PathOptions& options) {
+    PathResult result;
+    Labels labels;
+    MinQueue queue;
+    auto h = [&](NodeID v) { return options.heuristic ? options.heuristic(v) : 0; };
+
+    labels[source].dist = 0;
+    queue.push({h(source), source});
+    while (!queue.empty()) {
+        auto [priority, u] = queue.top();
+        queue.pop();
+        Label& label = labels[u];
+        // Stale entry: the node was re-queued with a better distance since
+        if (priority - h(u) > label.dist) continue;
+        label.settled = true;
+        ++result.settled;
+        if (u == target) break;
+
+        int64_t du = label.dist;
+        g.for_each_out_edge(u, [&](EdgeID e, NodeID v, int64_t w) {
+            Label& next = labels[v];
+            if (du + w < next.dist) {
+                next.dist = du + w;
+                next.parent = u;
+                next.edge = e;
+                queue.push({next.dist + h(v), v});
+            }
+        });
+    }
+
+    auto it = labels.find(target);
+    if (it == labels.end() || !it->second.settled) return result;
+    result.found = true;
+    result.distance = it->second.dist;
+    walk_back(labels, source, target, result.nodes, result.edges);
+    std::reverse(result.nodes.begin(), result.nodes.end());
+    std::reverse(result.edges.begin(), result.edges.end());
+    return result;
+}
+
+PathResult bidirectional(Graph& g, NodeID source, NodeID target) {
+    PathResult result;
+    Labels forward, backward;
+    MinQueue forward_queue, backward_queue;
+    forward[source].dist = 0;
+    backward[target].dist = 0;
+    forward_queue.push({0, source});
+    backward_queue.push({0, target});
+
+    // Best path found so far: forward chain to meet_from, meet_edge, backward chain from meet_to
+    int64_t best = kInfinity;
+    NodeID meet_from = 0, meet_to = 0;
+    EdgeID meet_edge = 0;
+
+    auto top = [](MinQueue& q) { return q.empty() ? kInfinity : q.top().first; };
+    while (!forward_queue.empty() && !backward_queue.empty()) {
+        // No path through an unsettled vertex can beat `best` once the radii cover it
+        int64_t f = top(forward_queue), b = top(backward_queue);
+        if (best != kInfinity && f + b >= best) break;
+
+        bool go_forward = forward_queue.size() <= backward_queue.size();
+        MinQueue& queue = go_forward ? forward_queue : backward_queue;
+        Labels& mine = go_forward ? forward : backward;
+        Labels& other = go_forward ? backward : forward;
+
+        auto [du, u] = queue.top();
+        queue.pop();
+        Label& label = mine[u];
+        if (du > label.dist || label.settled) continue;
+        label.settled = true;
+        ++result.settled;
+
+        auto relax = [&](EdgeID e, NodeID v, int64_t w) {
+            Label& next = mine[v];
+            if (du + w < next.dist) {
+                next.dist = du + w;
+                next.parent = u;
+                next.edge = e;
+                queue.push({next.dist, v});
+            }
+            auto meet = other.find(v);
+            if (meet != other.end() && meet->second.dist != kInfinity && du + w + meet->second.dist < best) {
+                best = du + w + meet->second.dist;
+                meet_from = go_forward ? u : v;
+                meet_to = go_forward ? v : u;
+                meet_edge = e;
+            }
+        };
+        if (go_forward) g.for_each_out_edge(u, relax);
+        else g.for_each_in_edge(u, relax);
+    }
+
+    if (best == kInfinity) return result;
+    result.found = true;
+    result.distance = best;
+    walk_back(forward, source, meet_from, result.nodes, result.edges);
+    std::reverse(result.nodes.begin(), result.nodes.end());
+    std::reverse(result.edges.begin(), result.edges.end());
+    result.edges.push_back(meet_edge);
+    std::vector<NodeID> tail;
+    walk_back(backward, target, meet_to, tail, result.edges);
+    result.nodes.insert(result.nodes.end(), tail.begin(), tail.end());
+    return result;
+}
+
+} // namespace
+
+PathResult shortest_path(Graph& g, NodeID source, NodeID target, const PathOptions& options) {
+    PathResult result;
+    if (!g.get_node(source) || !g.get_node(target)) return result;
+    if (source == target) {
+        result.found = true;
+        result.distance = 0;
+        result.nodes.push_back(source);
+        return result;
+    }
+    if (options.heuristic || !options.bidirectional) {
+        return unidirectional(g, source, target, options);
+    }
+    return bidirectional(g, source, target);
+}
+
+}
@@ -0,0 +1,287 @@
+#include "../../include/graph_db/generator/graph_generator.h"
+#include "../../include/graph_db/graph.h"
+#include "../../include/graph_db/storage/serializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace graph_db {
+namespace generator {
+
+namespace {
+
+// Separate streams so changing e.g. the label config never changes the topology
+constexpr uint64_t kTopologyStream = 0x9e3779b97f4a7c15ULL;
+constexpr uint64_t kDecorateStream = 0xbf58476d1ce4e5b9ULL;
+constexpr uint64_t kPropertyStream = 0x94d049bb133111ebULL;
+
+// mt19937_64 output is fixed by the standard, but the <random> distributions are
+// not, so draw bounded values ourselves to stay reproducible across toolchains.
+class Rng {
+public:
+    Rng(uint64_t seed, uint64_t stream) : engine_(seed ^ stream) {}
+
+    uint64_t next() { return engine_(); }
+
+    // Uniform in [0, bound)
+    uint64_t below(uint64_t bound) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+    // Uniform in [0, 1)
+    double unit() { return (next() >> 11) * 0x1.0p-53; }
+
+private:
+    std::mt19937_64 engine_;
+};
+
+// Zipf(s) over [0, n) via an inverted CDF table; s == 0 degenerates to uniform
+class ZipfSampler {
+public:
+    ZipfSampler(size_t n, double skew) : n_(n) {
+        if (skew <= 0.0 || n <= 1) return;
+        cdf_.resize(n);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+            cdf_[i] = sum;
+        }
+        for (double& v : cdf_) v /= sum;
+    }
+
+    uint64_t sample(Rng& rng) const {
+        if (cdf_.empty()) return n_ > 0 ? rng.below(n_) : 0;
+        auto it = std::upper_bound(cdf_.begin(), cdf_.end(), rng.unit());
+        return std::min<uint64_t>(it - cdf_.begin(), n_ - 1);
+    }
+
+private:
+    size_t n_;
+    std::vector<double> cdf_;
+};
+
+void validate(const GeneratorConfig& config) {
+    if (config.labels.empty()) {
+        throw std::invalid_argument("generator: at least one edge label is required");
+    }
+    if (config.min_weight > config.max_weight) {
+        throw std::invalid_argument("generator: min_weight > max_weight");
+    }
+}
+
+// Assigns labels and weights once the topology is fixed
+void decorate(EdgeList& list, const GeneratorConfig& config) {
+    Rng rng(config.seed, kDecorateStream);
+    ZipfSampler labels(config.labels.size(), config.label_skew);
+    uint64_t weight_span = static_cast<uint64_t>(config.max_weight - config.min_weight) + 1;
+    for (auto& e : list.edges) {
+        e.label = static_cast<uint32_t>(labels.sample(rng));
+        e.weight = config.min_weight + static_cast<int64_t>(rng.below(weight_span));
+    }
+}
+
+class PropertyGenerator {
+public:
+    explicit PropertyGenerator(const GeneratorConfig& config)
+        : rng_(config.seed, kPropertyStream),
+          values_(config.property_cardinality, config.property_skew) {
+        for (size_t k = 0; k < config.node_properties; ++k) {
+            keys_.push_back("p" + std::to_string(k));
+        }
+    }
+
+    PropertyMap next() {
+        PropertyMap props;
+        for (const auto& key : keys_) {
+            props[key] = static_cast<int64_t>(values_.sample(rng_));
+        }
+        return props;
+    }
+
+private:
+    Rng rng_;
+    ZipfSampler values_;
+    std::vector<std::string> keys_;
+};
+
+} // namespace
+
+EdgeList rmat(uint32_t scale, size_t edge_factor, const GeneratorConfig& config,
+              double a, double b, double c) {
+    validate(config);
+    if (scale >= 63) {
+        throw std::invalid_argument("rmat: scale too large");
+    }
+    if (a < 0 || b < 0 || c < 0 || a + b + c > 1.0) {
+        throw std::invalid_argument("rmat: quadrant probabilities must be non-negative and sum to <= 1");
+    }
+    EdgeList list;
+    list.num_nodes = size_t{1} << scale;
+    size_t edges = edge_factor * list.num_nodes;
+    list.edges.reserve(edges);
+
+    Rng rng(config.seed, kTopologyStream);
+    double ab = a + b;
+    double abc = a + b + c;
+    while (list.edges.size() < edges) {
+        uint64_t u = 0, v = 0;
+        for (uint32_t level = 0; level < scale; ++level) {
+            double r = rng.unit();
+            u <<= 1;
+            v <<= 1;
+            if (r < a) {
+            } else if (r < ab) {
+                v |= 1;
+            } else if (r < abc) {
+                u |= 1;
+            } else {
+                u |= 1;
+                v |= 1;
+            }
+        }
+        if (u == v && !config.allow_self_loops && list.num_nodes > 1) continue;
+        list.edges.push_back({u, v, 0, 1});
+    }
+
+    // Shuffle vertex indices so hub vertices are spread across the ID space
+    std::vector<uint64_t> perm(list.num_nodes);
+    for (uint64_t i = 0; i < perm.size(); ++i) perm[i] = i;
+    for (uint64_t i = perm.size(); i > 1; --i) {
+        std::swap(perm[i - 1], perm[rng.below(i)]);
+    }
+    for (auto& e : list.edges) {
+        e.from = perm[e.from];
+        e.to = perm[e.to];
+    }
+
+    decorate(list, config);
+    return list;
+}
+
+EdgeList barabasi_albert(size_t nodes, size_t edges_per_node, const GeneratorConfig& config) {
+    validate(config);
+    if (edges_per_node == 0 || nodes <= edges_per_node) {
+        throw std::invalid_argument("barabasi_albert: need nodes > edges_per_node > 0");
+    }
+    EdgeList list;
+    list.num_nodes = nodes;
+    list.edges.reserve((nodes - edges_per_node) * edges_per_node);
+
+    Rng rng(config.seed, kTopologyStream);
+    // Every edge endpoint appears here once, so a uniform pick is degree-proportional
+    std::vector<uint64_t> endpoints;
+    endpoints.reserve(2 * list.edges.capacity());
+
+    // Seed vertex m links to all of 0..m-1
+    uint64_t m = edges_per_node;
+    for (uint64_t t = 0; t < m; ++t) {
+        list.edges.push_back({m, t, 0, 1});
+        endpoints.push_back(m);
+        endpoints.push_back(t);
+    }
+
+    std::vector<uint64_t> targets;
+    for (uint64_t v = m + 1; v < nodes; ++v) {
+        targets.clear();
+        while (targets.size() < m) {
+            uint64_t t = endpoints[rng.below(endpoints.size())];
+            if (std::find(targets.begin(), targets.end(), t) == targets.end()) {
+                targets.push_back(t);
+            }
+        }
+        for (uint64_t t : targets) {
+            list.edges.push_back({v, t, 0, 1});
+            endpoints.push_back(v);
+            endpoints.push_back(t);
+        }
+    }
+
+    decorate(list, config);
+    return list;
+}
+
+EdgeList grid(size_t rows, size_t cols, bool bidirectional, const GeneratorConfig& config) {
+    validate(config);
+    EdgeList list;
+    list.num_nodes = rows * cols;
+    for (uint64_t r = 0; r < rows; ++r) {
+        for (uint64_t c = 0; c < cols; ++c) {
+            uint64_t v = r * cols + c;
+            if (c + 1 < cols) {
+                list.edges.push_back({v, v + 1, 0, 1});
+                if (bidirectional) list.edges.push_back({v + 1, v, 0, 1});
+            }
+            if (r + 1 < rows) {
+                list.edges.push_back({v, v + cols, 0, 1});
+                if (bidirectional) list.edges.push_back({v + cols, v, 0, 1});
+            }
+        }
+    }
+    decorate(list, config);
+    return list;
+}
+
+EdgeList erdos_renyi(size_t nodes, size_t edges, const GeneratorConfig& config) {
+    validate(config);
+    if (nodes == 0 && edges > 0) {
+        throw std::invalid_argument("erdos_renyi: cannot place edges without nodes");
+    }
+    EdgeList list;
+    list.num_nodes = nodes;
+    list.edges.reserve(edges);
+    Rng rng(config.seed, kTopologyStream);
+    while (list.edges.size() < edges) {
+        uint64_t u = rng.below(nodes);
+        uint64_t v = rng.below(nodes);
+        if (u == v && !config.allow_self_loops && nodes > 1) continue;
+        list.edges.push_back({u, v, 0, 1});
+    }
+    decorate(list, config);
+    return list;
+}
+
+std::vector<NodeID> populate(Graph& graph, const EdgeList& list, const GeneratorConfig& config) {
+    PropertyGenerator properties(config);
+    std::vector<NodeRecord> nodes(list.num_nodes);
+    if (config.node_properties > 0) {
+        for (auto& node : nodes) node.properties = properties.next();
+    }
+    std::vector<NodeID> ids = graph.bulk_insert(std::move(nodes), {}).node_ids;
+
+    std::vector<EdgeRecord> edges(list.edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const auto& e = list.edges[i];
+        edges[i].from = ids[e.from];
+        edges[i].to = ids[e.to];
+        edges[i].label = config.labels[e.label];
+        edges[i].weight = e.weight;
+    }
+    graph.bulk_insert({}, std::move(edges));
+    return ids;
+}
+
+bool write_to_file(const std::string& filename, const EdgeList& list, const GeneratorConfig& config) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    PropertyGenerator properties(config);
+    storage::Serializer::write_count(out, list.num_nodes);
+    for (size_t i = 0; i < list.num_nodes; ++i) {
+        storage::Serializer::write_node_record(out, static_cast<NodeID>(i + 1), properties.next());
+    }
+    const PropertyMap no_properties;
+    storage::Serializer::write_count(out, list.edges.size());
+    for (size_t j = 0; j < list.edges.size(); ++j) {
+        const auto& e = list.edges[j];
+        storage::Serializer::write_edge_record(out, static_cast<EdgeID>(j + 1), e.from + 1, e.to + 1,
+                                               config.labels[e.label], no_properties);
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace generator
+} // namespace graph_db
@@ -6,6 +6,7 @@
 #include <limits>
 #include "graph_db/graph.h"
 #include "graph_db/graph_algo.h"
+#include "graph_db/storage/csv_importer.h"
 #include "graph_db/query/query_parser.h"
 
 // Helper to convert string to uppercase for case-insensitive commands
@@ -41,25 +42,80 @@ graph_db::PropertyValue parse_property_value(const std::string& val_str) {
     return val_str;
 }
 
+// FIND NODES WHERE <key> <predicate> [DESC] [LIMIT <n>]  |  FIND NODES ORDER BY <key> [ASC|DESC] [LIMIT <n>]
+std::vector<graph_db::NodeID> run_find(graph_db::Graph& g, std::stringstream& ss) {
+    std::string nodes, clause, key, op;
+    ss >> nodes >> clause;
+    to_upper(nodes);
+    to_upper(clause);
+    if (nodes != "NODES") throw std::runtime_error("Invalid FIND syntax.");
+    graph_db::RangeScan scan;
+    std::string prefix;
+    bool by_prefix = false;
+    if (clause == "ORDER") {
+        ss >> op >> key; // BY <key>
+    } else if (clause == "WHERE") {
+        std::string value, extra;
+        ss >> key >> op;
+        to_upper(op);
+        if (op == "BETWEEN") {
+            ss >> value >> extra; // <lo> AND
+            scan.lower = graph_db::RangeBound{parse_property_value(value)};
+            ss >> value;
+            scan.upper = graph_db::RangeBound{parse_property_value(value)};
+        } else if (op == "STARTS") {
+            ss >> extra >> prefix; // WITH <prefix>
+            by_prefix = true;
+        } else {
+            ss >> value;
+            graph_db::RangeBound bound{parse_property_value(value), op != "<" && op != ">"};
+            if (op == "=") scan.lower = scan.upper = bound;
+            else if (op == ">" || op == ">=") scan.lower = bound;
+            else if (op == "<" || op == "<=") scan.upper = bound;
+            else throw std::runtime_error("Unknown FIND operator: " + op);
+        }
+    } else {
+        throw std::runtime_error("Invalid FIND syntax.");
+    }
+    std::string token;
+    while (ss >> token) {
+        to_upper(token);
+        if (token == "DESC") scan.descending = true;
+        else if (token == "LIMIT") ss >> scan.limit;
+        else if (token != "ASC") throw std::runtime_error("Unexpected FIND token: " + token);
+    }
+    return by_prefix ? g.find_nodes_with_prefix(key, prefix, scan.limit) : g.find_nodes_in_range(key, scan);
+}
+
 void print_help() {
     std::cout << "\n--- GraphDB Command-Line Interface ---\n"
               << "Available Commands:\n"
               << "  CREATE NODE\n"
               << "  CREATE EDGE FROM <from_id> TO <to_id> LABEL <label> [WEIGHT <weight>]\n"
-              << "  CREATE INDEX ON <property_key>\n"
+              << "  CREATE INDEX ON <property_key> [USING BTREE|HASH|PAGED]\n"
+              << "  CREATE INDEX ON (<key>, <key>, ...) [USING BTREE|HASH|PAGED]\n"
               << "  SET PROPERTY ON NODE <id> KEY <key> VALUE <value>\n"
               << "  SET PROPERTY ON EDGE <id> KEY <key> VALUE <value>\n"
               << "  GET NODE <id>\n"
               << "  GET EDGE <id>\n"
               << "  REMOVE NODE <id>\n"
+              << "  REMOVE NODES <id> [<id> ...]\n"
               << "  REMOVE EDGE <id>\n"
+              << "  FIND NODES WHERE <key> =|<|<=|>|>= <value> [DESC] [LIMIT <n>]\n"
+              << "  FIND NODES WHERE <key> BETWEEN <low> AND <high> [DESC] [LIMIT <n>]\n"
+              << "  FIND NODES WHERE <key> STARTS WITH <prefix> [LIMIT <n>]\n"
+              << "  FIND NODES ORDER BY <key> [ASC|DESC] [LIMIT <n>]\n"
               << "  PRINT GRAPH\n"
               << "  SAVE <filename>\n"
               << "  LOAD <filename>\n"
+              << "  OPEN INDEXES <filename>\n"
+              << "  IMPORT NODES <csv_file>\n"
+              << "  IMPORT EDGES <csv_file>\n"
               << "  -- Traversal Queries --\n"
-              << "  BFS FROM <start_node_id>\n"
+              << "  BFS FROM <start_node_id> [PARALLEL]\n"
               << "  DFS FROM <start_node_id>\n"
               << "  SHORTEST PATH FROM <start_node_id> TO <end_node_id>\n"
+              << "  SSSP FROM <start_node_id> [DELTA <delta>]\n"
               << "  -- Other --\n"
               << "  HELP\n"
               << "  EXIT\n"
@@ -125,13 +181,42 @@ int main() {
                         ss >> weight;
                     }
                     graph_db::EdgeID id = g.create_edge(from, to, label);
-                    g.get_edge(id)->set_weight(weight);
+                    g.set_edge_weight(id, weight);
                     std::cout << "Created edge with ID: " << id << " from " << from << " to " << to << std::endl;
                 } else if (type == "INDEX") {
-                    std::string on_token, key;
-                    ss >> on_token >> key;
-                    g.create_index(key);
-                    std::cout << "Created index on property: " << key << std::endl;
+                    std::string on_token, key, using_token, kind;
+                    std::vector<std::string> keys;
+                    ss >> on_token >> std::ws;
+                    if (ss.peek() == '(') {
+                        // Composite: (k1, k2, ...)
+                        ss.get();
+                        std::getline(ss, key, ')');
+                        std::stringstream list(key);
+                        for (std::string column; std::getline(list >> std::ws, column, ',');) {
+                            column.erase(column.find_last_not_of(" \t") + 1);
+                            keys.push_back(column);
+                        }
+                    } else {
+                        ss >> key;
+                    }
+                    ss >> using_token >> kind;
+                    to_upper(using_token);
+                    to_upper(kind);
+                    bool hash = using_token == "USING" && kind == "HASH";
+                    bool paged = using_token == "USING" && kind == "PAGED";
+                    if (!using_token.empty() && !hash && !paged && !(using_token == "USING" && kind == "BTREE")) {
+                        throw std::runtime_error("Invalid CREATE INDEX syntax. Use USING BTREE, HASH or PAGED.");
+                    }
+                    auto index_kind = hash ? graph_db::IndexKind::Hash
+                                    : paged ? graph_db::IndexKind::Paged : graph_db::IndexKind::BTree;
+                    if (keys.empty()) {
+                        g.create_index(key, index_kind);
+                    } else {
+                        g.create_composite_index(keys, index_kind);
+                        key = "(" + key + ")";
+                    }
+                    std::cout << "Created " << (hash ? "hash " : paged ? "paged " : "") << "index on property: " << key
+                              << std::endl;
                 } else {
                     std::cerr << "Unknown CREATE type. Use NODE, EDGE, or INDEX." << std::endl;
                 }
@@ -194,26 +279,35 @@ int main() {
             } else if (command == "REMOVE") {
                 std::string type;
                 graph_db::NodeID id;
-                ss >> type >> id;
+                ss >> type;
                 to_upper(type);
-                if(type == "NODE"){
+                if (type == "NODES") {
+                    std::vector<graph_db::NodeID> ids;
+                    while (ss >> id) ids.push_back(id);
+                    std::cout << "Removed " << g.remove_nodes(ids) << " nodes" << std::endl;
+                } else if(type == "NODE" && ss >> id){
                     if(g.remove_node(id)) std::cout << "Removed node " << id << std::endl;
                     else std::cerr << "Node " << id << " not found." << std::endl;
-                } else if (type == "EDGE"){
+                } else if (type == "EDGE" && ss >> id){
                     if(g.remove_edge(id)) std::cout << "Removed edge " << id << std::endl;
                     else std::cerr << "Edge " << id << " not found." << std::endl;
                 }
+            } else if (command == "FIND") {
+                auto ids = run_find(g, ss);
+                std::cout << "Found " << ids.size() << " nodes:";
+                for (auto id : ids) std::cout << " " << id;
+                std::cout << std::endl;
             } else if (command == "PRINT") {
                  std::cout << "--- Current Graph State ---\n"
                            << "Nodes (" << g.node_count() << "):\n";
-                 for(const auto& [id, node] : g.get_all_nodes()) {
-                     std::cout << "  - Node " << id << "\n";
-                 }
+                 g.for_each_node([](graph_db::Node& node) {
+                     std::cout << "  - Node " << node.get_id() << "\n";
+                 });
                  std::cout << "Edges (" << g.edge_count() << "):\n";
-                 for(const auto& [id, edge] : g.get_all_edges()) {
-                     std::cout << "  - Edge " << id << " (" << edge->from_node() 
-                               << " -> " << edge->to_node() << ")\n";
-                 }
+                 g.for_each_edge([](graph_db::Edge& edge) {
+                     std::cout << "  - Edge " << edge.id() << " (" << edge.from_node() 
+                               << " -> " << edge.to_node() << ")\n";
+                 });
                  std::cout << "---------------------------\n";
             } else if (command == "SAVE") {
                 std::string filename;
@@ -225,12 +319,35 @@ int main() {
                 ss >> filename;
                 if(g.load_from_file(filename)) std::cout << "Graph loaded from " << filename << std::endl;
                 else std::cerr << "Failed to load graph from " << filename << std::endl;
-            } else if (command == "BFS" || command == "DFS" || command == "SHORTEST") {
+            } else if (command == "OPEN") {
+                std::string what, filename;
+                ss >> what >> filename;
+                to_upper(what);
+                if (what != "INDEXES" || filename.empty()) throw std::runtime_error("Usage: OPEN INDEXES <filename>");
+                g.open_index_file(filename);
+                std::cout << "Index file " << filename << " opened" << std::endl;
+            } else if (command == "IMPORT") {
+                std::string kind, filename;
+                ss >> kind >> filename;
+                to_upper(kind);
+                graph_db::storage::CsvImporter importer(g);
+                if (kind == "NODES") {
+                    auto stats = importer.import_nodes(filename);
+                    std::cout << "Imported " << stats.nodes << " nodes from " << filename << std::endl;
+                } else if (kind == "EDGES") {
+                    auto stats = importer.import_edges(filename);
+                    std::cout << "Imported " << stats.edges << " edges from " << filename << std::endl;
+                } else {
+                    std::cerr << "Usage: IMPORT NODES|EDGES <csv_file>" << std::endl;
+                }
+            } else if (command == "BFS" || command == "DFS" || command == "SHORTEST" || command == "SSSP") {
                 auto parsed_query = traversal_parser.parse(line);
                  switch (parsed_query.type) {
                     case graph_db::query::QueryType::BFS: {
-                        auto results = graph_db::bfs(g, parsed_query.start_node);
-                        std::cout << "BFS Result: ";
+                        auto results = parsed_query.parallel
+                            ? graph_db::parallel_bfs(g, parsed_query.start_node)
+                            : graph_db::bfs(g, parsed_query.start_node);
+                        std::cout << (parsed_query.parallel ? "Parallel BFS Result: " : "BFS Result: ");
                         for(auto n : results) std::cout << n << " ";
                         std::cout << std::endl;
                         break;
@@ -243,9 +360,31 @@ int main() {
                         break;
                     }
                     case graph_db::query::QueryType::DIJKSTRA: {
-                        auto results = graph_db::dijkstra(g, parsed_query.start_node);
-                        std::cout << "Shortest distance from " << parsed_query.start_node << " to " << parsed_query.end_node 
-                                  << " is: " << results[parsed_query.end_node] << std::endl;
+                        auto path = graph_db::shortest_path(g, parsed_query.start_node, parsed_query.end_node);
+                        if (!path.found) {
+                            std::cout << "No path from " << parsed_query.start_node << " to " << parsed_query.end_node << std::endl;
+                            break;
+                        }
+                        std::cout << "Shortest distance from " << parsed_query.start_node << " to " << parsed_query.end_node
+                                  << " is: " << path.distance << std::endl;
+                        std::cout << "Path: " << path.nodes[0];
+                        for (size_t i = 0; i < path.edges.size(); ++i) {
+                            std::cout << " -[" << path.edges[i] << "]-> " << path.nodes[i + 1];
+                        }
+                        std::cout << std::endl;
+                        break;
+                    }
+                    case graph_db::query::QueryType::SSSP: {
+                        auto results = graph_db::delta_stepping(g, parsed_query.start_node, parsed_query.delta);
+                        std::vector<std::pair<graph_db::NodeID, int64_t>> reached;
+                        for (const auto& [id, dist] : results) {
+                            if (dist != std::numeric_limits<int64_t>::max()) reached.emplace_back(id, dist);
+                        }
+                        std::sort(reached.begin(), reached.end());
+                        std::cout << "Distances from " << parsed_query.start_node << ":\n";
+                        for (const auto& [id, dist] : reached) {
+                            std::cout << "  " << id << ": " << dist << "\n";
+                        }
                         break;
                     }
                     default:
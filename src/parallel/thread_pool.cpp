@@ -0,0 +1,141 @@
+#include "../../include/graph_db/parallel/thread_pool.h"
+#include <algorithm>
+
+namespace graph_db {
+namespace parallel {
+
+namespace {
+// Set while a thread is executing chunks, so nested loops run inline instead of deadlocking
+thread_local bool in_parallel_region = false;
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(1, threads);
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t w = 1; w < threads; ++w) {
+        workers_.emplace_back([this, w]() { worker_loop(w); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain,
+                              const std::function<void(size_t, size_t, size_t)>& fn) {
+    if (begin >= end) return;
+    grain = std::max<size_t>(1, grain);
+    size_t chunks = (end - begin + grain - 1) / grain;
+
+    if (in_parallel_region || workers_.empty() || chunks == 1) {
+        for (size_t lo = begin; lo < end; lo += grain) {
+            fn(lo, std::min(end, lo + grain), 0);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> job_lock(job_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        // Contiguous blocks per worker keep neighbouring chunks on the same core
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t owner = c * queues_.size() / chunks;
+            std::lock_guard<std::mutex> queue_lock(queues_[owner]->mutex);
+            queues_[owner]->chunks.push_back(c);
+        }
+        job_ = &fn;
+        job_begin_ = begin;
+        job_end_ = end;
+        job_grain_ = grain;
+        error_ = nullptr;
+        finished_workers_ = 0;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    run_chunks(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        done_.wait(lock, [this]() { return finished_workers_ == workers_.size(); });
+        job_ = nullptr;
+        error = error_;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::worker_loop(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait(lock, [this, seen]() { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+        run_chunks(worker);
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++finished_workers_;
+        }
+        done_.notify_all();
+    }
+}
+
+void ThreadPool::run_chunks(size_t worker) {
+    in_parallel_region = true;
+    size_t chunk;
+    while (pop_local(worker, chunk) || steal(worker, chunk)) {
+        size_t lo = job_begin_ + chunk * job_grain_;
+        size_t hi = std::min(job_end_, lo + job_grain_);
+        try {
+            (*job_)(lo, hi, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+    }
+    in_parallel_region = false;
+}
+
+bool ThreadPool::pop_local(size_t worker, size_t& chunk) {
+    WorkQueue& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty()) return false;
+    chunk = queue.chunks.front();
+    queue.chunks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, size_t& chunk) {
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        WorkQueue& victim = *queues_[(thief + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace parallel
+} // namespace graph_db
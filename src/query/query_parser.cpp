@@ -24,6 +24,10 @@ ParsedQuery QueryParser::parse(const std::string& query) {
     if (tokens[0] == "BFS" && tokens.size() == 3 && tokens[1] == "FROM") {
         result.type = QueryType::BFS;
         result.start_node = std::stoull(tokens[2]);
+    } else if (tokens[0] == "BFS" && tokens.size() == 4 && tokens[1] == "FROM" && tokens[3] == "PARALLEL") {
+        result.type = QueryType::BFS;
+        result.start_node = std::stoull(tokens[2]);
+        result.parallel = true;
     } else if (tokens[0] == "DFS" && tokens.size() == 3 && tokens[1] == "FROM") {
         result.type = QueryType::DFS;
         result.start_node = std::stoull(tokens[2]);
@@ -31,6 +35,14 @@ ParsedQuery QueryParser::parse(const std::string& query) {
         result.type = QueryType::DIJKSTRA;
         result.start_node = std::stoull(tokens[3]);
         result.end_node = std::stoull(tokens[5]);
+    } else if (tokens[0] == "SSSP" && tokens.size() >= 3 && tokens[1] == "FROM") {
+        if (tokens.size() == 3) {
+            result.type = QueryType::SSSP;
+        } else if (tokens.size() == 5 && tokens[3] == "DELTA") {
+            result.type = QueryType::SSSP;
+            result.delta = std::stoll(tokens[4]);
+        }
+        result.start_node = std::stoull(tokens[2]);
     }
 
     return result;
@@ -0,0 +1,353 @@
+#include "../../include/graph_db/storage/csv_importer.h"
+#include "../../include/graph_db/graph.h"
+#include "../../include/graph_db/parallel/thread_pool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graph_db {
+namespace storage {
+
+namespace {
+
+// Read-only private mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw std::runtime_error("import: cannot open " + filename);
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("import: cannot stat " + filename);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) return;
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("import: cannot map " + filename);
+        }
+        ::madvise(addr, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(addr);
+    }
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        ::close(fd_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Thrown by the chunk parsers; the driver turns the offset into a line number
+struct RowError {
+    size_t offset;
+    std::string message;
+};
+
+enum class ColumnType { String, Int, Double, Bool };
+enum class Role { Property, Id, From, To, Label, Weight };
+
+struct Column {
+    std::string name;
+    ColumnType type = ColumnType::String;
+    Role role = Role::Property;
+};
+
+// Splits [begin, end) into fields. Unquoted fields point into the mapping; quoted
+// ones are unescaped into `scratch`, which is reserved up front so views stay valid.
+void split_fields(const char* begin, const char* end, char delimiter, size_t offset,
+                  std::vector<std::string_view>& fields, std::string& scratch) {
+    fields.clear();
+    scratch.clear();
+    scratch.reserve(static_cast<size_t>(end - begin));
+    const char* p = begin;
+    while (true) {
+        if (p < end && *p == '"') {
+            size_t start = scratch.size();
+            ++p;
+            while (true) {
+                if (p == end) {
+                    throw RowError{offset, "unterminated quoted field"};
+                }
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        scratch.push_back('"');
+                        p += 2;
+                        continue;
+                    }
+                    ++p;
+                    break;
+                }
+                scratch.push_back(*p++);
+            }
+            fields.emplace_back(scratch.data() + start, scratch.size() - start);
+            if (p < end && *p != delimiter) {
+                throw RowError{offset, "unexpected character after quoted field"};
+            }
+        } else {
+            const char* field_end = static_cast<const char*>(std::memchr(p, delimiter, end - p));
+            if (!field_end) field_end = end;
+            fields.emplace_back(p, field_end - p);
+            p = field_end;
+        }
+        if (p == end) break;
+        ++p; // delimiter
+    }
+}
+
+template <typename T>
+T parse_number(std::string_view field, size_t offset, const std::string& column) {
+    T value{};
+    auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (ec != std::errc() || ptr != field.data() + field.size()) {
+        throw RowError{offset, "invalid number '" + std::string(field) + "' in column " + column};
+    }
+    return value;
+}
+
+PropertyValue parse_value(std::string_view field, const Column& column, size_t offset) {
+    switch (column.type) {
+        case ColumnType::Int:
+            return parse_number<int64_t>(field, offset, column.name);
+        case ColumnType::Double:
+            return parse_number<double>(field, offset, column.name);
+        case ColumnType::Bool:
+            if (field == "true" || field == "TRUE" || field == "1") return true;
+            if (field == "false" || field == "FALSE" || field == "0") return false;
+            throw RowError{offset, "invalid bool '" + std::string(field) + "' in column " + column.name};
+        case ColumnType::String:
+            break;
+    }
+    return std::string(field);
+}
+
+// Strips the trailing '\r' of CRLF files
+const char* line_end(const char* begin, const char* end) {
+    return (end > begin && end[-1] == '\r') ? end - 1 : end;
+}
+
+std::vector<Column> parse_header(std::string_view line, char delimiter, bool edges) {
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    split_fields(line.data(), line.data() + line.size(), delimiter, 0, fields, scratch);
+
+    std::vector<Column> columns;
+    std::unordered_set<std::string> seen;
+    for (std::string_view field : fields) {
+        Column column;
+        size_t colon = field.rfind(':');
+        column.name = std::string(field.substr(0, colon));
+        if (colon != std::string_view::npos) {
+            std::string_view type = field.substr(colon + 1);
+            if (type == "string") column.type = ColumnType::String;
+            else if (type == "int") column.type = ColumnType::Int;
+            else if (type == "double") column.type = ColumnType::Double;
+            else if (type == "bool") column.type = ColumnType::Bool;
+            else throw std::runtime_error("import: unknown column type '" + std::string(type) + "'");
+        }
+        if (column.name.empty() || !seen.insert(column.name).second) {
+            throw std::runtime_error("import: empty or duplicate column name '" + column.name + "'");
+        }
+        if (column.name == "id") column.role = Role::Id;
+        else if (edges && column.name == "from") column.role = Role::From;
+        else if (edges && column.name == "to") column.role = Role::To;
+        else if (edges && column.name == "label") column.role = Role::Label;
+        else if (edges && column.name == "weight") column.role = Role::Weight;
+        columns.push_back(column);
+    }
+    if (edges && (seen.count("from") == 0 || seen.count("to") == 0)) {
+        throw std::runtime_error("import: edge files need 'from' and 'to' columns");
+    }
+    return columns;
+}
+
+uint64_t parse_id(std::string_view field, const Column& column, size_t offset) {
+    if (field.empty()) {
+        throw RowError{offset, "missing value in column " + column.name};
+    }
+    uint64_t id = parse_number<uint64_t>(field, offset, column.name);
+    if (id == 0) {
+        throw RowError{offset, "IDs must be positive in column " + column.name};
+    }
+    return id;
+}
+
+// Parses every line of [begin, end) into records of type Record
+template <typename Record, typename FillRecord>
+std::vector<Record> parse_chunk(const char* base, size_t begin, size_t end, char delimiter,
+                                size_t column_count, FillRecord&& fill) {
+    std::vector<Record> records;
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    size_t pos = begin;
+    while (pos < end) {
+        const char* line = base + pos;
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - pos));
+        const char* stop = newline ? newline : base + end;
+        const char* content_end = line_end(line, stop);
+        if (content_end != line) {
+            split_fields(line, content_end, delimiter, pos, fields, scratch);
+            if (fields.size() != column_count) {
+                throw RowError{pos, "expected " + std::to_string(column_count) + " fields, found " +
+                                        std::to_string(fields.size())};
+            }
+            records.emplace_back();
+            fill(records.back(), fields, pos);
+        }
+        pos = static_cast<size_t>(stop - base) + 1;
+    }
+    return records;
+}
+
+// Shared driver: maps the file, reads the header, then parses waves of chunks in
+// parallel and hands each chunk's records to `insert` in file order.
+template <typename Record, typename MakeFiller, typename Insert>
+size_t run_import(const std::string& filename, const ImportOptions& options, bool edges,
+                  size_t& bytes, MakeFiller&& make_filler, Insert&& insert) {
+    MappedFile file(filename);
+    bytes = file.size();
+    const char* data = file.data();
+    size_t size = file.size();
+    if (size == 0) return 0;
+
+    size_t header_start = (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+    const char* header_newline = static_cast<const char*>(std::memchr(data + header_start, '\n', size - header_start));
+    size_t body_start = header_newline ? static_cast<size_t>(header_newline - data) + 1 : size;
+    const char* header_end = line_end(data + header_start, header_newline ? header_newline : data + size);
+    std::vector<Column> columns;
+    try {
+        columns = parse_header(std::string_view(data + header_start, header_end - (data + header_start)),
+                               options.delimiter, edges);
+    } catch (const RowError& e) {
+        throw std::runtime_error("import: " + filename + ":1: " + e.message);
+    }
+    auto fill = make_filler(columns);
+
+    // Cut chunks just after a newline
+    std::vector<std::pair<size_t, size_t>> chunks;
+    size_t target = std::max<size_t>(options.chunk_bytes, 1);
+    for (size_t pos = body_start; pos < size;) {
+        size_t end = std::min(size, pos + target);
+        if (end < size) {
+            const char* newline = static_cast<const char*>(std::memchr(data + end, '\n', size - end));
+            end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+        }
+        chunks.emplace_back(pos, end);
+        pos = end;
+    }
+
+    std::unique_ptr<parallel::ThreadPool> own_pool;
+    if (options.threads > 0) own_pool = std::make_unique<parallel::ThreadPool>(options.threads);
+    parallel::ThreadPool& pool = own_pool ? *own_pool : parallel::ThreadPool::global();
+
+    // Bounded waves keep at most a few chunks of parsed records in memory
+    size_t wave = 2 * pool.size();
+    size_t total = 0;
+    std::vector<std::vector<Record>> parsed(wave);
+    for (size_t first = 0; first < chunks.size(); first += wave) {
+        size_t count = std::min(wave, chunks.size() - first);
+        try {
+            pool.parallel_for(0, count, 1, [&](size_t lo, size_t hi, size_t) {
+                for (size_t i = lo; i < hi; ++i) {
+                    const auto& [begin, end] = chunks[first + i];
+                    parsed[i] = parse_chunk<Record>(data, begin, end, options.delimiter, columns.size(), fill);
+                }
+            });
+        } catch (const RowError& e) {
+            size_t line = 1 + static_cast<size_t>(std::count(data, data + e.offset, '\n'));
+            throw std::runtime_error("import: " + filename + ":" + std::to_string(line) + ": " + e.message);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            total += parsed[i].size();
+            insert(std::move(parsed[i]));
+            parsed[i] = std::vector<Record>();
+        }
+    }
+    return total;
+}
+
+} // namespace
+
+CsvImporter::CsvImporter(Graph& graph, ImportOptions options) : graph_(graph), options_(options) {}
+
+ImportStats CsvImporter::import_nodes(const std::string& filename) {
+    ImportStats stats;
+    auto make_filler = [](const std::vector<Column>& columns) {
+        return [columns](NodeRecord& record, const std::vector<std::string_view>& fields, size_t offset) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                if (columns[i].role == Role::Id) {
+                    record.id = parse_id(fields[i], columns[i], offset);
+                } else if (!fields[i].empty()) {
+                    record.properties.emplace(columns[i].name, parse_value(fields[i], columns[i], offset));
+                }
+            }
+        };
+    };
+    stats.nodes = run_import<NodeRecord>(filename, options_, false, stats.bytes, make_filler,
+                                         [this](std::vector<NodeRecord> batch) {
+                                             graph_.bulk_insert(std::move(batch), {});
+                                         });
+    return stats;
+}
+
+ImportStats CsvImporter::import_edges(const std::string& filename) {
+    ImportStats stats;
+    auto make_filler = [](const std::vector<Column>& columns) {
+        return [columns](EdgeRecord& record, const std::vector<std::string_view>& fields, size_t offset) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                const Column& column = columns[i];
+                std::string_view field = fields[i];
+                switch (column.role) {
+                    case Role::Id:
+                        record.id = parse_id(field, column, offset);
+                        break;
+                    case Role::From:
+                        record.from = parse_id(field, column, offset);
+                        break;
+                    case Role::To:
+                        record.to = parse_id(field, column, offset);
+                        break;
+                    case Role::Label:
+                        record.label = std::string(field);
+                        break;
+                    case Role::Weight:
+                        if (!field.empty()) record.weight = parse_number<int64_t>(field, offset, column.name);
+                        break;
+                    case Role::Property:
+                        if (!field.empty()) record.properties.emplace(column.name, parse_value(field, column, offset));
+                        break;
+                }
+            }
+        };
+    };
+    stats.edges = run_import<EdgeRecord>(filename, options_, true, stats.bytes, make_filler,
+                                         [this](std::vector<EdgeRecord> batch) {
+                                             graph_.bulk_insert({}, std::move(batch));
+                                         });
+    return stats;
+}
+
+} // namespace storage
+} // namespace graph_db
@@ -1,6 +1,10 @@
 #include "../../include/graph_db/storage/disk_manager.h"
 #include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 
 namespace graph_db {
@@ -9,37 +13,58 @@ namespace storage {
 constexpr size_t PAGE_SIZE = 4096;
 
 DiskManager::DiskManager(const std::string& db_file) : file_name_(db_file) {
-    db_io_.open(db_file, std::ios::in | std::ios::out | std::ios::binary | std::ios::app);
-    if (!db_io_.is_open()) {
-        db_io_.open(db_file, std::ios::out | std::ios::binary | std::ios::app);
-        db_io_.close();
-        db_io_.open(db_file, std::ios::in | std::ios::out | std::ios::binary | std::ios::app);
+    fd_ = ::open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Error opening " + db_file + ": " + std::strerror(errno));
     }
+    // Pages already in the file belong to earlier runs
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Error opening " + db_file + ": " + std::strerror(errno));
+    }
+    next_page_id_.store(static_cast<PageID>((info.st_size + PAGE_SIZE - 1) / PAGE_SIZE), std::memory_order_relaxed);
 }
 
 DiskManager::~DiskManager() {
-    if (db_io_.is_open()) {
-        db_io_.close();
+    if (fd_ >= 0) {
+        ::close(fd_);
     }
 }
 
 void DiskManager::write_page(PageID page_id, const char* page_data) {
-    std::lock_guard<std::mutex> lock(db_io_latch_);
-    db_io_.seekp(page_id * PAGE_SIZE);
-    db_io_.write(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-        throw std::runtime_error("Error writing to file");
+    off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+    for (size_t done = 0; done < PAGE_SIZE;) {
+        ssize_t n = ::pwrite(fd_, page_data + done, PAGE_SIZE - done, offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            throw std::runtime_error("Error writing to file");
+        }
+        done += n;
     }
 }
 
 void DiskManager::read_page(PageID page_id, char* page_data) {
-    std::lock_guard<std::mutex> lock(db_io_latch_);
-    db_io_.seekg(page_id * PAGE_SIZE);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-        throw std::runtime_error("Error reading from file");
+    off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+    size_t done = 0;
+    while (done < PAGE_SIZE) {
+        ssize_t n = ::pread(fd_, page_data + done, PAGE_SIZE - done, offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            throw std::runtime_error("Error reading from file");
+        }
+        if (n == 0) break;
+        done += n;
+    }
+    // Pages past the end of the file have never been written; hand back zeroes
+    if (done < PAGE_SIZE) {
+        std::memset(page_data + done, 0, PAGE_SIZE - done);
     }
 }
 
+PageID DiskManager::allocate_page() {
+    return next_page_id_.fetch_add(1, std::memory_order_relaxed);
+}
+
 } // namespace storage
-} // namespace graph_db
\ No newline at end of file
+} // namespace graph_db
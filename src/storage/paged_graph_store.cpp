@@ -0,0 +1,403 @@
+#include "../../include/graph_db/storage/paged_graph_store.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace graph_db {
+namespace storage {
+
+using buffer::PageGuard;
+
+namespace {
+
+constexpr size_t kPageSize = sizeof(Page::data_);
+constexpr PageID kHeaderPage = 0;
+constexpr uint32_t kStoreMagic = 0x52545347; // "GSTR"
+
+enum PageType : uint8_t { kListPage = 1, kDirectoryPage, kHeapPage, kOverflowPage, kFreePage };
+
+struct StoreHeader {
+    uint32_t magic;
+    PageID lists[2]; // first directory list page per kind
+    PageID free_list;
+};
+
+// List, directory, overflow and free pages
+struct ChainHeader {
+    uint8_t type;
+    uint8_t unused;
+    uint16_t used; // overflow pages: payload bytes
+    PageID next;
+};
+
+// Heap pages. Slots follow the header; cells fill [heap, kPageSize).
+struct HeapHeader {
+    uint8_t type;
+    uint8_t unused;
+    uint16_t count;   // slots, live or free
+    uint16_t heap;    // start of the cell area
+    uint16_t garbage; // bytes of dead cells inside the cell area
+};
+struct Slot {
+    uint16_t offset; // 0 for a free slot
+    uint16_t size;
+};
+
+constexpr size_t kChainCapacity = kPageSize - sizeof(ChainHeader);
+constexpr size_t kPerList = kChainCapacity / sizeof(PageID);
+constexpr size_t kPerDirectory = kChainCapacity / sizeof(uint64_t);
+
+// Cell: tag, u32 record size, then the record (kInline) or its chain's first page
+enum CellTag : uint8_t { kInline = 0, kChained = 1 };
+constexpr size_t kCellHead = sizeof(uint8_t) + sizeof(uint32_t);
+constexpr size_t kStubSize = kCellHead + sizeof(PageID);
+
+template <typename T>
+T load(const char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+template <typename T>
+void store(char* at, T value) {
+    std::memcpy(at, &value, sizeof(T));
+}
+
+ChainHeader& chain(char* page) { return *reinterpret_cast<ChainHeader*>(page); }
+const ChainHeader& chain(const char* page) { return *reinterpret_cast<const ChainHeader*>(page); }
+HeapHeader& heap(char* page) { return *reinterpret_cast<HeapHeader*>(page); }
+const HeapHeader& heap(const char* page) { return *reinterpret_cast<const HeapHeader*>(page); }
+
+Slot slot_at(const char* page, size_t slot) {
+    return load<Slot>(page + sizeof(HeapHeader) + slot * sizeof(Slot));
+}
+void set_slot(char* page, size_t slot, Slot value) {
+    store<Slot>(page + sizeof(HeapHeader) + slot * sizeof(Slot), value);
+}
+
+size_t contiguous_space(const char* page) {
+    return heap(page).heap - sizeof(HeapHeader) - heap(page).count * sizeof(Slot);
+}
+size_t reclaimable_space(const char* page) { return contiguous_space(page) + heap(page).garbage; }
+
+// Moves the live cells to the end of the page, so all free space is contiguous
+void compact(char* page) {
+    char copy[kPageSize];
+    std::memcpy(copy, page, kPageSize);
+    HeapHeader& header = heap(page);
+    header.heap = kPageSize;
+    for (size_t i = 0; i < header.count; ++i) {
+        Slot slot = slot_at(copy, i);
+        if (slot.offset == 0) continue;
+        header.heap -= slot.size;
+        std::memcpy(page + header.heap, copy + slot.offset, slot.size);
+        set_slot(page, i, {header.heap, slot.size});
+    }
+    header.garbage = 0;
+}
+
+PageID page_of(uint64_t ref) { return static_cast<PageID>(ref >> 16); }
+size_t slot_of(uint64_t ref) { return ref & 0xFFFF; }
+uint64_t make_ref(PageID page, size_t slot) { return uint64_t{static_cast<uint32_t>(page)} << 16 | slot; }
+
+} // namespace
+
+PagedGraphStore::PagedGraphStore(const std::string& path, size_t pool_pages, buffer::ReplacerKind replacer)
+    : disk_(path), pool_(pool_pages, &disk_, buffer::PartitionedBufferPool::default_instances(pool_pages), replacer) {
+    if (disk_.num_pages() == 0) {
+        PageID id;
+        Page* fresh = pool_.new_page(&id);
+        PageGuard page(pool_, id, fresh);
+        StoreHeader& header = *reinterpret_cast<StoreHeader*>(page.write());
+        header.magic = kStoreMagic;
+        header.lists[0] = header.lists[1] = kInvalidPageID;
+        header.free_list = kInvalidPageID;
+        return;
+    }
+    PageID heads[2];
+    {
+        PageGuard page(pool_, kHeaderPage);
+        const StoreHeader& header = *reinterpret_cast<const StoreHeader*>(page.data());
+        if (header.magic != kStoreMagic) throw std::runtime_error("graph store: " + path + " is not a graph store");
+        heads[0] = header.lists[0];
+        heads[1] = header.lists[1];
+        free_list_ = header.free_list;
+    }
+    for (size_t kind = 0; kind < 2; ++kind) {
+        for (PageID id = heads[kind]; id != kInvalidPageID;) {
+            PageGuard page(pool_, id);
+            if (chain(page.data()).type != kListPage) {
+                throw std::runtime_error("graph store: page " + std::to_string(id) + " is not a directory list");
+            }
+            lists_[kind].push_back(id);
+            for (size_t i = 0; i < kPerList; ++i) {
+                directories_[kind].push_back(load<PageID>(page.data() + sizeof(ChainHeader) + i * sizeof(PageID)));
+            }
+            id = chain(page.data()).next;
+        }
+    }
+}
+
+PagedGraphStore::RecordRef PagedGraphStore::lookup(RecordKind kind, uint64_t id) {
+    const std::vector<PageID>& directories = directories_[static_cast<size_t>(kind)];
+    uint64_t block = id / kPerDirectory;
+    if (block >= directories.size() || directories[block] == 0) return 0;
+    PageGuard page(pool_, directories[block]);
+    return load<RecordRef>(page.data() + sizeof(ChainHeader) + id % kPerDirectory * sizeof(RecordRef));
+}
+
+void PagedGraphStore::set_ref(RecordKind kind, uint64_t id, RecordRef ref) {
+    std::vector<PageID>& directories = directories_[static_cast<size_t>(kind)];
+    std::vector<PageID>& lists = lists_[static_cast<size_t>(kind)];
+    uint64_t block = id / kPerDirectory;
+    if (block >= directories.size() || directories[block] == 0) {
+        if (ref == 0) return;
+        if (block >= directories.size()) directories.resize(block + 1, 0);
+        directories[block] = allocate(kDirectoryPage).id();
+        while (lists.size() <= block / kPerList) {
+            PageGuard list = allocate(kListPage);
+            if (lists.empty()) header_dirty_ = true;
+            else chain(PageGuard(pool_, lists.back()).write()).next = list.id();
+            lists.push_back(list.id());
+        }
+        PageGuard list(pool_, lists[block / kPerList]);
+        store<PageID>(list.write() + sizeof(ChainHeader) + block % kPerList * sizeof(PageID), directories[block]);
+    }
+    PageGuard page(pool_, directories[block]);
+    store<RecordRef>(page.write() + sizeof(ChainHeader) + id % kPerDirectory * sizeof(RecordRef), ref);
+}
+
+std::string PagedGraphStore::make_cell(const std::string& record) {
+    std::string cell(kCellHead, '\0');
+    store<uint32_t>(&cell[1], static_cast<uint32_t>(record.size()));
+    if (record.size() <= kMaxInline) {
+        cell[0] = static_cast<char>(kInline);
+        cell += record;
+        // Room for a stub, so the record can always move to a chain in place
+        if (cell.size() < kStubSize) cell.resize(kStubSize);
+        return cell;
+    }
+    cell[0] = static_cast<char>(kChained);
+    cell.resize(kStubSize);
+    store<PageID>(&cell[kCellHead], write_chain(record.data(), record.size()));
+    return cell;
+}
+
+void PagedGraphStore::drop_cell(const char* cell) {
+    if (static_cast<uint8_t>(cell[0]) == kChained) free_chain(load<PageID>(cell + kCellHead));
+}
+
+PagedGraphStore::RecordRef PagedGraphStore::place(const std::string& cell) {
+    auto fits = [&cell](const char* page) { return reclaimable_space(page) >= cell.size() + sizeof(Slot); };
+    PageGuard page;
+    if (fill_ != kInvalidPageID) {
+        page = PageGuard(pool_, fill_);
+        if (!fits(page.data())) page.release();
+    }
+    while (!page && !roomy_.empty()) {
+        PageID id = *roomy_.begin();
+        roomy_.erase(roomy_.begin());
+        page = PageGuard(pool_, id);
+        if (fits(page.data())) fill_ = id;
+        else page.release();
+    }
+    if (!page) {
+        page = allocate(kHeapPage);
+        fill_ = page.id();
+    }
+
+    char* data = page.write();
+    HeapHeader& header = heap(data);
+    size_t slot = 0;
+    while (slot < header.count && slot_at(data, slot).offset != 0) ++slot;
+    size_t need = cell.size() + (slot == header.count ? sizeof(Slot) : 0);
+    if (contiguous_space(data) < need) compact(data);
+    if (slot == header.count) ++header.count;
+    header.heap -= cell.size();
+    std::memcpy(data + header.heap, cell.data(), cell.size());
+    set_slot(data, slot, {header.heap, static_cast<uint16_t>(cell.size())});
+    return make_ref(page.id(), slot);
+}
+
+bool PagedGraphStore::read(RecordKind kind, uint64_t id, std::string& out) {
+    std::lock_guard lock(mutex_);
+    RecordRef ref = lookup(kind, id);
+    if (!ref) return false;
+    PageGuard page(pool_, page_of(ref));
+    const char* cell = page.data() + slot_at(page.data(), slot_of(ref)).offset;
+    uint32_t size = load<uint32_t>(cell + 1);
+    out.clear();
+    if (static_cast<uint8_t>(cell[0]) == kInline) {
+        out.assign(cell + kCellHead, size);
+        return true;
+    }
+    PageID head = load<PageID>(cell + kCellHead);
+    page.release();
+    out.reserve(size);
+    read_chain(head, out);
+    return true;
+}
+
+void PagedGraphStore::write(RecordKind kind, uint64_t id, const std::string& record) {
+    if (id >= kDenseIdLimit) throw std::runtime_error("graph store: ID " + std::to_string(id) + " is past the limit");
+    std::lock_guard lock(mutex_);
+    std::string cell = make_cell(record);
+    RecordRef ref = lookup(kind, id);
+    if (!ref) {
+        set_ref(kind, id, place(cell));
+        sync_header();
+        return;
+    }
+    PageGuard page(pool_, page_of(ref));
+    char* data = page.write();
+    HeapHeader& header = heap(data);
+    size_t pos = slot_of(ref);
+    Slot slot = slot_at(data, pos);
+    drop_cell(data + slot.offset);
+    if (cell.size() <= slot.size) {
+        std::memcpy(data + slot.offset, cell.data(), cell.size());
+        header.garbage += slot.size - cell.size();
+        set_slot(data, pos, {slot.offset, static_cast<uint16_t>(cell.size())});
+    } else {
+        // The record keeps its slot; if the page cannot take it, a stub can, since the
+        // old cell was at least as large
+        header.garbage += slot.size;
+        set_slot(data, pos, {0, 0});
+        if (reclaimable_space(data) < cell.size()) {
+            cell.resize(kStubSize);
+            cell[0] = static_cast<char>(kChained);
+            store<PageID>(&cell[kCellHead], write_chain(record.data(), record.size()));
+        }
+        if (contiguous_space(data) < cell.size()) compact(data);
+        header.heap -= cell.size();
+        std::memcpy(data + header.heap, cell.data(), cell.size());
+        set_slot(data, pos, {header.heap, static_cast<uint16_t>(cell.size())});
+    }
+    note_free_space(page);
+    sync_header();
+}
+
+bool PagedGraphStore::erase(RecordKind kind, uint64_t id) {
+    std::lock_guard lock(mutex_);
+    RecordRef ref = lookup(kind, id);
+    if (!ref) return false;
+    PageGuard page(pool_, page_of(ref));
+    char* data = page.write();
+    HeapHeader& header = heap(data);
+    Slot slot = slot_at(data, slot_of(ref));
+    drop_cell(data + slot.offset);
+    header.garbage += slot.size;
+    set_slot(data, slot_of(ref), {0, 0});
+    while (header.count > 0 && slot_at(data, header.count - 1).offset == 0) --header.count;
+    set_ref(kind, id, 0);
+    note_free_space(page);
+    sync_header();
+    return true;
+}
+
+std::vector<uint64_t> PagedGraphStore::ids(RecordKind kind, uint64_t from, size_t limit) {
+    std::lock_guard lock(mutex_);
+    std::vector<uint64_t> result;
+    const std::vector<PageID>& directories = directories_[static_cast<size_t>(kind)];
+    for (uint64_t block = from / kPerDirectory; block < directories.size() && result.size() < limit; ++block) {
+        if (directories[block] == 0) continue;
+        PageGuard page(pool_, directories[block]);
+        const char* entries = page.data() + sizeof(ChainHeader);
+        uint64_t first = block * kPerDirectory;
+        for (size_t i = from > first ? from - first : 0; i < kPerDirectory && result.size() < limit; ++i) {
+            if (load<RecordRef>(entries + i * sizeof(RecordRef))) result.push_back(first + i);
+        }
+    }
+    return result;
+}
+
+void PagedGraphStore::flush() {
+    std::lock_guard lock(mutex_);
+    pool_.flush_all_pages();
+}
+
+PageID PagedGraphStore::write_chain(const char* bytes, size_t size) {
+    PageID head = kInvalidPageID;
+    PageGuard last;
+    size_t done = 0;
+    do {
+        PageGuard page = allocate(kOverflowPage);
+        char* data = page.write();
+        size_t n = std::min(kChainCapacity, size - done);
+        std::memcpy(data + sizeof(ChainHeader), bytes + done, n);
+        chain(data).used = static_cast<uint16_t>(n);
+        if (last) chain(last.write()).next = page.id();
+        else head = page.id();
+        last = std::move(page);
+        done += n;
+    } while (done < size);
+    return head;
+}
+
+void PagedGraphStore::read_chain(PageID id, std::string& out) {
+    while (id != kInvalidPageID) {
+        PageGuard page(pool_, id);
+        const ChainHeader& header = chain(page.data());
+        out.append(page.data() + sizeof(ChainHeader), header.used);
+        id = header.next;
+    }
+}
+
+void PagedGraphStore::free_chain(PageID id) {
+    while (id != kInvalidPageID) {
+        PageID next = chain(PageGuard(pool_, id).data()).next;
+        free_page(id);
+        id = next;
+    }
+}
+
+PageGuard PagedGraphStore::allocate(uint8_t type) {
+    PageGuard page;
+    if (free_list_ != kInvalidPageID) {
+        page = PageGuard(pool_, free_list_);
+        free_list_ = chain(page.data()).next;
+        header_dirty_ = true;
+    } else {
+        PageID id;
+        Page* fresh = pool_.new_page(&id);
+        page = PageGuard(pool_, id, fresh);
+    }
+    char* data = page.write();
+    std::memset(data, 0, kPageSize);
+    if (type == kHeapPage) {
+        heap(data).type = type;
+        heap(data).heap = kPageSize;
+    } else {
+        chain(data).type = type;
+        chain(data).next = kInvalidPageID;
+    }
+    return page;
+}
+
+void PagedGraphStore::free_page(PageID id) {
+    PageGuard page(pool_, id);
+    ChainHeader& header = chain(page.write());
+    header.type = kFreePage;
+    header.used = 0;
+    header.next = free_list_;
+    free_list_ = id;
+    header_dirty_ = true;
+}
+
+void PagedGraphStore::note_free_space(const PageGuard& page) {
+    if (page.id() != fill_ && reclaimable_space(page.data()) >= kRoomy) roomy_.insert(page.id());
+}
+
+void PagedGraphStore::sync_header() {
+    if (!header_dirty_) return;
+    PageGuard page(pool_, kHeaderPage);
+    StoreHeader& header = *reinterpret_cast<StoreHeader*>(page.write());
+    for (size_t kind = 0; kind < 2; ++kind) {
+        header.lists[kind] = lists_[kind].empty() ? kInvalidPageID : lists_[kind].front();
+    }
+    header.free_list = free_list_;
+    header_dirty_ = false;
+}
+
+} // namespace storage
+} // namespace graph_db
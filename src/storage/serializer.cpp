@@ -1,5 +1,6 @@
 #include "../../include/graph_db/storage/serializer.h"
 #include "../../include/graph_db/graph.h"
+#include <stdexcept>
 #include <variant>
 
 namespace graph_db {
@@ -14,97 +15,140 @@ bool Serializer::save_to_file(const std::string& filename) {
     }
 
     // Serialize nodes
-    size_t node_count = graph_.node_count();
-    out.write(reinterpret_cast<const char*>(&node_count), sizeof(node_count));
-    for (const auto& [id, node_ptr] : graph_.get_all_nodes()) {
-        out.write(reinterpret_cast<const char*>(&id), sizeof(id));
-        const auto& properties = node_ptr->get_properties();
-        size_t prop_count = properties.size();
-        out.write(reinterpret_cast<const char*>(&prop_count), sizeof(prop_count));
-        for (const auto& [key, value] : properties) {
-            size_t key_size = key.size();
-            out.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
-            out.write(key.c_str(), key_size);
-            write_property_value(out, value);
-        }
-    }
+    write_count(out, graph_.node_count());
+    graph_.for_each_node([&out](Node& node) {
+        write_node_record(out, node.get_id(), node.get_properties());
+    });
 
     // Serialize edges
-    size_t edge_count = graph_.edge_count();
-    out.write(reinterpret_cast<const char*>(&edge_count), sizeof(edge_count));
-    for (const auto& [id, edge_ptr] : graph_.get_all_edges()) {
-        out.write(reinterpret_cast<const char*>(&id), sizeof(id));
-        NodeID from = edge_ptr->from_node();
-        NodeID to = edge_ptr->to_node();
-        out.write(reinterpret_cast<const char*>(&from), sizeof(from));
-        out.write(reinterpret_cast<const char*>(&to), sizeof(to));
-        std::string label = edge_ptr->label();
-        size_t label_size = label.size();
-        out.write(reinterpret_cast<const char*>(&label_size), sizeof(label_size));
-        out.write(label.c_str(), label_size);
-        const auto& properties = edge_ptr->get_properties();
-        size_t prop_count = properties.size();
-        out.write(reinterpret_cast<const char*>(&prop_count), sizeof(prop_count));
-        for (const auto& [key, value] : properties) {
-            size_t key_size = key.size();
-            out.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
-            out.write(key.c_str(), key_size);
-            write_property_value(out, value);
-        }
-    }
+    write_count(out, graph_.edge_count());
+    graph_.for_each_edge([&out](Edge& edge) {
+        write_edge_record(out, edge.id(), edge.from_node(), edge.to_node(),
+                          edge.label(), edge.get_properties());
+    });
 
     return true;
 }
 
+void Serializer::write_count(std::ofstream& out, size_t count) {
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+}
+
+void Serializer::write_node_record(std::ofstream& out, NodeID id, const PropertyMap& properties) {
+    out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    write_properties(out, properties);
+}
+
+void Serializer::write_edge_record(std::ofstream& out, EdgeID id, NodeID from, NodeID to,
+                                   const std::string& label, const PropertyMap& properties) {
+    out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    out.write(reinterpret_cast<const char*>(&from), sizeof(from));
+    out.write(reinterpret_cast<const char*>(&to), sizeof(to));
+    size_t label_size = label.size();
+    out.write(reinterpret_cast<const char*>(&label_size), sizeof(label_size));
+    out.write(label.c_str(), label_size);
+    write_properties(out, properties);
+}
+
+void Serializer::write_properties(std::ofstream& out, const PropertyMap& properties) {
+    size_t prop_count = properties.size();
+    out.write(reinterpret_cast<const char*>(&prop_count), sizeof(prop_count));
+    for (const auto& [key, value] : properties) {
+        size_t key_size = key.size();
+        out.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+        out.write(key.c_str(), key_size);
+        write_property_value(out, value);
+    }
+}
+
 bool Serializer::load_from_file(const std::string& filename) {
     std::ifstream in(filename, std::ios::binary);
     if (!in) {
         return false;
     }
 
-    // Deserialize nodes
-    size_t node_count;
-    in.read(reinterpret_cast<char*>(&node_count), sizeof(node_count));
-    for (size_t i = 0; i < node_count; ++i) {
-        NodeID id;
-        in.read(reinterpret_cast<char*>(&id), sizeof(id));
-        Node* node = graph_.create_node(id);
+    in.seekg(0, std::ios::end);
+    file_end_ = in.tellg();
+    in.seekg(0, std::ios::beg);
+
+    // Smallest encodings: a property is a key size, a type tag and a bool; a node an ID
+    // and a property count; an edge three IDs, a label size and a property count
+    constexpr size_t kMinProperty = sizeof(size_t) + 2;
+    constexpr size_t kMinNode = sizeof(NodeID) + sizeof(size_t);
+    constexpr size_t kMinEdge = sizeof(EdgeID) + 2 * sizeof(NodeID) + 2 * sizeof(size_t);
+
+    auto read_properties = [this, &in](PropertyMap& properties) {
         size_t prop_count;
         in.read(reinterpret_cast<char*>(&prop_count), sizeof(prop_count));
-        for (size_t j = 0; j < prop_count; ++j) {
+        if (!fits(in, prop_count, kMinProperty)) return;
+        properties.reserve(prop_count);
+        for (size_t j = 0; j < prop_count && in; ++j) {
             size_t key_size;
             in.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+            if (!fits(in, key_size)) return;
             std::string key(key_size, '\0');
             in.read(&key[0], key_size);
-            node->set_property(key, read_property_value(in));
+            properties[key] = read_property_value(in);
+        }
+    };
+
+    // Deserialize nodes
+    size_t node_count;
+    in.read(reinterpret_cast<char*>(&node_count), sizeof(node_count));
+    if (!fits(in, node_count, kMinNode)) {
+        return false;
+    }
+    std::vector<NodeRecord> nodes(node_count);
+    for (auto& node : nodes) {
+        in.read(reinterpret_cast<char*>(&node.id), sizeof(node.id));
+        read_properties(node.properties);
+        if (!in) {
+            return false;
         }
     }
 
     // Deserialize edges
     size_t edge_count;
     in.read(reinterpret_cast<char*>(&edge_count), sizeof(edge_count));
-    for (size_t i = 0; i < edge_count; ++i) {
-        EdgeID id;
-        in.read(reinterpret_cast<char*>(&id), sizeof(id));
-        NodeID from, to;
-        in.read(reinterpret_cast<char*>(&from), sizeof(from));
-        in.read(reinterpret_cast<char*>(&to), sizeof(to));
+    if (!fits(in, edge_count, kMinEdge)) {
+        return false;
+    }
+    std::vector<EdgeRecord> edges(edge_count);
+    for (auto& edge : edges) {
+        in.read(reinterpret_cast<char*>(&edge.id), sizeof(edge.id));
+        in.read(reinterpret_cast<char*>(&edge.from), sizeof(edge.from));
+        in.read(reinterpret_cast<char*>(&edge.to), sizeof(edge.to));
         size_t label_size;
         in.read(reinterpret_cast<char*>(&label_size), sizeof(label_size));
-        std::string label(label_size, '\0');
-        in.read(&label[0], label_size);
-        Edge* edge = graph_.create_edge(from, to, label, id);
-        size_t prop_count;
-        in.read(reinterpret_cast<char*>(&prop_count), sizeof(prop_count));
-        for (size_t j = 0; j < prop_count; ++j) {
-            size_t key_size;
-            in.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
-            std::string key(key_size, '\0');
-            in.read(&key[0], key_size);
-            edge->set_property(key, read_property_value(in));
+        if (!fits(in, label_size)) {
+            return false;
         }
+        edge.label.assign(label_size, '\0');
+        in.read(&edge.label[0], label_size);
+        read_properties(edge.properties);
+        if (!in) {
+            return false;
+        }
+    }
+
+    // bulk_insert validates the whole batch first, so a rejected file leaves no trace
+    try {
+        graph_.bulk_insert(std::move(nodes), std::move(edges));
+    } catch (const std::runtime_error&) {
+        return false;
     }
+    return true;
+}
 
+bool Serializer::fits(std::ifstream& in, size_t count, size_t size) {
+    if (!in) {
+        return false;
+    }
+    std::streamoff left = file_end_ - in.tellg();
+    if (left < 0 || count > static_cast<size_t>(left) / size) {
+        in.setstate(std::ios::failbit);
+        return false;
+    }
     return true;
 }
 
@@ -140,6 +184,9 @@ PropertyValue Serializer::read_property_value(std::ifstream& in) {
         case 2: { // string
             size_t size;
             in.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!fits(in, size)) {
+                return PropertyValue{};
+            }
             std::string val(size, '\0');
             in.read(&val[0], size);
             return val;
@@ -149,8 +196,9 @@ PropertyValue Serializer::read_property_value(std::ifstream& in) {
             in.read(reinterpret_cast<char*>(&val), sizeof(val));
             return val;
         }
-        default:
-            throw std::runtime_error("Unknown property type");
+        default: // corrupt file; load_from_file sees the failed stream
+            in.setstate(std::ios::failbit);
+            return PropertyValue{};
     }
 }
 
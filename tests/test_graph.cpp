@@ -2,6 +2,19 @@
 #include "graph_db/graph.h"
 #include "graph_db/node.h"
 #include "graph_db/edge.h"
+#include "graph_db/graph_algo.h"
+#include "graph_db/generator/graph_generator.h"
+#include "graph_db/query/query_parser.h"
+#include "graph_db/storage/csv_importer.h"
+#include "graph_db/object_pool.h"
+#include "graph_db/record_table.h"
+#include "graph_db/adjacency_list.h"
+#include "graph_db/Index/hash_index.h"
+#include "graph_db/Index/paged_b_plus_tree.h"
+#include "graph_db/Index/typed_b_plus_tree.h"
+#include "graph_db/buffer/buffer_pool_manager.h"
+#include "graph_db/buffer/clock_replacer.h"
+#include "graph_db/buffer/partitioned_buffer_pool.h"
 
 #include <thread>
 #include <vector>
@@ -10,6 +23,14 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sys/stat.h>
+#include <numeric>
+#include <set>
 using namespace graph_db;
 
 class GraphAdditionalTests : public ::testing::Test {
@@ -274,3 +295,1858 @@ TEST(SerializationTest, SaveAndLoadGraph) {
     EXPECT_EQ(std::get<std::string>(loaded_n1->get_property("name")), "node1");
 }
 
+
+TEST(GeneratorTest, SameSeedSameGraph) {
+    generator::GeneratorConfig config;
+    config.seed = 7;
+    config.labels = {"follows", "likes"};
+    config.label_skew = 1.2;
+    config.max_weight = 50;
+
+    auto a = generator::rmat(10, 4, config);
+    auto b = generator::rmat(10, 4, config);
+    ASSERT_EQ(a.num_nodes, 1024u);
+    ASSERT_EQ(a.edges.size(), 4096u);
+    for (size_t i = 0; i < a.edges.size(); ++i) {
+        EXPECT_EQ(a.edges[i].from, b.edges[i].from);
+        EXPECT_EQ(a.edges[i].to, b.edges[i].to);
+        EXPECT_EQ(a.edges[i].label, b.edges[i].label);
+        EXPECT_EQ(a.edges[i].weight, b.edges[i].weight);
+        EXPECT_NE(a.edges[i].from, a.edges[i].to);
+    }
+
+    config.seed = 8;
+    auto c = generator::rmat(10, 4, config);
+    size_t same = 0;
+    for (size_t i = 0; i < a.edges.size(); ++i) {
+        same += a.edges[i].from == c.edges[i].from && a.edges[i].to == c.edges[i].to;
+    }
+    EXPECT_LT(same, a.edges.size() / 2);
+}
+
+TEST(GeneratorTest, PopulateAndWriteToFile) {
+    generator::GeneratorConfig config;
+    config.node_properties = 2;
+    config.property_cardinality = 10;
+    auto list = generator::barabasi_albert(200, 3, config);
+    EXPECT_EQ(list.edges.size(), (200u - 3u) * 3u);
+
+    Graph g;
+    auto ids = generator::populate(g, list, config);
+    EXPECT_EQ(g.node_count(), 200u);
+    EXPECT_EQ(g.edge_count(), list.edges.size());
+    EXPECT_TRUE(g.get_node(ids[0])->has_property("p1"));
+
+    const std::string filename = "test_generated.db";
+    ASSERT_TRUE(generator::write_to_file(filename, generator::grid(4, 5, false, config), config));
+    Graph loaded;
+    ASSERT_TRUE(loaded.load_from_file(filename));
+    EXPECT_EQ(loaded.node_count(), 20u);
+    EXPECT_EQ(loaded.edge_count(), 4u * 4u + 3u * 5u);
+    std::remove(filename.c_str());
+}
+
+TEST(SnapshotTest, CSRMatchesGraphAndTracksMutations) {
+    Graph g;
+    NodeID a = g.create_node();
+    NodeID b = g.create_node();
+    NodeID c = g.create_node();
+    EdgeID ab = g.create_edge(a, b, "x");
+    EdgeID ac = g.create_edge(a, c, "x");
+    g.set_edge_weight(ac, 7);
+
+    auto s1 = g.snapshot();
+    ASSERT_EQ(s1->num_vertices(), 3u);
+    ASSERT_EQ(s1->num_edges(), 2u);
+    auto va = s1->index_of(a);
+    ASSERT_EQ(s1->out_degree(va), 2u);
+    EXPECT_EQ(s1->out_edges(va)[0], ab);
+    EXPECT_EQ(s1->node_id(s1->out_neighbors(va)[1]), c);
+    EXPECT_EQ(s1->out_weights(va)[1], 7);
+    EXPECT_EQ(s1->in_degree(s1->index_of(c)), 1u);
+    EXPECT_EQ(g.snapshot(), s1); // unchanged graph reuses the cached snapshot
+
+    // Incremental rebuild after adding a node and removing one
+    NodeID d = g.create_node();
+    g.create_edge(c, d, "y");
+    g.remove_node(b);
+    auto s2 = g.snapshot();
+    EXPECT_NE(s2, s1);
+    EXPECT_EQ(s1->num_vertices(), 3u); // old snapshot is immutable
+    ASSERT_EQ(s2->num_vertices(), 3u);
+    EXPECT_EQ(s2->index_of(b), CSRGraph::kInvalidVertex);
+    EXPECT_EQ(s2->out_degree(s2->index_of(a)), 1u);
+    EXPECT_EQ(s2->node_id(s2->out_neighbors(s2->index_of(c))[0]), d);
+    EXPECT_EQ(s2->out_weights(s2->index_of(a))[0], 7);
+}
+
+TEST(AlgorithmTest, TraversalsAndDijkstraOnSnapshot) {
+    Graph g;
+    std::vector<NodeID> n;
+    for (int i = 0; i < 5; ++i) n.push_back(g.create_node());
+    g.set_edge_weight(g.create_edge(n[0], n[1]), 4);
+    g.set_edge_weight(g.create_edge(n[0], n[2]), 1);
+    g.set_edge_weight(g.create_edge(n[2], n[1]), 1);
+    g.set_edge_weight(g.create_edge(n[1], n[3]), 5);
+
+    auto order = bfs(g, n[0]);
+    ASSERT_EQ(order.size(), 4u);
+    EXPECT_EQ(order[0], n[0]);
+    EXPECT_EQ(order.back(), n[3]);
+    EXPECT_EQ(bfs_level(g, n[0], 1).size(), 3u);
+    EXPECT_EQ(dfs(g, n[0]).size(), 4u);
+    EXPECT_TRUE(bfs(g, 999).empty());
+
+    auto dist = dijkstra(g, n[0]);
+    EXPECT_EQ(dist[n[1]], 2);
+    EXPECT_EQ(dist[n[3]], 7);
+    EXPECT_EQ(dist[n[4]], std::numeric_limits<int64_t>::max());
+}
+
+TEST_F(GraphAdditionalTests, ForEachEdgeVisitsAdjacencyInPlace) {
+    NodeID a = g.create_node();
+    NodeID b = g.create_node();
+    NodeID c = g.create_node();
+    EdgeID ab = g.create_edge(a, b, "x");
+    g.set_edge_weight(ab, 3);
+    g.create_edge(a, c, "x");
+    g.create_edge(c, b, "x");
+
+    int64_t weight_sum = 0;
+    std::vector<NodeID> targets;
+    EXPECT_TRUE(g.for_each_out_edge(a, [&](EdgeID, NodeID target, int64_t weight) {
+        targets.push_back(target);
+        weight_sum += weight;
+    }));
+    EXPECT_EQ(weight_sum, 4);
+    EXPECT_EQ(targets.size(), 2u);
+
+    std::vector<NodeID> sources;
+    g.for_each_in_neighbor(b, [&](NodeID source) { sources.push_back(source); });
+    std::sort(sources.begin(), sources.end());
+    EXPECT_EQ(sources, (std::vector<NodeID>{a, c}));
+
+    EXPECT_FALSE(g.for_each_out_neighbor(12345, [](NodeID) {}));
+    EXPECT_EQ(g.get_node(a)->out_degree(), 2u);
+}
+
+TEST(ParallelTest, ThreadPoolCoversRangeAndPropagatesErrors) {
+    parallel::ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(10000);
+    pool.parallel_for(0, hits.size(), 37, [&](size_t lo, size_t hi, size_t worker) {
+        ASSERT_LT(worker, pool.size());
+        for (size_t i = lo; i < hi; ++i) hits[i].fetch_add(1);
+    });
+    for (const auto& h : hits) ASSERT_EQ(h.load(), 1);
+
+    EXPECT_THROW(pool.parallel_for(0, 100, 1, [](size_t lo, size_t, size_t) {
+        if (lo == 50) throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
+
+TEST(ParallelTest, ParallelBfsMatchesSerialLevels) {
+    generator::GeneratorConfig config;
+    config.seed = 3;
+    Graph g;
+    auto ids = generator::populate(g, generator::rmat(12, 8, config), config);
+    auto csr = g.snapshot();
+
+    parallel::ThreadPool pool(4);
+    auto serial = bfs(*csr, ids[0]);
+    auto parallel_order = parallel_bfs(*csr, ids[0], pool);
+    ASSERT_EQ(parallel_order.size(), serial.size());
+    EXPECT_EQ(parallel_order.front(), ids[0]);
+
+    // Same vertices, and each one no deeper than in the serial traversal's levels
+    for (int level = 0; level < 8; ++level) {
+        auto expected = bfs_level(*csr, ids[0], level);
+        std::vector<NodeID> prefix(parallel_order.begin(), parallel_order.begin() + expected.size());
+        std::sort(prefix.begin(), prefix.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(prefix, expected);
+    }
+}
+
+TEST(QueryParserTest, ParsesParallelBfs) {
+    query::QueryParser parser;
+    auto q = parser.parse("bfs from 7 parallel");
+    EXPECT_EQ(q.type, query::QueryType::BFS);
+    EXPECT_EQ(q.start_node, 7u);
+    EXPECT_TRUE(q.parallel);
+    EXPECT_FALSE(parser.parse("BFS FROM 7").parallel);
+}
+
+TEST(ShortestPathTest, BidirectionalUnidirectionalAndAStarAgree) {
+    // 20x20 bidirectional grid with random weights
+    generator::GeneratorConfig config;
+    config.seed = 11;
+    config.max_weight = 9;
+    Graph g;
+    auto ids = generator::populate(g, generator::grid(20, 20, true, config), config);
+    NodeID source = ids[0], target = ids[20 * 20 - 1];
+
+    auto all = dijkstra(g, source);
+    PathOptions forward_only;
+    forward_only.bidirectional = false;
+    auto uni = shortest_path(g, source, target, forward_only);
+    auto bi = shortest_path(g, source, target);
+    PathOptions astar;
+    astar.heuristic = [&](NodeID v) {
+        int64_t idx = static_cast<int64_t>(v - ids[0]);
+        return static_cast<int64_t>((19 - idx / 20) + (19 - idx % 20)); // Manhattan, weight >= 1
+    };
+    auto guided = shortest_path(g, source, target, astar);
+
+    for (const auto* r : {&uni, &bi, &guided}) {
+        ASSERT_TRUE(r->found);
+        EXPECT_EQ(r->distance, all[target]);
+        ASSERT_EQ(r->nodes.size(), r->edges.size() + 1);
+        EXPECT_EQ(r->nodes.front(), source);
+        EXPECT_EQ(r->nodes.back(), target);
+        int64_t total = 0;
+        for (size_t i = 0; i < r->edges.size(); ++i) {
+            Edge* e = g.get_edge(r->edges[i]);
+            ASSERT_NE(e, nullptr);
+            EXPECT_EQ(e->from_node(), r->nodes[i]);
+            EXPECT_EQ(e->to_node(), r->nodes[i + 1]);
+            total += e->get_weight();
+        }
+        EXPECT_EQ(total, r->distance);
+    }
+    EXPECT_LE(guided.settled, uni.settled);
+
+    // Early exit: a nearby target settles far fewer vertices than the whole grid
+    auto near = shortest_path(g, source, ids[1], forward_only);
+    EXPECT_LT(near.settled, 400u);
+
+    NodeID isolated = g.create_node();
+    EXPECT_FALSE(shortest_path(g, source, isolated).found);
+    EXPECT_FALSE(shortest_path(g, source, 999999).found);
+}
+
+TEST(DeltaSteppingTest, MatchesDijkstraForSeveralDeltas) {
+    generator::GeneratorConfig config;
+    config.seed = 5;
+    config.max_weight = 40;
+    Graph g;
+    auto ids = generator::populate(g, generator::rmat(11, 6, config), config);
+    auto csr = g.snapshot();
+    auto expected = dijkstra(*csr, ids[0]);
+
+    parallel::ThreadPool pool(4);
+    for (int64_t delta : {1, 7, 40, 1000, 0}) {
+        auto dist = delta_stepping(*csr, ids[0], delta, pool);
+        ASSERT_EQ(dist.size(), csr->num_vertices());
+        for (size_t v = 0; v < dist.size(); ++v) {
+            ASSERT_EQ(dist[v], expected[csr->node_id(static_cast<CSRGraph::VertexIndex>(v))]) << "delta " << delta;
+        }
+    }
+    EXPECT_EQ(delta_stepping(g, ids[0]), expected);
+
+    // Weights far beyond the bucket window go through the overflow list
+    Graph sparse;
+    NodeID a = sparse.create_node(), b = sparse.create_node(), c = sparse.create_node(), d = sparse.create_node();
+    sparse.set_edge_weight(sparse.create_edge(a, b), 5'000'000'000);
+    sparse.set_edge_weight(sparse.create_edge(a, c), 3);
+    sparse.set_edge_weight(sparse.create_edge(c, b), 4'000'000'000);
+    sparse.set_edge_weight(sparse.create_edge(b, d), 1);
+    auto sparse_dist = delta_stepping(sparse, a, 1);
+    EXPECT_EQ(sparse_dist[b], 4'000'000'003);
+    EXPECT_EQ(sparse_dist[d], 4'000'000'004);
+    EXPECT_EQ(sparse_dist, dijkstra(*sparse.snapshot(), a));
+    sparse.set_edge_weight(sparse.create_edge(d, a), -1);
+    EXPECT_THROW(delta_stepping(sparse, a, 1), std::runtime_error);
+
+    query::QueryParser parser;
+    auto q = parser.parse("SSSP FROM 3 DELTA 25");
+    EXPECT_EQ(q.type, query::QueryType::SSSP);
+    EXPECT_EQ(q.delta, 25);
+}
+
+TEST(ShardedGraphTest, ConcurrentIngestKeepsCountsAndAdjacencyConsistent) {
+    Graph g;
+    constexpr size_t kThreads = 4;
+    constexpr size_t kNodesPerThread = 300;
+    constexpr size_t kEdgesPerThread = 2000;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&g]() {
+            for (size_t i = 0; i < kNodesPerThread; ++i) g.create_node();
+        });
+    }
+    for (auto& th : threads) th.join();
+    threads.clear();
+    ASSERT_EQ(g.node_count(), kThreads * kNodesPerThread);
+
+    std::atomic<bool> writing{true};
+    std::thread reader([&g, &writing]() {
+        while (writing.load()) {
+            auto csr = g.snapshot();
+            EXPECT_LE(csr->num_edges(), kThreads * kEdgesPerThread);
+        }
+    });
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&g, t]() {
+            std::mt19937_64 rng(t);
+            std::uniform_int_distribution<NodeID> pick(1, kThreads * kNodesPerThread);
+            for (size_t i = 0; i < kEdgesPerThread; ++i) {
+                EdgeID e = g.create_edge(pick(rng), pick(rng), "rel");
+                if (i % 4 == 0) g.remove_edge(e);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    writing = false;
+    reader.join();
+
+    size_t expected_edges = kThreads * (kEdgesPerThread - kEdgesPerThread / 4);
+    EXPECT_EQ(g.edge_count(), expected_edges);
+    size_t out_total = 0, in_total = 0, visited = 0;
+    g.for_each_node([&](Node& node) {
+        out_total += node.out_degree();
+        in_total += node.in_degree();
+    });
+    g.for_each_edge([&](Edge&) { ++visited; });
+    EXPECT_EQ(out_total, expected_edges);
+    EXPECT_EQ(in_total, expected_edges);
+    EXPECT_EQ(visited, expected_edges);
+    EXPECT_EQ(g.snapshot()->num_edges(), expected_edges);
+
+    // Explicit IDs keep later auto-assigned ones unique
+    g.create_node(5000);
+    EXPECT_EQ(g.create_node(), 5001u);
+}
+
+TEST(ShardedGraphTest, AutoIdsNeverOverwriteRacingExplicitIds) {
+    for (int round = 0; round < 4; ++round) {
+        Graph g;
+        for (int i = 0; i < 64; ++i) g.create_node();
+        // create_node(65) starts and create_node() draws 65, both waiting on shard 1 while
+        // the scan holds it; whichever gets the shard first, the other must not clobber it
+        NodeID drawn = 0;
+        bool explicit_created = false;
+        std::thread auto_id, explicit_id;
+        g.for_each_node([&](Node& node) {
+            if (node.get_id() != 1) return;
+            explicit_id = std::thread([&]() {
+                try {
+                    g.create_node(65);
+                    explicit_created = true;
+                } catch (const std::runtime_error&) {
+                }
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            auto_id = std::thread([&]() { drawn = g.create_node(); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        auto_id.join();
+        explicit_id.join();
+        if (explicit_created) EXPECT_NE(drawn, 65u);
+        else EXPECT_EQ(drawn, 65u);
+        size_t visited = 0;
+        g.for_each_node([&](Node&) { ++visited; });
+        EXPECT_EQ(visited, explicit_created ? 66u : 65u);
+        EXPECT_EQ(g.node_count(), visited);
+    }
+}
+
+TEST(BulkInsertTest, InsertsBatchIndexesPropertiesAndRejectsInvalidBatches) {
+    Graph g;
+    g.create_index("age");
+    NodeID existing = g.create_node();
+
+    std::vector<NodeRecord> nodes(3);
+    nodes[0].id = 100;
+    nodes[0].properties["age"] = int64_t(30);
+    nodes[2].properties["age"] = int64_t(30);
+    std::vector<EdgeRecord> edges(2);
+    edges[0].from = 100;
+    edges[0].to = existing;
+    edges[0].label = "knows";
+    edges[0].weight = 7;
+    edges[1].from = existing;
+    edges[1].to = 100;
+    auto result = g.bulk_insert(nodes, edges);
+
+    ASSERT_EQ(result.node_ids.size(), 3u);
+    EXPECT_EQ(result.node_ids[0], 100u);
+    EXPECT_GT(result.node_ids[1], 100u);
+    EXPECT_EQ(result.node_ids[2], result.node_ids[1] + 1);
+    EXPECT_EQ(g.node_count(), 4u);
+    EXPECT_EQ(g.edge_count(), 2u);
+    EXPECT_EQ(g.get_neighbors(100), std::vector<NodeID>{existing});
+    EXPECT_EQ(g.get_edge(result.edge_ids[0])->get_weight(), 7);
+    auto adults = g.find_nodes("age", int64_t(30));
+    std::sort(adults.begin(), adults.end());
+    EXPECT_EQ(adults, (std::vector<NodeID>{100, result.node_ids[2]}));
+
+    // A dangling endpoint rejects the whole batch
+    std::vector<NodeRecord> more(1);
+    std::vector<EdgeRecord> bad(1);
+    bad[0].from = existing;
+    bad[0].to = 999999;
+    EXPECT_THROW(g.bulk_insert(more, bad), std::runtime_error);
+    nodes.resize(1);
+    EXPECT_THROW(g.bulk_insert(nodes, {}), std::runtime_error);
+    EXPECT_EQ(g.node_count(), 4u);
+    EXPECT_EQ(g.edge_count(), 2u);
+
+    const std::string file = "bulk_roundtrip.db";
+    ASSERT_TRUE(g.save_to_file(file));
+    Graph loaded;
+    loaded.create_index("age");
+    ASSERT_TRUE(loaded.load_from_file(file));
+    EXPECT_EQ(loaded.node_count(), 4u);
+    EXPECT_EQ(loaded.edge_count(), 2u);
+    EXPECT_EQ(loaded.get_neighbors(existing), std::vector<NodeID>{100});
+    EXPECT_EQ(loaded.find_nodes("age", int64_t(30)).size(), 2u);
+
+    // Truncated or corrupt files fail to load instead of allocating what their counts claim
+    std::string bytes;
+    {
+        std::ifstream in(file, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto load_bytes = [&file](const std::string& content) {
+        {
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            out << content;
+        }
+        Graph g;
+        return g.load_from_file(file);
+    };
+    EXPECT_TRUE(load_bytes(bytes));
+    for (size_t cut : {size_t{0}, size_t{4}, bytes.size() / 2, bytes.size() - 1}) {
+        EXPECT_FALSE(load_bytes(bytes.substr(0, cut))) << "cut at " << cut;
+    }
+    std::string huge_count = bytes;
+    const size_t count = size_t{1} << 60;
+    huge_count.replace(0, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+    EXPECT_FALSE(load_bytes(huge_count));
+    // Dangling edges are rejected by bulk_insert, which must not throw out of the load
+    std::string dangling = bytes;
+    const NodeID missing = 424242;
+    dangling.replace(sizeof(size_t), sizeof(missing), reinterpret_cast<const char*>(&missing), sizeof(missing));
+    EXPECT_FALSE(load_bytes(dangling));
+    // One node with one property: count, ID, property count, then the key size
+    Graph single;
+    single.create_node(1)->set_property("k", int64_t{1});
+    ASSERT_TRUE(single.save_to_file(file));
+    {
+        std::ifstream in(file, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string huge_key = bytes;
+    huge_key.replace(sizeof(size_t) + sizeof(NodeID) + sizeof(size_t), sizeof(count),
+                     reinterpret_cast<const char*>(&count), sizeof(count));
+    EXPECT_TRUE(load_bytes(bytes));
+    EXPECT_FALSE(load_bytes(huge_key));
+    std::remove(file.c_str());
+}
+
+TEST(CsvImportTest, ImportsTypedColumnsAcrossChunks) {
+    const std::string nodes_file = "import_nodes.csv";
+    const std::string edges_file = "import_edges.csv";
+    {
+        std::ofstream out(nodes_file);
+        out << "id,name,age:int,score:double,active:bool\r\n";
+        for (int i = 1; i <= 500; ++i) {
+            out << i << ",\"node, " << i << "\"," << i % 7 << "," << i * 0.5 << "," << (i % 2 ? "true" : "false")
+                << "\r\n";
+        }
+        out << "\n";
+        out << "501,\"say \"\"hi\"\"\",,,\n";
+    }
+    {
+        std::ofstream out(edges_file);
+        out << "from,to,label,weight,since:int\n";
+        for (int i = 1; i < 500; ++i) out << i << "," << i + 1 << ",next," << i << "," << 2000 + i << "\n";
+    }
+
+    Graph g;
+    g.create_index("age");
+    storage::ImportOptions options;
+    options.threads = 3;
+    options.chunk_bytes = 256; // many small chunks, cut mid-line
+    storage::CsvImporter importer(g, options);
+    EXPECT_EQ(importer.import_nodes(nodes_file).nodes, 501u);
+    EXPECT_EQ(importer.import_edges(edges_file).edges, 499u);
+
+    EXPECT_EQ(g.node_count(), 501u);
+    EXPECT_EQ(g.edge_count(), 499u);
+    Node* n = g.get_node(42);
+    ASSERT_NE(n, nullptr);
+    EXPECT_EQ(std::get<std::string>(n->get_property("name")), "node, 42");
+    EXPECT_EQ(std::get<int64_t>(n->get_property("age")), 0);
+    EXPECT_DOUBLE_EQ(std::get<double>(n->get_property("score")), 21.0);
+    EXPECT_FALSE(std::get<bool>(n->get_property("active")));
+    EXPECT_EQ(std::get<std::string>(g.get_node(501)->get_property("name")), "say \"hi\"");
+    EXPECT_FALSE(g.get_node(501)->has_property("age"));
+    EXPECT_EQ(g.find_nodes("age", int64_t(3)).size(), 72u);
+    EXPECT_EQ(g.get_neighbors(42), std::vector<NodeID>{43});
+    auto path = shortest_path(g, 1, 4);
+    EXPECT_EQ(path.distance, 1 + 2 + 3);
+
+    {
+        std::ofstream out(edges_file);
+        out << "from,to,weight\n1,2,3\n1,x,3\n";
+    }
+    try {
+        importer.import_edges(edges_file);
+        FAIL() << "expected a parse error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find(":3:"), std::string::npos) << e.what();
+    }
+    std::remove(nodes_file.c_str());
+    std::remove(edges_file.c_str());
+}
+
+TEST(ObjectPoolTest, RecyclesSlotsAndKeepsAddressesStable) {
+    ObjectPool<Node, 4> pool;
+    std::vector<Node*> nodes;
+    for (NodeID id = 1; id <= 10; ++id) nodes.push_back(pool.create(id));
+    EXPECT_EQ(pool.size(), 10u);
+    EXPECT_EQ(pool.capacity(), 12u);
+    for (size_t i = 0; i < nodes.size(); ++i) EXPECT_EQ(nodes[i]->get_id(), i + 1);
+
+    Node* freed = nodes[3];
+    pool.destroy(freed);
+    Node* reused = pool.create(NodeID(99));
+    EXPECT_EQ(reused, freed);
+    EXPECT_EQ(reused->get_id(), 99u);
+    EXPECT_EQ(nodes[9]->get_id(), 10u);
+
+    pool.reserve(6);
+    EXPECT_EQ(pool.capacity(), 16u);
+    for (Node* n : nodes) {
+        if (n != freed) pool.destroy(n);
+    }
+    pool.destroy(reused);
+    EXPECT_EQ(pool.size(), 0u);
+
+    // Graph recycles removed elements' slots; surviving pointers stay valid
+    Graph g;
+    NodeID a = g.create_node();
+    NodeID b = g.create_node();
+    Node* node_a = g.get_node(a);
+    EdgeID e = g.create_edge(a, b, "x");
+    ASSERT_TRUE(g.remove_edge(e));
+    ASSERT_TRUE(g.remove_node(b));
+    EXPECT_EQ(g.get_node(a), node_a);
+    EXPECT_EQ(g.get_edge(e), nullptr);
+    EXPECT_EQ(g.get_neighbors(a), std::vector<NodeID>{});
+}
+
+TEST(RecordTableTest, DirectLookupTombstonesAndOrderedScan) {
+    int values[6] = {0, 1, 2, 3, 4, 5};
+    RecordTable<int, 4, 8> table; // IDs with id % 4 == 1
+    for (uint64_t id : {1, 5, 9, 41, 4001}) table.insert(id, &values[id % 6]);
+    EXPECT_EQ(table.size(), 5u);
+    EXPECT_EQ(table.get(41), &values[41 % 6]);
+    EXPECT_EQ(table.get(13), nullptr);
+    EXPECT_EQ(table.get(1u << 30), nullptr);
+
+    int* before = table.get(9);
+    table.insert(100001, &values[0]); // grows far past the existing chunks
+    EXPECT_EQ(table.get(9), before);
+
+    EXPECT_EQ(table.erase(5), &values[5]);
+    EXPECT_EQ(table.erase(5), nullptr);
+    EXPECT_FALSE(table.contains(5));
+    EXPECT_EQ(table.size(), 5u);
+
+    std::vector<int*> seen;
+    table.for_each([&seen](int* v) { seen.push_back(v); });
+    EXPECT_EQ(seen, (std::vector<int*>{&values[1], &values[3], &values[41 % 6], &values[4001 % 6], &values[0]}));
+}
+
+TEST(RecordTableTest, IdsPastDenseLimitStaySparse) {
+    int values[3] = {0, 1, 2};
+    RecordTable<int, 64> table;
+    const uint64_t huge = (uint64_t{1} << 60) + 64;
+    table.insert(64, &values[0]);
+    table.insert(huge, &values[2]);
+    table.insert(kDenseIdLimit, &values[1]);
+    EXPECT_EQ(table.size(), 3u);
+    EXPECT_EQ(table.get(huge), &values[2]);
+    EXPECT_EQ(table.get(huge + 64), nullptr);
+
+    std::vector<int*> seen;
+    table.for_each([&seen](int* v) { seen.push_back(v); });
+    EXPECT_EQ(seen, (std::vector<int*>{&values[0], &values[1], &values[2]}));
+
+    EXPECT_EQ(table.erase(huge), &values[2]);
+    EXPECT_FALSE(table.contains(huge));
+    EXPECT_EQ(table.size(), 2u);
+
+    Graph g;
+    const NodeID a = uint64_t{1} << 60, b = uint64_t{1} << 40;
+    ASSERT_NE(g.create_node(a), nullptr);
+    ASSERT_NE(g.create_node(b), nullptr);
+    EXPECT_NE(g.get_node(a), nullptr);
+    g.create_edge(a, b, "far");
+    EXPECT_EQ(g.get_neighbors(a), std::vector<NodeID>{b});
+}
+
+TEST(AdjacencyListTest, GrowsFromInlineToSortedToHubAndBack) {
+    AdjacencyList list;
+    auto edges_of = [&list]() {
+        std::vector<EdgeID> ids;
+        for (const auto& e : list) ids.push_back(e.edge);
+        return ids;
+    };
+    list.add({5, 50, 1});
+    list.add({3, 30, 1});
+    EXPECT_EQ(edges_of(), (std::vector<EdgeID>{3, 5}));
+    list.add({4, 40, 1}); // spills to the heap, still sorted
+    std::vector<AdjacencyEntry> run{{9, 90, 2}, {7, 70, 2}, {1, 10, 2}};
+    list.add(run.data(), run.data() + run.size());
+    EXPECT_EQ(edges_of(), (std::vector<EdgeID>{1, 3, 4, 5, 7, 9}));
+    EXPECT_TRUE(list.set_weight(7, 42));
+    EXPECT_FALSE(list.set_weight(8, 42));
+    EXPECT_TRUE(list.remove(4));
+    EXPECT_FALSE(list.remove(4));
+    EXPECT_EQ(edges_of(), (std::vector<EdgeID>{1, 3, 5, 7, 9}));
+
+    // Past the hub threshold lookups go through the hash index
+    for (EdgeID e = 100; e < 100 + AdjacencyList::kHubDegree; ++e) list.add({e, e, 1});
+    EXPECT_EQ(list.size(), AdjacencyList::kHubDegree + 5);
+    EXPECT_TRUE(list.contains(7));
+    EXPECT_TRUE(list.remove(3));
+    EXPECT_FALSE(list.contains(3));
+    EXPECT_TRUE(list.contains(100 + AdjacencyList::kHubDegree - 1));
+    for (EdgeID e = 100; e < 100 + AdjacencyList::kHubDegree; ++e) ASSERT_TRUE(list.remove(e));
+    EXPECT_EQ(edges_of(), (std::vector<EdgeID>{1, 5, 7, 9}));
+    int64_t weight = 0;
+    for (const auto& e : list) {
+        if (e.edge == 7) weight = e.weight;
+    }
+    EXPECT_EQ(weight, 42);
+    for (EdgeID e : {1, 5, 7}) list.remove(e);
+    EXPECT_EQ(edges_of(), (std::vector<EdgeID>{9}));
+
+    // Graph keeps the cached weights in sync on both endpoints
+    Graph g;
+    NodeID a = g.create_node();
+    NodeID b = g.create_node();
+    EdgeID e = g.create_edge(a, b, "w");
+    g.set_edge_weight(e, 17);
+    int64_t out_weight = 0, in_weight = 0;
+    g.for_each_out_edge(a, [&](EdgeID, NodeID, int64_t w) { out_weight = w; });
+    g.for_each_in_edge(b, [&](EdgeID, NodeID source, int64_t w) {
+        in_weight = w;
+        EXPECT_EQ(source, a);
+    });
+    EXPECT_EQ(out_weight, 17);
+    EXPECT_EQ(in_weight, 17);
+}
+
+TEST(RemoveNodesTest, RemovesIncidentEdgesOnceAndCleansIndexes) {
+    Graph g;
+    g.create_index("tag");
+    std::vector<NodeID> ids;
+    for (int i = 0; i < 6; ++i) {
+        ids.push_back(g.create_node());
+        g.get_node(ids.back())->set_property("tag", int64_t{i % 2});
+    }
+    // a <-> b share two edges, a has a self-loop, both link out to the survivors
+    NodeID a = ids[0], b = ids[1];
+    g.create_edge(a, b, "x");
+    g.create_edge(b, a, "x");
+    g.create_edge(a, a, "self");
+    for (size_t i = 2; i < ids.size(); ++i) {
+        g.create_edge(a, ids[i], "x");
+        g.create_edge(ids[i], b, "x");
+    }
+    EdgeID kept = g.create_edge(ids[2], ids[3], "x");
+    g.snapshot();
+
+    EXPECT_EQ(g.remove_nodes({a, b, a, 999}), 2u);
+    EXPECT_EQ(g.node_count(), 4u);
+    EXPECT_EQ(g.edge_count(), 1u);
+    EXPECT_TRUE(g.has_edge(kept));
+    EXPECT_EQ(g.get_neighbors(ids[2]), std::vector<NodeID>{ids[3]});
+    EXPECT_EQ(g.get_node(ids[3])->in_degree(), 1u);
+    EXPECT_EQ(g.get_node(ids[4])->out_degree(), 0u);
+    EXPECT_EQ(g.get_node(ids[5])->in_degree(), 0u);
+
+    auto tagged = [&g](int64_t tag) {
+        auto found = g.find_nodes("tag", tag);
+        std::sort(found.begin(), found.end());
+        return found;
+    };
+    EXPECT_EQ(tagged(0), (std::vector<NodeID>{ids[2], ids[4]}));
+    EXPECT_EQ(tagged(1), (std::vector<NodeID>{ids[3], ids[5]}));
+
+    EXPECT_TRUE(g.remove_node(ids[3]));
+    EXPECT_FALSE(g.remove_node(ids[3]));
+    EXPECT_EQ(g.edge_count(), 0u);
+    EXPECT_EQ(g.get_node(ids[2])->out_degree(), 0u);
+    EXPECT_EQ(tagged(1), std::vector<NodeID>{ids[5]});
+
+    auto csr = g.snapshot();
+    EXPECT_EQ(csr->num_vertices(), 3u);
+    EXPECT_EQ(csr->num_edges(), 0u);
+}
+
+TEST(IndexRangeTest, RangePrefixAndOrderedScansMatchBruteForce) {
+    Index index;
+    std::vector<std::pair<int64_t, NodeID>> ints;
+    for (NodeID id = 1; id <= 600; ++id) {
+        int64_t key = static_cast<int64_t>((id * 37) % 200); // 3 IDs per key, shuffled order
+        index.insert(key, id);
+        ints.emplace_back(key, id);
+    }
+    for (const char* name : {"ab", "abc", "abd", "b", "aa", "ab\x7f"}) index.insert(std::string(name), 1000);
+    index.insert(2.5, 2000);
+    index.insert(true, 3000);
+
+    // Every key survives the leaf splits
+    for (int64_t key = 0; key < 200; ++key) EXPECT_EQ(index.find(key).size(), 3u) << key;
+
+    auto expected = [&ints](int64_t lo, int64_t hi, bool descending) {
+        std::vector<std::pair<int64_t, NodeID>> sorted;
+        for (const auto& e : ints) {
+            if (e.first >= lo && e.first <= hi) sorted.push_back(e);
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) { return a.first < b.first; });
+        if (descending) std::stable_sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) { return a.first > b.first; });
+        std::vector<int64_t> keys;
+        for (const auto& e : sorted) keys.push_back(e.first);
+        return keys;
+    };
+    auto keys_of = [](const std::vector<NodeID>& ids) {
+        std::vector<int64_t> keys;
+        for (NodeID id : ids) keys.push_back(static_cast<int64_t>((id * 37) % 200));
+        return keys;
+    };
+    RangeScan between{RangeBound{int64_t{30}}, RangeBound{int64_t{40}}};
+    EXPECT_EQ(keys_of(index.range(between)), expected(30, 40, false));
+    between.lower->inclusive = false;
+    between.upper->inclusive = false;
+    between.descending = true;
+    EXPECT_EQ(keys_of(index.range(between)), expected(31, 39, true));
+
+    // Single bounds stay within the int64 keys
+    EXPECT_EQ(keys_of(index.range({RangeBound{int64_t{190}}, std::nullopt})), expected(190, 199, false));
+    EXPECT_EQ(keys_of(index.range({std::nullopt, RangeBound{int64_t{5}, false}, true})), expected(0, 4, true));
+    EXPECT_TRUE(index.range({RangeBound{int64_t{50}}, RangeBound{int64_t{40}}}).empty());
+    EXPECT_TRUE(index.range({RangeBound{int64_t{500}}, RangeBound{int64_t{600}}}).empty());
+    EXPECT_THROW(index.range({RangeBound{int64_t{1}}, RangeBound{std::string("x")}}), std::runtime_error);
+
+    // Top-N over everything walks the types in reverse variant order
+    auto top = index.range({std::nullopt, std::nullopt, true, 5});
+    EXPECT_EQ(top, (std::vector<NodeID>{3000, 1000, 1000, 1000, 1000}));
+
+    EXPECT_EQ(index.prefix("ab").size(), 4u);
+    EXPECT_EQ(index.prefix("ab", 2).size(), 2u);
+    EXPECT_TRUE(index.prefix("c").empty());
+
+    // Emptied leaves are skipped in both directions
+    for (const auto& [key, id] : ints) {
+        if (key >= 20 && key < 180) index.remove(key, id);
+    }
+    auto survivors = expected(10, 19, false);
+    for (int64_t key : expected(180, 190, false)) survivors.push_back(key);
+    EXPECT_EQ(keys_of(index.range({RangeBound{int64_t{10}}, RangeBound{int64_t{190}}})), survivors);
+    EXPECT_EQ(index.range({RangeBound{int64_t{25}}, RangeBound{int64_t{175}}, true}).size(), 0u);
+
+    // Through the graph
+    Graph g;
+    g.create_index("age");
+    for (int64_t age : {25, 35, 40, 41, 33}) g.get_node(g.create_node())->set_property("age", age);
+    EXPECT_EQ(g.find_nodes_in_range("age", {RangeBound{int64_t{30}}, RangeBound{int64_t{40}}}),
+              (std::vector<NodeID>{5, 2, 3}));
+    EXPECT_TRUE(g.find_nodes_in_range("missing", {}).empty());
+}
+
+// Random inserts and removes against std::map, with enough keys for a three-level tree
+template <typename Traits, typename MakeKey>
+void check_typed_tree(MakeKey make_key) {
+    using Key = typename Traits::Key;
+    TypedBPlusTree<Traits> tree;
+    std::map<Key, std::vector<NodeID>> expected;
+    std::mt19937_64 rng(7);
+    for (NodeID id = 1; id <= 40000; ++id) {
+        Key key = make_key(rng);
+        tree.insert(key, id);
+        expected[key].push_back(id);
+    }
+    for (auto it = expected.begin(); it != expected.end();) {
+        // Drop a third of the keys entirely, and one ID of another third
+        size_t pick = rng() % 3;
+        if (pick == 0) {
+            for (NodeID id : it->second) tree.remove(it->first, id);
+            it = expected.erase(it);
+            continue;
+        }
+        if (pick == 1 && it->second.size() > 1) {
+            tree.remove(it->first, it->second.front());
+            it->second.erase(it->second.begin());
+        }
+        ++it;
+    }
+    for (const auto& [key, ids] : expected) ASSERT_EQ(tree.find(key), ids);
+
+    auto scan = [&tree](const RangeScan& range) {
+        std::vector<Key> keys;
+        tree.scan(range, [&keys](const PropertyValue& key, const std::vector<NodeID>&) {
+            keys.push_back(std::get<Key>(key));
+            return true;
+        });
+        return keys;
+    };
+    std::vector<Key> all;
+    for (const auto& entry : expected) all.push_back(entry.first);
+    EXPECT_EQ(scan({}), all);
+    for (int i = 0; i < 50; ++i) {
+        Key lo = make_key(rng), hi = make_key(rng);
+        if (hi < lo) std::swap(lo, hi);
+        bool lo_inclusive = i % 2, hi_inclusive = i % 3;
+        std::vector<Key> want;
+        for (const Key& key : all) {
+            if ((lo_inclusive ? !(key < lo) : lo < key) && (hi_inclusive ? !(hi < key) : key < hi)) want.push_back(key);
+        }
+        RangeScan range{RangeBound{lo, lo_inclusive}, RangeBound{hi, hi_inclusive}};
+        ASSERT_EQ(scan(range), want);
+        range.descending = true;
+        std::reverse(want.begin(), want.end());
+        ASSERT_EQ(scan(range), want);
+    }
+}
+
+TEST(TypedBPlusTreeTest, MatchesStdMapForEveryKeyType) {
+    check_typed_tree<Int64KeyTraits>([](std::mt19937_64& rng) { return static_cast<int64_t>(rng() % 30000) - 15000; });
+    check_typed_tree<DoubleKeyTraits>([](std::mt19937_64& rng) {
+        return std::ldexp(static_cast<double>(rng() % 20001) - 10000, static_cast<int>(rng() % 40) - 20);
+    });
+    check_typed_tree<BoolKeyTraits>([](std::mt19937_64& rng) { return rng() % 2 == 0; });
+    // Long shared prefixes make the 8-byte codes collide
+    check_typed_tree<StringKeyTraits>([](std::mt19937_64& rng) {
+        std::string key = rng() % 2 ? "user:00000" : "user:0001";
+        return key + std::to_string(rng() % 20000);
+    });
+
+    TypedBPlusTree<StringKeyTraits> names;
+    for (const char* name : {"alpha", "alphabet", "alp", "beta", "al"}) names.insert(name, 1);
+    std::vector<std::string> found;
+    names.scan_prefix("alp", [&found](const PropertyValue& key, const std::vector<NodeID>&) {
+        found.push_back(std::get<std::string>(key));
+        return true;
+    });
+    EXPECT_EQ(found, (std::vector<std::string>{"alp", "alpha", "alphabet"}));
+
+    // The index stays typed for a homogeneous column and falls back once types mix
+    Index index;
+    for (int64_t i = 0; i < 1000; ++i) index.insert(i % 100, static_cast<NodeID>(i));
+    EXPECT_TRUE(index.is_typed());
+    EXPECT_EQ(index.find(int64_t{42}).size(), 10u);
+    EXPECT_TRUE(index.find(std::string("42")).empty());
+    index.insert(std::string("x"), 5000);
+    EXPECT_FALSE(index.is_typed());
+    EXPECT_EQ(index.find(int64_t{42}).size(), 10u);
+    EXPECT_EQ(index.range({RangeBound{int64_t{10}}, RangeBound{int64_t{11}}}).size(), 20u);
+    EXPECT_EQ(index.find(std::string("x")), std::vector<NodeID>{5000});
+}
+
+TEST(IndexBackfillTest, CreateIndexIndexesExistingNodesAndConcurrentWrites) {
+    Graph g;
+    std::vector<NodeRecord> records(20000);
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (i % 4 != 3) records[i].properties["score"] = static_cast<int64_t>(i % 1000);
+    }
+    auto ids = g.bulk_insert(std::move(records), {}).node_ids;
+
+    // One writer keeps changing scores while the index is being built
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (size_t round = 0; !done.load() || round < 2000; ++round) {
+            NodeID id = ids[(round * 7919) % ids.size()];
+            g.get_node(id)->set_property("score", static_cast<int64_t>(round % 1000));
+        }
+    });
+    g.create_index("score");
+    done.store(true);
+    writer.join();
+
+    size_t indexed = 0;
+    for (NodeID id : ids) {
+        auto value = g.get_node(id)->find_property("score");
+        if (!value) continue;
+        auto found = g.find_nodes("score", *value);
+        ASSERT_EQ(std::count(found.begin(), found.end(), id), 1) << id;
+        ++indexed;
+    }
+    EXPECT_EQ(g.find_nodes_in_range("score", {}).size(), indexed);
+
+    // A mixed-type column falls back to the generic tree
+    g.get_node(ids[3])->set_property("tag", std::string("x"));
+    g.get_node(ids[7])->set_property("tag", int64_t{1});
+    g.create_index("tag");
+    EXPECT_EQ(g.find_nodes("tag", std::string("x")), std::vector<NodeID>{ids[3]});
+    EXPECT_EQ(g.find_nodes("tag", int64_t{1}), std::vector<NodeID>{ids[7]});
+}
+
+TEST(IndexBackfillTest, FailedBuildWakesWaitersAndIsDiscarded) {
+    Index index(true);
+    std::atomic<bool> threw{false};
+    std::thread reader([&]() {
+        try {
+            index.find(int64_t{1});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    index.abandon_build();
+    reader.join(); // would hang if the waiter were not woken
+    EXPECT_TRUE(threw);
+    index.insert(int64_t{1}, 7); // dropped, not applied to the half-built tree
+    EXPECT_THROW(index.find(int64_t{1}), std::runtime_error);
+
+    // A paged build whose long keys need more frames than the pool has leaves no index
+    // behind, in memory or in the file
+    const std::string index_file = "test_failed_build.idx";
+    std::remove(index_file.c_str());
+    Graph g;
+    NodeID first = g.create_node();
+    for (int i = 0; i < 50; ++i) {
+        NodeID id = i ? g.create_node() : first;
+        g.get_node(id)->set_property("name", std::string(20000, 'a') + std::to_string(i));
+    }
+    g.open_index_file(index_file, 2);
+    EXPECT_THROW(g.create_index("name", IndexKind::Paged), std::runtime_error);
+    EXPECT_EQ(g.find_nodes("name", std::string("x")), std::vector<NodeID>{});
+    g.get_node(first)->set_property("name", std::string("x")); // no index left to write to
+    g.flush_indexes();
+    EXPECT_TRUE(IndexStore(index_file, 8).names().empty());
+    std::remove(index_file.c_str());
+}
+
+TEST(TypedBPlusTreeTest, BulkLoadBuildsASearchableTreeThatAcceptsWrites) {
+    std::vector<std::pair<PropertyValue, NodeID>> sorted;
+    for (int64_t key = 0; key < 50000; ++key) {
+        for (NodeID id = 0; id < static_cast<NodeID>(1 + key % 3); ++id) sorted.emplace_back(key * 2, id);
+    }
+    TypedBPlusTree<Int64KeyTraits> tree;
+    tree.bulk_load(sorted);
+    for (int64_t key = 0; key < 50000; ++key) {
+        ASSERT_EQ(tree.find(key * 2).size(), static_cast<size_t>(1 + key % 3));
+        ASSERT_TRUE(tree.find(key * 2 + 1).empty());
+    }
+    // Inserts into the packed nodes split them as usual
+    for (int64_t key = 0; key < 50000; ++key) tree.insert(key * 2 + 1, 9);
+    std::vector<int64_t> keys;
+    tree.scan({RangeBound{int64_t{99990}}, std::nullopt}, [&keys](const PropertyValue& key, const std::vector<NodeID>&) {
+        keys.push_back(std::get<int64_t>(key));
+        return true;
+    });
+    EXPECT_EQ(keys, (std::vector<int64_t>{99990, 99991, 99992, 99993, 99994, 99995, 99996, 99997, 99998, 99999}));
+}
+
+TEST(TypedBPlusTreeTest, ConcurrentWritersAndReadersSeeConsistentState) {
+    // 8-byte codes of these keys collide, so routing also compares the full strings
+    auto key_of = [](int k) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "user:%06d", k);
+        return std::string(buf);
+    };
+    constexpr int kWriters = 4;
+    constexpr int kKeys = 20000;
+    TypedBPlusTree<StringKeyTraits> tree;
+    std::atomic<int> writers_left{kWriters};
+    std::atomic<bool> readers_ok{true};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kWriters; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int k = t; k < kKeys; k += kWriters) {
+                tree.insert(key_of(k), k * 2);
+                tree.insert(key_of(k), k * 2 + 1);
+                if (k % 2 == 0) tree.remove(key_of(k), k * 2 + 1);
+                tree.insert("hot", k);
+            }
+            --writers_left;
+        });
+    }
+    for (int r = 0; r < 2; ++r) {
+        threads.emplace_back([&]() {
+            size_t hot_seen = 0;
+            while (writers_left.load() > 0) {
+                // Keys come back strictly ordered, and the append-only key only grows
+                std::string prev;
+                tree.scan({}, [&](const PropertyValue& key, const std::vector<NodeID>& ids) {
+                    const auto& k = std::get<std::string>(key);
+                    if (k <= prev || ids.empty()) readers_ok = false;
+                    prev = k;
+                    return true;
+                });
+                size_t hot = tree.find("hot").size();
+                if (hot < hot_seen) readers_ok = false;
+                hot_seen = hot;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_TRUE(readers_ok.load());
+    EXPECT_EQ(tree.find("hot").size(), static_cast<size_t>(kKeys));
+    for (int k = 0; k < kKeys; ++k) {
+        std::vector<NodeID> want{static_cast<NodeID>(k * 2)};
+        if (k % 2) want.push_back(k * 2 + 1);
+        ASSERT_EQ(tree.find(key_of(k)), want);
+    }
+    size_t keys = 0;
+    tree.scan({RangeBound{std::string("user:"), true}, std::nullopt, true}, [&keys](const PropertyValue&, const std::vector<NodeID>&) {
+        ++keys;
+        return true;
+    });
+    EXPECT_EQ(keys, static_cast<size_t>(kKeys));
+}
+
+TEST(IndexConcurrencyTest, ParallelSetPropertyKeepsTheIndexExact) {
+    Graph g;
+    g.create_index("score");
+    std::vector<NodeID> ids;
+    for (int i = 0; i < 4000; ++i) ids.push_back(g.create_node());
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t]() {
+            // Each node moves through several values; its last one is i % 10
+            for (int round = 0; round < 3; ++round) {
+                for (size_t i = t; i < ids.size(); i += 4) {
+                    g.get_node(ids[i])->set_property("score", static_cast<int64_t>(round == 2 ? i % 10 : 100 + round));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_TRUE(g.find_nodes("score", int64_t{100}).empty());
+    EXPECT_TRUE(g.find_nodes("score", int64_t{101}).empty());
+    for (int64_t score = 0; score < 10; ++score) {
+        auto found = g.find_nodes("score", score);
+        ASSERT_EQ(found.size(), ids.size() / 10);
+        for (NodeID id : found) EXPECT_EQ(std::get<int64_t>(g.get_node(id)->get_property("score")), score);
+    }
+}
+
+TEST(HashIndexTest, MatchesStdMapThroughResizesAndRemovals) {
+    HashIndex index;
+    std::map<PropertyValue, std::vector<NodeID>> expected;
+    std::mt19937_64 rng(11);
+    auto random_key = [&rng]() -> PropertyValue {
+        switch (rng() % 3) {
+            case 0: return static_cast<int64_t>(rng() % 5000);
+            case 1: return "k" + std::to_string(rng() % 5000);
+            default: return static_cast<double>(rng() % 100) / 4;
+        }
+    };
+    // Grows from 16 slots through several incremental resizes, removing as it goes
+    for (NodeID id = 0; id < 40000; ++id) {
+        PropertyValue key = random_key();
+        index.insert(key, id);
+        expected[key].push_back(id);
+        if (id % 3 == 0) {
+            PropertyValue victim = random_key();
+            auto it = expected.find(victim);
+            if (it != expected.end()) {
+                index.remove(victim, it->second.front());
+                it->second.erase(it->second.begin());
+                if (it->second.empty()) expected.erase(it);
+            }
+        }
+        if (id % 997 == 0) {
+            for (const auto& [k, ids] : expected) ASSERT_EQ(index.find(k), ids);
+        }
+    }
+    EXPECT_EQ(index.size(), expected.size());
+    for (const auto& [k, ids] : expected) ASSERT_EQ(index.find(k), ids);
+    EXPECT_TRUE(index.find(int64_t{-1}).empty());
+    // Equal values of different types are different keys
+    index.insert(int64_t{7}, 1);
+    index.insert(7.0, 2);
+    expected[int64_t{7}].push_back(1);
+    expected[7.0].push_back(2);
+    EXPECT_EQ(index.find(7.0).back(), 2u);
+    EXPECT_EQ(index.find(int64_t{7}).back(), 1u);
+
+    // Draining every key leaves an empty index
+    for (const auto& [k, ids] : expected) {
+        for (NodeID id : ids) index.remove(k, id);
+    }
+    for (const auto& [k, ids] : expected) ASSERT_TRUE(index.find(k).empty());
+    EXPECT_EQ(index.size(), 0u);
+}
+
+TEST(HashIndexTest, GraphHashIndexAnswersEqualityOnly) {
+    Graph g;
+    std::vector<NodeID> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(g.create_node());
+        g.get_node(ids.back())->set_property("email", "user" + std::to_string(i) + "@example.com");
+    }
+    g.create_index("email", IndexKind::Hash);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(g.find_nodes("email", "user" + std::to_string(i) + "@example.com"), std::vector<NodeID>{ids[i]});
+    }
+    g.get_node(ids[0])->set_property("email", std::string("changed@example.com"));
+    EXPECT_TRUE(g.find_nodes("email", std::string("user0@example.com")).empty());
+    EXPECT_EQ(g.find_nodes("email", std::string("changed@example.com")), std::vector<NodeID>{ids[0]});
+    g.remove_node(ids[1]);
+    EXPECT_TRUE(g.find_nodes("email", std::string("user1@example.com")).empty());
+
+    EXPECT_THROW(g.find_nodes_in_range("email", {}), std::runtime_error);
+    EXPECT_THROW(g.find_nodes_with_prefix("email", "user"), std::runtime_error);
+}
+
+TEST(EdgeIndexTest, EdgeIndexesPostEdgeIdsApartFromNodeIndexes) {
+    Graph g;
+    std::vector<NodeID> nodes;
+    for (int i = 0; i < 10; ++i) {
+        nodes.push_back(g.create_node());
+        g.get_node(nodes.back())->set_property("since", int64_t{i});
+    }
+    std::vector<EdgeID> edges;
+    for (int i = 0; i < 9; ++i) {
+        edges.push_back(g.create_edge(nodes[i], nodes[i + 1], "FOLLOWS"));
+        g.get_edge(edges.back())->set_property("since", int64_t{2000 + i});
+    }
+    // Backfill, then live writes
+    g.create_index("since");
+    g.create_edge_index("since");
+    EdgeID late = g.create_edge(nodes[0], nodes[9], "FOLLOWS");
+    g.get_edge(late)->set_property("since", int64_t{2100});
+
+    EXPECT_EQ(g.find_edges("since", int64_t{2003}), std::vector<EdgeID>{edges[3]});
+    EXPECT_EQ(g.find_edges("since", int64_t{2100}), std::vector<EdgeID>{late});
+    EXPECT_EQ(g.find_nodes("since", int64_t{3}), std::vector<NodeID>{nodes[3]});
+    EXPECT_TRUE(g.find_nodes("since", int64_t{2003}).empty());
+    EXPECT_TRUE(g.find_edges("since", int64_t{3}).empty());
+    // since > 2005
+    auto recent = g.find_edges_in_range("since", {RangeBound{int64_t{2005}, false}, std::nullopt});
+    EXPECT_EQ(recent, (std::vector<EdgeID>{edges[6], edges[7], edges[8], late}));
+
+    g.get_edge(edges[6])->set_property("since", int64_t{1990});
+    g.remove_edge(edges[7]);
+    g.remove_node(nodes[9]); // takes edges[8] and `late` with it
+    EXPECT_TRUE(g.find_edges_in_range("since", {RangeBound{int64_t{2005}, false}, std::nullopt}).empty());
+    EXPECT_EQ(g.find_edges("since", int64_t{1990}), std::vector<EdgeID>{edges[6]});
+
+    // Bulk-inserted edges are indexed too
+    EdgeRecord record;
+    record.from = nodes[0];
+    record.to = nodes[1];
+    record.label = "LIKES";
+    record.properties["since"] = int64_t{2050};
+    auto inserted = g.bulk_insert({}, {record}).edge_ids;
+    EXPECT_EQ(g.find_edges("since", int64_t{2050}), inserted);
+}
+
+TEST(EdgeIndexTest, LabelIndexAndLabelPartitionedAdjacency) {
+    Graph g;
+    NodeID hub = g.create_node();
+    std::vector<NodeID> others;
+    for (int i = 0; i < 6; ++i) others.push_back(g.create_node());
+    const char* labels[] = {"FOLLOWS", "LIKES", "BLOCKS"};
+    std::map<std::string, std::set<EdgeID>> expected;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 6; ++i) {
+            std::string label = labels[(i + round) % 3];
+            expected[label].insert(g.create_edge(hub, others[i], label));
+        }
+    }
+    EdgeRecord record;
+    record.from = others[0];
+    record.to = hub;
+    record.label = "FOLLOWS";
+    g.bulk_insert({}, {record, record});
+
+    auto labeled_out = [&g, hub](const std::string& label) {
+        std::set<EdgeID> found;
+        g.for_each_out_edge(hub, label, [&found](EdgeID edge, NodeID, int64_t) { found.insert(edge); });
+        return found;
+    };
+    auto by_label = [&g](const std::string& label) {
+        auto found = g.find_edges_by_label(label);
+        return std::set<EdgeID>(found.begin(), found.end());
+    };
+    std::set<EdgeID> bulk_follows;
+    g.for_each_in_edge(hub, "FOLLOWS", [&bulk_follows](EdgeID edge, NodeID, int64_t) { bulk_follows.insert(edge); });
+    ASSERT_EQ(bulk_follows.size(), 2u);
+    expected["FOLLOWS"].insert(bulk_follows.begin(), bulk_follows.end());
+
+    EXPECT_EQ(labeled_out("LIKES"), expected["LIKES"]);
+    EXPECT_EQ(labeled_out("BLOCKS"), expected["BLOCKS"]);
+    EXPECT_EQ(by_label("LIKES"), expected["LIKES"]);
+    EXPECT_EQ(by_label("FOLLOWS"), expected["FOLLOWS"]);
+    EXPECT_TRUE(labeled_out("UNKNOWN").empty());
+    EXPECT_TRUE(g.find_edges_by_label("UNKNOWN").empty());
+    EXPECT_EQ(g.get_node(hub)->out_degree(), 18u);
+
+    // Removals keep both structures exact, including swaps inside the label index
+    for (EdgeID edge : std::set<EdgeID>(expected["LIKES"])) {
+        if (edge % 2) continue;
+        ASSERT_TRUE(g.remove_edge(edge));
+        expected["LIKES"].erase(edge);
+    }
+    EXPECT_EQ(labeled_out("LIKES"), expected["LIKES"]);
+    EXPECT_EQ(by_label("LIKES"), expected["LIKES"]);
+    g.remove_node(others[0]);
+    for (auto& [label, edges] : expected) {
+        for (auto it = edges.begin(); it != edges.end();) {
+            it = g.has_edge(*it) ? std::next(it) : edges.erase(it);
+        }
+        EXPECT_EQ(by_label(label), edges) << label;
+    }
+    EXPECT_EQ(labeled_out("BLOCKS"), expected["BLOCKS"]);
+}
+
+TEST(CompositeIndexTest, EncodingPreservesTupleOrder) {
+    std::vector<PropertyValue> values = {int64_t{-5}, int64_t{0}, int64_t{7}, -2.5, 0.0, -0.0, 3.25,
+                                         std::string(), std::string("a"), std::string("a\0", 2),
+                                         std::string("ab"), std::string("\xff"), false, true};
+    for (const auto& a1 : values) {
+        for (const auto& a2 : values) {
+            for (const auto& b1 : values) {
+                for (const auto& b2 : {values[1], values[8], values[13]}) {
+                    std::vector<PropertyValue> a{a1, a2}, b{b1, b2};
+                    std::string ea = CompositeIndex::encode(a), eb = CompositeIndex::encode(b);
+                    ASSERT_EQ(a < b, ea < eb);
+                    ASSERT_EQ(a == b, ea == eb);
+                }
+            }
+        }
+    }
+}
+
+TEST(CompositeIndexTest, EqualityPrefixPlusRangeMatchesBruteForce) {
+    Graph g;
+    struct Row {
+        NodeID id;
+        int64_t tenant;
+        int64_t created;
+        std::string region;
+    };
+    std::vector<Row> rows;
+    std::mt19937_64 rng(5);
+    for (int i = 0; i < 3000; ++i) {
+        NodeID id = g.create_node();
+        Row row{id, static_cast<int64_t>(rng() % 8), static_cast<int64_t>(rng() % 500), i % 2 ? "eu" : "us"};
+        Node* node = g.get_node(id);
+        node->set_property("tenant", row.tenant);
+        node->set_property("created_at", row.created);
+        node->set_property("region", row.region);
+        rows.push_back(row);
+        if (i == 1500) g.create_composite_index({"tenant", "created_at", "region"});
+    }
+    // A node lacking a column stays out of the index
+    NodeID partial = g.create_node();
+    g.get_node(partial)->set_property("tenant", int64_t{3});
+    // Moves and removals after the backfill
+    for (size_t i = 0; i < rows.size(); i += 7) {
+        rows[i].created = static_cast<int64_t>(rng() % 500);
+        g.get_node(rows[i].id)->set_property("created_at", rows[i].created);
+    }
+    for (size_t i = 3; i < rows.size(); i += 97) g.remove_node(rows[i].id);
+    for (size_t i = 3; i < rows.size(); i += 97) rows[i].tenant = -1;
+
+    const std::vector<std::string> keys{"tenant", "created_at", "region"};
+    auto expect = [&rows](auto pred) {
+        std::vector<std::tuple<int64_t, std::string, NodeID>> matched;
+        for (const Row& row : rows) {
+            if (row.tenant >= 0 && pred(row)) matched.emplace_back(row.created, row.region, row.id);
+        }
+        std::sort(matched.begin(), matched.end());
+        std::vector<NodeID> ids;
+        for (const auto& m : matched) ids.push_back(std::get<2>(m));
+        return ids;
+    };
+    auto sorted = [](std::vector<NodeID> ids) {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    for (int64_t tenant = 0; tenant < 8; ++tenant) {
+        // tenant = X AND created_at > 250, in created_at order
+        auto found = g.find_nodes_composite(keys, {tenant}, {RangeBound{int64_t{250}, false}, std::nullopt});
+        auto want = expect([tenant](const Row& r) { return r.tenant == tenant && r.created > 250; });
+        ASSERT_EQ(sorted(found), sorted(want));
+        // created_at BETWEEN 100 AND 120 inclusive
+        found = g.find_nodes_composite(keys, {tenant}, {RangeBound{int64_t{100}}, RangeBound{int64_t{120}}});
+        ASSERT_EQ(sorted(found), sorted(expect([tenant](const Row& r) {
+                      return r.tenant == tenant && r.created >= 100 && r.created <= 120;
+                  })));
+        // created_at < 40, descending
+        found = g.find_nodes_composite(keys, {tenant}, {std::nullopt, RangeBound{int64_t{40}, false}, true});
+        ASSERT_EQ(sorted(found), sorted(expect([tenant](const Row& r) { return r.tenant == tenant && r.created < 40; })));
+        // Whole prefix, and a full tuple
+        ASSERT_EQ(sorted(g.find_nodes_composite(keys, {tenant})),
+                  sorted(expect([tenant](const Row& r) { return r.tenant == tenant; })));
+        ASSERT_EQ(sorted(g.find_nodes_composite(keys, {tenant, int64_t{42}, std::string("eu")})),
+                  sorted(expect([tenant](const Row& r) {
+                      return r.tenant == tenant && r.created == 42 && r.region == "eu";
+                  })));
+    }
+    // A range on the last column; an int range never returns a string column value
+    auto eu = g.find_nodes_composite(keys, {int64_t{1}, int64_t{42}}, {std::nullopt, RangeBound{std::string("f"), false}});
+    EXPECT_EQ(sorted(eu), sorted(expect([](const Row& r) { return r.tenant == 1 && r.created == 42 && r.region == "eu"; })));
+    NodeID odd = g.create_node();
+    g.get_node(odd)->set_property("tenant", int64_t{1});
+    g.get_node(odd)->set_property("created_at", std::string("late"));
+    g.get_node(odd)->set_property("region", std::string("eu"));
+    auto late = g.find_nodes_composite(keys, {int64_t{1}}, {RangeBound{int64_t{250}, false}, std::nullopt});
+    EXPECT_EQ(std::count(late.begin(), late.end(), odd), 0);
+    auto all = g.find_nodes_composite(keys, {int64_t{1}});
+    EXPECT_EQ(all.back(), odd);
+    // A missing index yields nothing; too many values throw
+    EXPECT_TRUE(g.find_nodes_composite({"tenant", "region"}, {int64_t{1}}).empty());
+    EXPECT_THROW(g.find_nodes_composite(keys, {int64_t{1}, int64_t{2}, std::string("eu"), int64_t{4}}),
+                 std::runtime_error);
+}
+
+TEST(PagedBPlusTreeTest, MatchesStdMapThroughEvictionOverflowAndReopen) {
+    const std::string filename = "test_paged_tree.db";
+    std::remove(filename.c_str());
+    std::map<PropertyValue, std::vector<NodeID>> expected;
+    std::mt19937_64 rng(5);
+    auto random_key = [&rng]() -> PropertyValue {
+        switch (rng() % 4) {
+            case 0: return static_cast<int64_t>(rng() % 3000) - 1000;
+            case 1: return "k" + std::to_string(rng() % 3000);
+            case 2: return static_cast<double>(rng() % 400) / 8;
+            // Long keys spill into overflow pages; they share a prefix longer than a cell holds
+            default: return std::string(300 + rng() % 6000, 'x') + std::to_string(rng() % 50);
+        }
+    };
+    auto check = [&expected](const PagedBPlusTree& tree) {
+        ASSERT_EQ(tree.size(), expected.size());
+        for (const auto& [key, ids] : expected) ASSERT_EQ(tree.find(key), ids);
+        // Ranges, both directions, against the map
+        std::vector<NodeID> want, want_desc;
+        for (auto it = expected.lower_bound(int64_t{-200}); it != expected.upper_bound(int64_t{700}); ++it) {
+            want.insert(want.end(), it->second.begin(), it->second.end());
+        }
+        for (auto it = expected.upper_bound(int64_t{700}); it != expected.lower_bound(int64_t{-200});) {
+            --it;
+            want_desc.insert(want_desc.end(), it->second.begin(), it->second.end());
+        }
+        ASSERT_EQ(tree.range({RangeBound{int64_t{-200}}, RangeBound{int64_t{700}}}), want);
+        ASSERT_EQ(tree.range({RangeBound{int64_t{-200}}, RangeBound{int64_t{700}}, true}), want_desc);
+        want.clear();
+        for (auto it = expected.upper_bound(std::string("k2")); it != expected.end(); ++it) {
+            if (!std::holds_alternative<std::string>(it->first)) break;
+            want.insert(want.end(), it->second.begin(), it->second.end());
+        }
+        ASSERT_EQ(tree.range({RangeBound{std::string("k2"), false}, std::nullopt}), want);
+        want.clear();
+        for (const auto& [key, ids] : expected) {
+            const std::string* s = std::get_if<std::string>(&key);
+            if (s && s->compare(0, 3, "k12") == 0) want.insert(want.end(), ids.begin(), ids.end());
+        }
+        ASSERT_EQ(tree.prefix("k12"), want);
+        ASSERT_EQ(tree.prefix("k12", 3), std::vector<NodeID>(want.begin(), want.begin() + std::min<size_t>(3, want.size())));
+    };
+
+    PageID header;
+    {
+        // A pool far smaller than the tree, so pages are evicted and read back throughout
+        storage::DiskManager disk(filename);
+        buffer::BufferPoolManager pool(16, &disk);
+        PagedBPlusTree tree(pool);
+        header = tree.header_page();
+        for (NodeID id = 1; id <= 12000; ++id) {
+            PropertyValue key = id % 5 == 0 ? PropertyValue(std::string("hot")) : random_key();
+            tree.insert(key, id);
+            expected[key].push_back(id);
+            if (id % 4 == 0) {
+                auto it = expected.find(random_key());
+                if (it != expected.end()) {
+                    tree.remove(it->first, it->second.back());
+                    it->second.pop_back();
+                    if (it->second.empty()) expected.erase(it);
+                }
+            }
+        }
+        // "hot" has thousands of IDs, chained over several pages
+        ASSERT_GT(expected[std::string("hot")].size(), 1000u);
+        check(tree);
+    }
+
+    storage::DiskManager disk(filename);
+    buffer::BufferPoolManager pool(16, &disk);
+    PagedBPlusTree tree(pool, header);
+    check(tree);
+    // Shrinking the chained list below the inline threshold moves it back into its cell
+    std::vector<NodeID>& hot = expected[std::string("hot")];
+    while (hot.size() > 5) {
+        tree.remove(std::string("hot"), hot.front());
+        hot.erase(hot.begin());
+    }
+    tree.remove(std::string("hot"), 424242); // not in the list
+    check(tree);
+    // Enough keys in random order to split inner pages as well as leaves
+    std::vector<int64_t> many(50000);
+    std::iota(many.begin(), many.end(), int64_t{10000});
+    std::shuffle(many.begin(), many.end(), rng);
+    for (int64_t key : many) {
+        tree.insert(key, static_cast<NodeID>(key));
+        expected[key].push_back(static_cast<NodeID>(key));
+    }
+    check(tree);
+    auto top = tree.range({RangeBound{int64_t{10000}}, std::nullopt, true, 3});
+    EXPECT_EQ(top, (std::vector<NodeID>{59999, 59998, 59997}));
+    // Draining every key empties the tree, and freed pages are reused
+    for (const auto& [key, ids] : expected) {
+        for (NodeID id : ids) tree.remove(key, id);
+    }
+    expected.clear();
+    check(tree);
+    PageID pages = disk.num_pages();
+    for (NodeID id = 1; id <= 300; ++id) tree.insert(std::string(5000, 'y'), id);
+    EXPECT_EQ(tree.find(std::string(5000, 'y')).size(), 300u);
+    EXPECT_EQ(disk.num_pages(), pages);
+    std::remove(filename.c_str());
+}
+
+TEST(PagedBPlusTreeTest, GraphPagedIndexesSurviveRestartWithoutRebuild) {
+    const std::string index_file = "test_paged_indexes.db";
+    const std::string graph_file = "test_paged_graph.db";
+    std::remove(index_file.c_str());
+    const std::vector<std::string> keys{"tenant", "score"};
+    std::vector<NodeID> ids;
+    EdgeID edge;
+    {
+        Graph g;
+        for (int64_t i = 0; i < 2000; ++i) {
+            NodeID id = g.create_node();
+            ids.push_back(id);
+            g.get_node(id)->set_property("age", i % 90);
+            g.get_node(id)->set_property("tenant", i % 7);
+            g.get_node(id)->set_property("score", i);
+        }
+        edge = g.create_edge(ids[0], ids[1], "knows");
+        g.get_edge(edge)->set_property("since", int64_t{2019});
+
+        // Without an index file there is nowhere to put a paged index
+        EXPECT_THROW(g.create_index("age", IndexKind::Paged), std::runtime_error);
+        g.open_index_file(index_file, 32);
+        g.create_index("age", IndexKind::Paged);
+        g.create_composite_index(keys, IndexKind::Paged);
+        g.create_edge_index("since", IndexKind::Paged);
+        // Writes after the build go to the pages too
+        g.get_node(ids[3])->set_property("age", int64_t{500});
+        g.remove_node(ids[4]);
+        EXPECT_EQ(g.find_nodes("age", int64_t{500}), std::vector<NodeID>{ids[3]});
+        ASSERT_TRUE(g.save_to_file(graph_file));
+    }
+
+    Graph g;
+    ASSERT_TRUE(g.load_from_file(graph_file));
+    g.open_index_file(index_file, 32);
+    EXPECT_EQ(g.find_nodes("age", int64_t{500}), std::vector<NodeID>{ids[3]});
+    auto young = g.find_nodes_in_range("age", {std::nullopt, RangeBound{int64_t{0}}});
+    EXPECT_EQ(young.size(), 23u); // i = 0, 90, ..., 1980
+    EXPECT_EQ(young.front(), ids[0]);
+    auto tenant_top = g.find_nodes_composite(keys, {int64_t{2}}, {RangeBound{int64_t{1990}}, std::nullopt});
+    EXPECT_EQ(tenant_top, (std::vector<NodeID>{ids[1990], ids[1997]}));
+    EXPECT_EQ(g.find_edges("since", int64_t{2019}), std::vector<EdgeID>{edge});
+    // The attached indexes stay live
+    g.get_node(ids[0])->set_property("age", int64_t{500});
+    EXPECT_EQ(g.find_nodes("age", int64_t{500}), (std::vector<NodeID>{ids[3], ids[0]}));
+    EXPECT_THROW(g.open_index_file(index_file), std::runtime_error);
+
+    // In the other order the load would post every node a second time
+    Graph reversed;
+    reversed.open_index_file(index_file, 32);
+    EXPECT_THROW(reversed.load_from_file(graph_file), std::runtime_error);
+    std::remove(index_file.c_str());
+    std::remove(graph_file.c_str());
+}
+
+namespace {
+
+// Everything observable about a graph, keyed by ID so that two graphs compare directly
+struct GraphDump {
+    std::map<NodeID, std::pair<PropertyMap, std::vector<std::tuple<EdgeID, NodeID, int64_t>>>> nodes;
+    std::map<EdgeID, std::tuple<NodeID, NodeID, std::string, int64_t, PropertyMap>> edges;
+    std::vector<EdgeID> labeled;
+};
+
+GraphDump dump_graph(Graph& g) {
+    GraphDump dump;
+    g.for_each_node([&](Node& node) {
+        auto& [properties, out] = dump.nodes[node.get_id()];
+        properties = node.get_properties();
+        node.for_each_out_edge([&out](EdgeID e, NodeID to, int64_t w) { out.emplace_back(e, to, w); });
+        std::sort(out.begin(), out.end());
+    });
+    g.for_each_edge([&](Edge& edge) {
+        dump.edges[edge.id()] = {edge.from_node(), edge.to_node(), edge.label(), edge.get_weight(),
+                                 edge.get_properties()};
+    });
+    dump.labeled = g.find_edges_by_label("b");
+    std::sort(dump.labeled.begin(), dump.labeled.end());
+    return dump;
+}
+
+} // namespace
+
+TEST(PagedStorageTest, MatchesInMemoryGraphThroughEvictionAndReopen) {
+    const std::string file = "test_paged_storage.db";
+    std::remove(file.c_str());
+    // 4 records per shard and 16 pages: almost every access misses
+    GraphOptions options;
+    options.storage = StorageEngine::Paged;
+    options.path = file;
+    options.pool_pages = 16;
+    options.cache_records = 0;
+
+    Graph memory;
+    GraphDump expected;
+    {
+        Graph paged(options);
+        std::mt19937 rng(7);
+        std::vector<NodeRecord> nodes(2000);
+        std::vector<EdgeRecord> edges;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].id = i + 1;
+            nodes[i].properties["rank"] = static_cast<int64_t>(i);
+            // Some property blobs need an overflow chain of several pages
+            if (i % 500 == 0) nodes[i].properties["blob"] = std::string(9000, static_cast<char>('a' + i % 26));
+        }
+        for (int i = 0; i < 6000; ++i) {
+            NodeID from = rng() % 2000 + 1;
+            NodeID to = rng() % 2000 + 1;
+            edges.push_back({0, from, to, i % 3 ? "a" : "b", static_cast<int64_t>(i), {}});
+        }
+        // A hub whose adjacency spans several overflow pages
+        for (NodeID to = 2; to <= 1500; ++to) edges.push_back({0, 1, to, "hub", 1, {}});
+        for (Graph* g : {&memory, &paged}) {
+            g->bulk_insert(nodes, edges);
+            for (NodeID id = 1; id <= 2000; id += 3) g->get_node(id)->set_property("name", "n" + std::to_string(id));
+            for (NodeID id = 10; id <= 2000; id += 10) g->create_edge(id, id - 1, "b");
+            g->set_edge_weight(5, -5);
+            g->get_edge(7)->set_property("since", int64_t{2020});
+            g->remove_edge(8);
+            g->remove_node(3);
+            g->remove_node(1500);
+            g->create_node();
+        }
+        EXPECT_EQ(paged.node_count(), memory.node_count());
+        EXPECT_EQ(paged.edge_count(), memory.edge_count());
+        expected = dump_graph(memory);
+        GraphDump actual = dump_graph(paged);
+        EXPECT_EQ(actual.nodes, expected.nodes);
+        EXPECT_EQ(actual.edges, expected.edges);
+        EXPECT_EQ(actual.labeled, expected.labeled);
+        EXPECT_EQ(paged.get_neighbors(1).size(), memory.get_neighbors(1).size());
+        EXPECT_EQ(std::get<std::string>(paged.get_node(1001)->get_property("blob")), std::string(9000, 'm'));
+
+        auto paged_csr = paged.snapshot();
+        auto memory_csr = memory.snapshot();
+        EXPECT_EQ(paged_csr->num_edges(), memory_csr->num_edges());
+        EXPECT_EQ(bfs(*paged_csr, 1), bfs(*memory_csr, 1));
+        paged.create_index("rank");
+        EXPECT_EQ(paged.find_nodes("rank", int64_t{42}), std::vector<NodeID>{43});
+    }
+
+    // The file holds the whole graph
+    Graph reopened(options);
+    EXPECT_EQ(reopened.node_count(), memory.node_count());
+    EXPECT_EQ(reopened.edge_count(), memory.edge_count());
+    GraphDump actual = dump_graph(reopened);
+    EXPECT_EQ(actual.nodes, expected.nodes);
+    EXPECT_EQ(actual.edges, expected.edges);
+    EXPECT_EQ(actual.labeled, expected.labeled);
+    EXPECT_EQ(reopened.create_node(), memory.create_node());
+    EXPECT_TRUE(reopened.remove_edge(reopened.find_edges_by_label("b").front()));
+    std::remove(file.c_str());
+}
+
+TEST(PagedStorageTest, ReferencedRecordsSurviveShedding) {
+    const std::string file = "test_paged_pins.db";
+    std::remove(file.c_str());
+    GraphOptions options;
+    options.storage = StorageEngine::Paged;
+    options.path = file;
+    options.cache_records = 0; // 4 records per shard
+    EdgeID e;
+    {
+        Graph g(options);
+        for (NodeID id = 1; id <= 64 * 20; ++id) g.create_node(id);
+        RecordRef<Node> held = g.get_node_ref(1);
+        e = g.create_edge(1, 2, "x");
+        RecordRef<Edge> edge = g.get_edge_ref(e);
+        // Every other node of shard 1 passes through its cache, and the edge's shard too
+        for (NodeID id = 65; id <= 64 * 20; id += 64) {
+            g.get_node(id)->set_property("seen", true);
+            g.create_edge(id, 2, "x");
+        }
+        held->set_property("name", std::string("kept"));
+        edge->set_property("since", int64_t{2020});
+        EXPECT_EQ(g.get_node_ref(1), held);
+    }
+    Graph reopened(options);
+    EXPECT_EQ(std::get<std::string>(reopened.get_node(1)->get_property("name")), "kept");
+    EXPECT_EQ(std::get<int64_t>(reopened.get_edge(e)->get_property("since")), 2020);
+    std::remove(file.c_str());
+}
+
+TEST(PagedStorageTest, RemovedRecordsOutliveTheirReferences) {
+    const std::string file = "test_paged_removed_pins.db";
+    std::remove(file.c_str());
+    GraphOptions options;
+    options.storage = StorageEngine::Paged;
+    options.path = file;
+    options.cache_records = 0; // 4 records per shard
+    Graph g(options);
+    g.create_node(1);
+    g.create_node(2);
+    EdgeID e = g.create_edge(1, 2, "x");
+    RecordRef<Node> held = g.get_node_ref(1);
+    RecordRef<Edge> edge = g.get_edge_ref(e);
+    RecordRef<Node> copy = held;
+    ASSERT_TRUE(g.remove_node(1));
+    EXPECT_EQ(g.get_node(1), nullptr);
+    EXPECT_EQ(g.get_edge(e), nullptr);
+    // New records in the same shards must not land on the removed ones
+    for (NodeID id = 65; id <= 64 * 20; id += 64) {
+        g.create_node(id);
+        g.create_edge(id, 2, "x");
+    }
+    EXPECT_EQ(held->get_id(), 1u);
+    EXPECT_EQ(edge->id(), e);
+    EXPECT_TRUE(held->pinned());
+    held = nullptr;
+    copy = nullptr;
+    edge = nullptr;
+    for (NodeID id = 66; id <= 64 * 20; id += 64) {
+        g.create_node(id);
+        g.create_edge(id, 2, "x");
+    }
+    for (NodeID id = 65; id <= 64 * 20; id += 64) {
+        Node* node = g.get_node(id);
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->get_id(), id);
+        EXPECT_FALSE(node->pinned());
+    }
+    EXPECT_EQ(g.node_count(), 1u + 2 * 19);
+    std::remove(file.c_str());
+}
+
+TEST(PagedStorageTest, RejectsIdsPastTheDenseLimit) {
+    const std::string file = "test_paged_limit.db";
+    std::remove(file.c_str());
+    GraphOptions options;
+    options.storage = StorageEngine::Paged;
+    options.path = file;
+    {
+        Graph g(options);
+        NodeID a = g.create_node();
+        EXPECT_THROW(g.create_node(kDenseIdLimit), std::runtime_error);
+        std::vector<NodeRecord> nodes(2);
+        nodes[1].id = uint64_t{1} << 40;
+        EXPECT_THROW(g.bulk_insert(nodes, {}), std::runtime_error);
+        EXPECT_THROW(g.create_edge(a, a, "self", uint64_t{1} << 60), std::runtime_error);
+        // Nothing was inserted, and auto IDs were not pushed past the limit
+        EXPECT_EQ(g.node_count(), 1u);
+        EXPECT_EQ(g.edge_count(), 0u);
+        EXPECT_EQ(g.create_node(), a + 1);
+        g.create_node(kDenseIdLimit - 1);
+    }
+    Graph reopened(options);
+    EXPECT_EQ(reopened.node_count(), 3u);
+    EXPECT_NE(reopened.get_node(kDenseIdLimit - 1), nullptr);
+    std::remove(file.c_str());
+
+    storage::PagedGraphStore store(file, 16);
+    EXPECT_THROW(store.write(storage::RecordKind::Node, uint64_t{1} << 50, "x"), std::runtime_error);
+    std::remove(file.c_str());
+}
+
+TEST(BufferPoolTest, ConcurrentFetchesThroughEvictionKeepPageContents) {
+    const std::string file = "test_buffer_pool.db";
+    constexpr PageID kPages = 64;
+    constexpr size_t kThreads = 4;
+    constexpr uint64_t kRounds = 2000;
+    // Every page holds its own ID and a counter bumped only by the thread owning it
+    auto run = [&](buffer::BufferPool& pool, storage::DiskManager& disk) {
+        for (PageID p = 0; p < kPages; ++p) {
+            PageID id;
+            Page* page = pool.new_page(&id);
+            ASSERT_NE(page, nullptr);
+            ASSERT_EQ(id, p);
+            std::memcpy(page->data_, &id, sizeof(id));
+            pool.unpin_page(id, true);
+        }
+        std::atomic<bool> ok{true};
+        std::atomic<uint64_t> bumps{0};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < kThreads; ++t) {
+            workers.emplace_back([&, t]() {
+                std::mt19937 rng(static_cast<unsigned>(t));
+                std::vector<uint64_t> counts(kPages);
+                for (uint64_t i = 0; i < kRounds; ++i) {
+                    PageID id = static_cast<PageID>(rng() % kPages);
+                    Page* page = pool.fetch_page(id);
+                    if (!page) {
+                        ok = false;
+                        continue;
+                    }
+                    PageID stored;
+                    std::memcpy(&stored, page->data_, sizeof(stored));
+                    bool mine = id % kThreads == t;
+                    if (stored != id) ok = false;
+                    if (mine) {
+                        uint64_t count;
+                        std::memcpy(&count, page->data_ + 8, sizeof(count));
+                        if (count != counts[id]) ok = false;
+                        ++counts[id];
+                        ++bumps;
+                        std::memcpy(page->data_ + 8, &counts[id], sizeof(count));
+                    }
+                    pool.unpin_page(id, mine);
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        EXPECT_TRUE(ok);
+        // Every write made it through eviction to the file
+        pool.flush_all_pages();
+        uint64_t total = 0;
+        char data[4096];
+        for (PageID p = 0; p < kPages; ++p) {
+            disk.read_page(p, data);
+            PageID stored;
+            uint64_t count;
+            std::memcpy(&stored, data, sizeof(stored));
+            std::memcpy(&count, data + 8, sizeof(count));
+            EXPECT_EQ(stored, p);
+            total += count;
+        }
+        EXPECT_EQ(total, bumps.load());
+    };
+
+    for (auto kind : {buffer::ReplacerKind::LRU, buffer::ReplacerKind::Clock, buffer::ReplacerKind::LRUK,
+                      buffer::ReplacerKind::TwoQ}) {
+        std::remove(file.c_str());
+        {
+            storage::DiskManager disk(file);
+            buffer::BufferPoolManager pool(kThreads * 2, &disk, kind);
+            run(pool, disk);
+        }
+        std::remove(file.c_str());
+        {
+            storage::DiskManager disk(file);
+            buffer::PartitionedBufferPool pool(kThreads * 4, &disk, 4, kind);
+            EXPECT_EQ(pool.instances(), 4u);
+            run(pool, disk);
+        }
+    }
+    std::remove(file.c_str());
+}
+
+TEST(BufferPoolTest, ClockGivesReferencedFramesASecondChance) {
+    buffer::ClockReplacer clock(3);
+    for (FrameID f = 0; f < 3; ++f) {
+        clock.record_access(f, f);
+        clock.unpin(f);
+    }
+    clock.unpin(1); // already evictable: counted once
+    EXPECT_EQ(clock.size(), 3u);
+
+    // Every bit is set, so the first sweep clears them all and the hand comes back to 0
+    FrameID victim;
+    ASSERT_TRUE(clock.victim(&victim));
+    EXPECT_EQ(victim, 0);
+    EXPECT_EQ(clock.size(), 2u);
+
+    // Frame 1 is referenced again: the hand clears its bit and passes it over for 2
+    clock.record_access(1, 1);
+    ASSERT_TRUE(clock.victim(&victim));
+    EXPECT_EQ(victim, 2);
+    ASSERT_TRUE(clock.victim(&victim));
+    EXPECT_EQ(victim, 1);
+
+    EXPECT_EQ(clock.size(), 0u);
+    EXPECT_FALSE(clock.victim(&victim));
+    clock.unpin(2);
+    clock.pin(2);
+    clock.pin(2);
+    EXPECT_EQ(clock.size(), 0u);
+}
+
+TEST(BufferPoolTest, FailedReadsHandTheFrameBackIdle) {
+    // Positioned reads of a FIFO fail, so every fetch misses and throws
+    const std::string file = "test_failed_read.db";
+    std::remove(file.c_str());
+    ASSERT_EQ(mkfifo(file.c_str(), 0644), 0);
+    {
+        storage::DiskManager disk(file);
+        buffer::BufferPoolManager pool(1, &disk);
+        std::atomic<int> read_errors{0};
+        std::atomic<int> no_frame{0};
+        std::atomic<int> other_errors{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t]() {
+                for (PageID i = 0; i < 5000; ++i) {
+                    try {
+                        if (pool.fetch_page(t * 5000 + i)) other_errors++;
+                        else no_frame++; // the one frame is busy with another read
+                    } catch (const std::runtime_error&) {
+                        read_errors++;
+                    } catch (...) {
+                        other_errors++;
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        EXPECT_EQ(other_errors, 0);
+        EXPECT_GT(read_errors, 0);
+        EXPECT_EQ(read_errors + no_frame, 4 * 5000);
+    }
+    std::remove(file.c_str());
+}
+
+TEST(BufferPoolTest, ScanResistantReplacersKeepTheHotSetThroughAScan) {
+    const std::string file = "test_replacer.db";
+    constexpr size_t kPoolSize = 16;
+    constexpr PageID kHotPages = 4;
+    std::remove(file.c_str());
+    storage::DiskManager disk(file);
+    // Hit rate of the hot pages while each lookup is followed by `scan_pages` pages of a
+    // scan that never comes back
+    auto lookups = [&](buffer::BufferPoolManager& pool, PageID& scan, size_t scan_pages, size_t rounds) {
+        uint64_t hits = 0;
+        for (size_t i = 0; i < rounds; ++i) {
+            PageID hot = static_cast<PageID>(i % kHotPages);
+            uint64_t before = pool.hits();
+            if (!pool.fetch_page(hot)) return -1.0;
+            hits += pool.hits() - before;
+            pool.unpin_page(hot, false);
+            for (size_t s = 0; s < scan_pages; ++s, ++scan) {
+                if (!pool.fetch_page(kHotPages + scan)) return -1.0;
+                pool.unpin_page(kHotPages + scan, false);
+            }
+        }
+        return static_cast<double>(hits) / rounds;
+    };
+    auto hit_rate = [&](buffer::ReplacerKind kind) {
+        buffer::BufferPoolManager pool(kPoolSize, &disk, kind);
+        PageID scan = 0;
+        // A light scan while the hot set settles in, then one heavy enough to cycle the
+        // whole pool between two lookups of the same page
+        EXPECT_GE(lookups(pool, scan, 2, 64), 0.0);
+        return lookups(pool, scan, 4, 400);
+    };
+    EXPECT_LT(hit_rate(buffer::ReplacerKind::LRU), 0.1);
+    EXPECT_EQ(hit_rate(buffer::ReplacerKind::LRUK), 1.0);
+    EXPECT_EQ(hit_rate(buffer::ReplacerKind::TwoQ), 1.0);
+    // CLOCK approximates LRU, so only check it runs
+    EXPECT_GE(hit_rate(buffer::ReplacerKind::Clock), 0.0);
+    std::remove(file.c_str());
+}